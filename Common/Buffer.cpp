@@ -115,6 +115,15 @@ int Buffer::OffsetToAfterNextCRLF() {
   return -1;
 }
 
+int Buffer::OffsetToAfterNextCRLFCRLF() {
+  for (int i = 0; i < (int)data_.size() - 3; i++) {
+    if (data_[i] == '\r' && data_[i + 1] == '\n' && data_[i + 2] == '\r' && data_[i + 3] == '\n') {
+      return i + 4;
+    }
+  }
+  return -1;
+}
+
 void Buffer::Printf(const char *fmt, ...) {
   char buffer[2048];
   va_list vl;
@@ -262,6 +271,16 @@ int Buffer::Read(int fd, size_t sz) {
 	return (int)received;
 }
 
+int Buffer::ReadSome(int fd, size_t sz) {
+	char buf[4096];
+	int retval = recv(fd, buf, (int)std::min(sz, sizeof(buf)), 0);
+	if (retval > 0) {
+		char *p = Append((size_t)retval);
+		memcpy(p, buf, retval);
+	}
+	return retval;
+}
+
 void Buffer::PeekAll(std::string *dest) {
 	dest->resize(data_.size());
 	memcpy(&(*dest)[0], &data_[0], data_.size());
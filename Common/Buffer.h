@@ -31,6 +31,8 @@ class Buffer {
   // If parsing HTML headers, this indicates that you should probably buffer up
   // more data.
   int OffsetToAfterNextCRLF();
+  // Same, but for the empty line that ends a block of HTTP headers.
+  int OffsetToAfterNextCRLFCRLF();
 
   // Takers
 
@@ -69,6 +71,11 @@ class Buffer {
 	// < 0: error
 	// >= 0: number of bytes read
   int Read(int fd, size_t sz);
+	// Like Read, but only waits for a single packet, up to sz bytes.
+	// < 0: error
+	// 0: connection closed
+	// > 0: number of bytes read
+	int ReadSome(int fd, size_t sz);
 
   // Utilities. Try to avoid checking for size.
   size_t size() const { return data_.size(); }
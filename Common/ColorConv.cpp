@@ -15,6 +15,8 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <cstring>
+
 #include "ColorConv.h"
 // NEON is in a separate file so that it can be compiled with a runtime check.
 #include "ColorConvNEON.h"
@@ -628,6 +630,146 @@ void ConvertRGB565ToBGR565Basic(u16_le *dst, const u16_le *src, u32 numPixels) {
 	}
 }
 
+enum YUVOutputFormat {
+	YUV_OUT_RGBA8888,
+	YUV_OUT_RGB565,
+	YUV_OUT_RGBA5551,
+	YUV_OUT_RGBA4444,
+};
+
+static inline int ClampYUVResult(int c) {
+	return c < 0 ? 0 : (c > 255 ? 255 : c);
+}
+
+// Follows the 16-bit SIMD math step by step (high half multiplies, 5 fractional bits.)
+template <YUVOutputFormat fmt>
+static inline void ConvertYUVPixel(void *dst, u32 i, int y, int u, int v) {
+	const int yy = (((y - 16) * 128 * YUV_COEF_Y) >> 16) + 16;
+	const int uu = (u - 128) * 128;
+	const int vv = (v - 128) * 128;
+	const int r = ClampYUVResult((yy + ((vv * YUV_COEF_VR) >> 16)) >> 5);
+	const int g = ClampYUVResult((yy - ((uu * YUV_COEF_UG) >> 16) - ((vv * YUV_COEF_VG) >> 16)) >> 5);
+	const int b = ClampYUVResult((yy + ((uu * YUV_COEF_UB) >> 16) + (uu >> 1)) >> 5);
+
+	switch (fmt) {
+	case YUV_OUT_RGBA8888:
+		((u32_le *)dst)[i] = r | (g << 8) | (b << 16);
+		break;
+	case YUV_OUT_RGB565:
+		((u16_le *)dst)[i] = (r >> 3) | ((g >> 2) << 5) | ((b >> 3) << 11);
+		break;
+	case YUV_OUT_RGBA5551:
+		((u16_le *)dst)[i] = (r >> 3) | ((g >> 3) << 5) | ((b >> 3) << 10);
+		break;
+	case YUV_OUT_RGBA4444:
+		((u16_le *)dst)[i] = (r >> 4) | ((g >> 4) << 4) | ((b >> 4) << 8);
+		break;
+	}
+}
+
+#ifdef _M_SSE
+// Converts 8 pixels, leaving R, G, and B as 16-bit lanes clamped to 0-255.
+static inline void ConvertYUV420ToRGB_SSE2(const u8 *y, const u8 *u, const u8 *v, __m128i &r, __m128i &g, __m128i &b) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i maxval = _mm_set1_epi16(255);
+
+	u32 u4, v4;
+	memcpy(&u4, u, sizeof(u4));
+	memcpy(&v4, v, sizeof(v4));
+	__m128i uu = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+	__m128i vv = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+	// Each chroma sample covers two pixels.
+	uu = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi16(uu, uu), _mm_set1_epi16(128)), 7);
+	vv = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi16(vv, vv), _mm_set1_epi16(128)), 7);
+
+	__m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)y), zero);
+	yy = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(yy, _mm_set1_epi16(16)), 7), _mm_set1_epi16(YUV_COEF_Y));
+	// Rounding for the final shift.
+	yy = _mm_add_epi16(yy, _mm_set1_epi16(16));
+
+	r = _mm_add_epi16(yy, _mm_mulhi_epi16(vv, _mm_set1_epi16(YUV_COEF_VR)));
+	g = _mm_sub_epi16(yy, _mm_mulhi_epi16(uu, _mm_set1_epi16(YUV_COEF_UG)));
+	g = _mm_sub_epi16(g, _mm_mulhi_epi16(vv, _mm_set1_epi16(YUV_COEF_VG)));
+	b = _mm_add_epi16(yy, _mm_mulhi_epi16(uu, _mm_set1_epi16(YUV_COEF_UB)));
+	b = _mm_add_epi16(b, _mm_srai_epi16(uu, 1));
+
+	r = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(r, 5), zero), maxval);
+	g = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(g, 5), zero), maxval);
+	b = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(b, 5), zero), maxval);
+}
+#endif
+
+template <YUVOutputFormat fmt>
+static void ConvertYUV420Line(void *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+#if PPSSPP_ARCH(ARM_NEON)
+	u32 i = 0;
+#if !PPSSPP_ARCH(ARM64)
+	if (cpu_info.bNEON)
+#endif
+	{
+		switch (fmt) {
+		case YUV_OUT_RGBA8888: i = ConvertYUV420ToRGBA8888NEON((u32 *)dst, y, u, v, numPixels); break;
+		case YUV_OUT_RGB565: i = ConvertYUV420ToRGB565NEON((u16 *)dst, y, u, v, numPixels); break;
+		case YUV_OUT_RGBA5551: i = ConvertYUV420ToRGBA5551NEON((u16 *)dst, y, u, v, numPixels); break;
+		case YUV_OUT_RGBA4444: i = ConvertYUV420ToRGBA4444NEON((u16 *)dst, y, u, v, numPixels); break;
+		}
+	}
+#elif defined(_M_SSE)
+	const u32 sseChunks = numPixels / 8;
+	for (u32 c = 0; c < sseChunks; ++c) {
+		__m128i r, g, b;
+		ConvertYUV420ToRGB_SSE2(y + c * 8, u + c * 4, v + c * 4, r, g, b);
+
+		if (fmt == YUV_OUT_RGBA8888) {
+			const __m128i zero = _mm_setzero_si128();
+			// Interleave to RGB0 bytes, alpha stays zero.
+			const __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+			const __m128i b0 = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), zero);
+			__m128i *dstp = (__m128i *)((u32_le *)dst + c * 8);
+			_mm_storeu_si128(dstp, _mm_unpacklo_epi16(rg, b0));
+			_mm_storeu_si128(dstp + 1, _mm_unpackhi_epi16(rg, b0));
+			continue;
+		}
+
+		__m128i px;
+		if (fmt == YUV_OUT_RGB565) {
+			px = _mm_or_si128(_mm_srli_epi16(r, 3), _mm_slli_epi16(_mm_srli_epi16(g, 2), 5));
+			px = _mm_or_si128(px, _mm_slli_epi16(_mm_srli_epi16(b, 3), 11));
+		} else if (fmt == YUV_OUT_RGBA5551) {
+			px = _mm_or_si128(_mm_srli_epi16(r, 3), _mm_slli_epi16(_mm_srli_epi16(g, 3), 5));
+			px = _mm_or_si128(px, _mm_slli_epi16(_mm_srli_epi16(b, 3), 10));
+		} else {
+			px = _mm_or_si128(_mm_srli_epi16(r, 4), _mm_slli_epi16(_mm_srli_epi16(g, 4), 4));
+			px = _mm_or_si128(px, _mm_slli_epi16(_mm_srli_epi16(b, 4), 8));
+		}
+		_mm_storeu_si128((__m128i *)((u16_le *)dst + c * 8), px);
+	}
+	// The remainder starts right after those done via SSE.
+	u32 i = sseChunks * 8;
+#else
+	u32 i = 0;
+#endif
+	for (; i < numPixels; i++) {
+		ConvertYUVPixel<fmt>(dst, i, y[i], u[i / 2], v[i / 2]);
+	}
+}
+
+void ConvertYUV420ToRGBA8888(u32_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Line<YUV_OUT_RGBA8888>(dst, y, u, v, numPixels);
+}
+
+void ConvertYUV420ToRGB565(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Line<YUV_OUT_RGB565>(dst, y, u, v, numPixels);
+}
+
+void ConvertYUV420ToRGBA5551(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Line<YUV_OUT_RGBA5551>(dst, y, u, v, numPixels);
+}
+
+void ConvertYUV420ToRGBA4444(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	ConvertYUV420Line<YUV_OUT_RGBA4444>(dst, y, u, v, numPixels);
+}
+
 // Reuse the logic from the header - if these aren't defined, we need externs.
 #ifndef ConvertRGBA4444ToABGR4444
 Convert16bppTo16bppFunc ConvertRGBA4444ToABGR4444 = &ConvertRGBA4444ToABGR4444Basic;
@@ -136,6 +136,22 @@ void ConvertRGBA4444ToABGR4444Basic(u16_le *dst, const u16_le *src, u32 numPixel
 void ConvertRGBA5551ToABGR1555Basic(u16_le *dst, const u16_le *src, u32 numPixels);
 void ConvertRGB565ToBGR565Basic(u16_le *dst, const u16_le *src, u32 numPixels);
 
+// Planar YUV 4:2:0 (BT.601, limited range, as in MPEG video) to the PSP formats, one line at a time.
+// u and v hold one sample per two pixels. Alpha is left zero, which is what the PSP's decoder writes.
+void ConvertYUV420ToRGBA8888(u32_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+void ConvertYUV420ToRGB565(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+void ConvertYUV420ToRGBA5551(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+void ConvertYUV420ToRGBA4444(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+
+// Q14 coefficients shared by every YUV path, so SIMD and scalar results match exactly.
+enum {
+	YUV_COEF_Y = 19077,  // 1.164
+	YUV_COEF_VR = 26149, // 1.596
+	YUV_COEF_UG = 6419,  // 0.392
+	YUV_COEF_VG = 13320, // 0.813
+	YUV_COEF_UB = 282,   // 2.017, minus 2.0 which is applied as a shift.
+};
+
 #if PPSSPP_ARCH(ARM64)
 #define ConvertRGBA4444ToABGR4444 ConvertRGBA4444ToABGR4444NEON
 #elif !PPSSPP_ARCH(ARM)
@@ -23,6 +23,8 @@
 #else
 #include <arm_neon.h>
 #endif
+#include <cstring>
+
 #include "ColorConvNEON.h"
 #include "Common.h"
 #include "CPUDetect.h"
@@ -115,4 +117,91 @@ void ConvertRGB565ToBGR565NEON(u16 *dst, const u16 *src, u32 numPixels) {
 	}
 }
 
+enum YUVOutputFormatNEON {
+	YUV_NEON_RGBA8888,
+	YUV_NEON_RGB565,
+	YUV_NEON_RGBA5551,
+	YUV_NEON_RGBA4444,
+};
+
+// Same as _mm_mulhi_epi16, to match the other paths exactly.
+static inline int16x8_t MulHiS16(int16x8_t a, int16_t b) {
+	const int16x4_t bb = vdup_n_s16(b);
+	const int32x4_t lo = vmull_s16(vget_low_s16(a), bb);
+	const int32x4_t hi = vmull_s16(vget_high_s16(a), bb);
+	return vcombine_s16(vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16));
+}
+
+static inline int16x8_t LoadChromaNEON(const u8 *c) {
+	u32 c4;
+	memcpy(&c4, c, sizeof(c4));
+	// Each chroma sample covers two pixels.
+	const uint8x8_t cc = vreinterpret_u8_u32(vdup_n_u32(c4));
+	const uint8x8_t doubled = vzip_u8(cc, cc).val[0];
+	return vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(doubled)), vdupq_n_s16(128)), 7);
+}
+
+template <YUVOutputFormatNEON fmt>
+static u32 ConvertYUV420LineNEON(void *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	const u32 simdable = (numPixels / 8) * 8;
+	for (u32 i = 0; i < simdable; i += 8) {
+		const int16x8_t uu = LoadChromaNEON(u + i / 2);
+		const int16x8_t vv = LoadChromaNEON(v + i / 2);
+
+		int16x8_t yy = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i)));
+		yy = MulHiS16(vshlq_n_s16(vsubq_s16(yy, vdupq_n_s16(16)), 7), YUV_COEF_Y);
+		// Rounding for the final shift.
+		yy = vaddq_s16(yy, vdupq_n_s16(16));
+
+		const int16x8_t r = vaddq_s16(yy, MulHiS16(vv, YUV_COEF_VR));
+		const int16x8_t g = vsubq_s16(vsubq_s16(yy, MulHiS16(uu, YUV_COEF_UG)), MulHiS16(vv, YUV_COEF_VG));
+		const int16x8_t b = vaddq_s16(vaddq_s16(yy, MulHiS16(uu, YUV_COEF_UB)), vshrq_n_s16(uu, 1));
+
+		// Shift and clamp to 0-255.
+		const uint8x8_t r8 = vqmovun_s16(vshrq_n_s16(r, 5));
+		const uint8x8_t g8 = vqmovun_s16(vshrq_n_s16(g, 5));
+		const uint8x8_t b8 = vqmovun_s16(vshrq_n_s16(b, 5));
+
+		if (fmt == YUV_NEON_RGBA8888) {
+			uint8x8x4_t rgba;
+			rgba.val[0] = r8;
+			rgba.val[1] = g8;
+			rgba.val[2] = b8;
+			rgba.val[3] = vdup_n_u8(0);
+			vst4_u8((u8 *)dst + i * 4, rgba);
+			continue;
+		}
+
+		uint16x8_t px;
+		if (fmt == YUV_NEON_RGB565) {
+			px = vorrq_u16(vmovl_u8(vshr_n_u8(r8, 3)), vshlq_n_u16(vmovl_u8(vshr_n_u8(g8, 2)), 5));
+			px = vorrq_u16(px, vshlq_n_u16(vmovl_u8(vshr_n_u8(b8, 3)), 11));
+		} else if (fmt == YUV_NEON_RGBA5551) {
+			px = vorrq_u16(vmovl_u8(vshr_n_u8(r8, 3)), vshlq_n_u16(vmovl_u8(vshr_n_u8(g8, 3)), 5));
+			px = vorrq_u16(px, vshlq_n_u16(vmovl_u8(vshr_n_u8(b8, 3)), 10));
+		} else {
+			px = vorrq_u16(vmovl_u8(vshr_n_u8(r8, 4)), vshlq_n_u16(vmovl_u8(vshr_n_u8(g8, 4)), 4));
+			px = vorrq_u16(px, vshlq_n_u16(vmovl_u8(vshr_n_u8(b8, 4)), 8));
+		}
+		vst1q_u16((u16 *)dst + i, px);
+	}
+	return simdable;
+}
+
+u32 ConvertYUV420ToRGBA8888NEON(u32 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	return ConvertYUV420LineNEON<YUV_NEON_RGBA8888>(dst, y, u, v, numPixels);
+}
+
+u32 ConvertYUV420ToRGB565NEON(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	return ConvertYUV420LineNEON<YUV_NEON_RGB565>(dst, y, u, v, numPixels);
+}
+
+u32 ConvertYUV420ToRGBA5551NEON(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	return ConvertYUV420LineNEON<YUV_NEON_RGBA5551>(dst, y, u, v, numPixels);
+}
+
+u32 ConvertYUV420ToRGBA4444NEON(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels) {
+	return ConvertYUV420LineNEON<YUV_NEON_RGBA4444>(dst, y, u, v, numPixels);
+}
+
 #endif // PPSSPP_ARCH(ARM_NEON)
@@ -22,3 +22,9 @@
 void ConvertRGBA4444ToABGR4444NEON(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertRGBA5551ToABGR1555NEON(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertRGB565ToBGR565NEON(u16 *dst, const u16 *src, u32 numPixels);
+
+// These only do whole groups of 8 pixels, and return how many they converted.
+u32 ConvertYUV420ToRGBA8888NEON(u32 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+u32 ConvertYUV420ToRGB565NEON(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+u32 ConvertYUV420ToRGBA5551NEON(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+u32 ConvertYUV420ToRGBA4444NEON(u16 *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
@@ -299,7 +299,7 @@ int Client::SendRequestWithData(const char *method, const char *resource, const
 		"%s %s HTTP/%s\r\n"
 		"Host: %s\r\n"
 		"User-Agent: %s\r\n"
-		"Connection: close\r\n"
+		"Connection: %s\r\n"
 		"%s"
 		"\r\n";
 
@@ -307,6 +307,7 @@ int Client::SendRequestWithData(const char *method, const char *resource, const
 		method, resource, httpVersion_,
 		host_.c_str(),
 		userAgent_,
+		keepAlive_ ? "keep-alive" : "close",
 		otherHeaders ? otherHeaders : "");
 	buffer.Append(data);
 	bool flushed = buffer.FlushSocket(sock(), dataTimeout_);
@@ -319,24 +320,41 @@ int Client::SendRequestWithData(const char *method, const char *resource, const
 int Client::ReadResponseHeaders(Buffer *readbuf, std::vector<std::string> &responseHeaders, float *progress, bool *cancelled) {
 	// Snarf all the data we can into RAM. A little unsafe but hey.
 	static constexpr float CANCEL_INTERVAL = 0.25f;
-	bool ready = false;
 	double leftTimeout = dataTimeout_;
-	while (!ready) {
-		if (cancelled && *cancelled)
-			return -1;
-		ready = fd_util::WaitUntilReady(sock(), CANCEL_INTERVAL, false);
-		if (!ready && leftTimeout >= 0.0) {
-			leftTimeout -= CANCEL_INTERVAL;
-			if (leftTimeout < 0) {
-				ERROR_LOG(IO, "HTTP headers timed out");
+	while (true) {
+		// With keep-alive, a previous read may have already brought in this response.
+		if (keepAlive_ && readbuf->OffsetToAfterNextCRLFCRLF() >= 0)
+			break;
+
+		bool ready = false;
+		while (!ready) {
+			if (cancelled && *cancelled)
 				return -1;
+			ready = fd_util::WaitUntilReady(sock(), CANCEL_INTERVAL, false);
+			if (!ready && leftTimeout >= 0.0) {
+				leftTimeout -= CANCEL_INTERVAL;
+				if (leftTimeout < 0) {
+					ERROR_LOG(IO, "HTTP headers timed out");
+					return -1;
+				}
 			}
+		};
+
+		if (keepAlive_) {
+			// The server won't close the connection, so we can't wait for 4096 bytes.
+			if (readbuf->ReadSome(sock(), 4096) <= 0) {
+				ERROR_LOG(IO, "Failed to read HTTP headers :(");
+				return -1;
+			}
+			continue;
 		}
-	};
-	// Let's hope all the headers are available in a single packet...
-	if (readbuf->Read(sock(), 4096) < 0) {
-		ERROR_LOG(IO, "Failed to read HTTP headers :(");
-		return -1;
+
+		// Let's hope all the headers are available in a single packet...
+		if (readbuf->Read(sock(), 4096) < 0) {
+			ERROR_LOG(IO, "Failed to read HTTP headers :(");
+			return -1;
+		}
+		break;
 	}
 
 	// Grab the first header line that contains the http code.
@@ -373,6 +391,7 @@ int Client::ReadResponseHeaders(Buffer *readbuf, std::vector<std::string> &respo
 int Client::ReadResponseEntity(Buffer *readbuf, const std::vector<std::string> &responseHeaders, Buffer *output, float *progress, bool *cancelled) {
 	bool gzip = false;
 	bool chunked = false;
+	bool knownLength = false;
 	int contentLength = 0;
 	for (std::string line : responseHeaders) {
 		if (startsWithNoCase(line, "Content-Length:")) {
@@ -382,6 +401,7 @@ int Client::ReadResponseEntity(Buffer *readbuf, const std::vector<std::string> &
 			}
 			if (size_pos != line.npos) {
 				contentLength = atoi(&line[size_pos]);
+				knownLength = true;
 				chunked = false;
 			}
 		} else if (startsWithNoCase(line, "Content-Encoding:")) {
@@ -408,21 +428,34 @@ int Client::ReadResponseEntity(Buffer *readbuf, const std::vector<std::string> &
 		*progress = 0.1f;
 	}
 
-	if (!contentLength || !progress) {
-		// No way to know how far along we are. Let's just not update the progress counter.
-		if (!readbuf->ReadAllWithProgress(sock(), contentLength, nullptr, cancelled))
+	if (keepAlive_ && knownLength && !chunked) {
+		// The connection stays open, so only take this response's bytes.
+		if (ReadEntityWithLength(readbuf, contentLength, progress, cancelled) < 0)
 			return -1;
+		std::string data;
+		readbuf->Take(contentLength, &data);
+		output->Append(data);
 	} else {
-		// Let's read in chunks, updating progress between each.
-		if (!readbuf->ReadAllWithProgress(sock(), contentLength, progress, cancelled))
-			return -1;
-	}
+		if (keepAlive_) {
+			// Without a length, the end of the response is the end of the connection.
+			WARN_LOG(IO, "HTTP keep-alive response without Content-Length, reading until close");
+		}
+		if (!contentLength || !progress) {
+			// No way to know how far along we are. Let's just not update the progress counter.
+			if (!readbuf->ReadAllWithProgress(sock(), contentLength, nullptr, cancelled))
+				return -1;
+		} else {
+			// Let's read in chunks, updating progress between each.
+			if (!readbuf->ReadAllWithProgress(sock(), contentLength, progress, cancelled))
+				return -1;
+		}
 
-	// output now contains the rest of the reply. Dechunk it.
-	if (chunked) {
-		DeChunk(readbuf, output, contentLength, progress);
-	} else {
-		output->Append(*readbuf);
+		// output now contains the rest of the reply. Dechunk it.
+		if (chunked) {
+			DeChunk(readbuf, output, contentLength, progress);
+		} else {
+			output->Append(*readbuf);
+		}
 	}
 
 	// If it's gzipped, we decompress it and put it back in the buffer.
@@ -445,6 +478,36 @@ int Client::ReadResponseEntity(Buffer *readbuf, const std::vector<std::string> &
 	return 0;
 }
 
+int Client::ReadEntityWithLength(Buffer *readbuf, int contentLength, float *progress, bool *cancelled) {
+	static constexpr float CANCEL_INTERVAL = 0.25f;
+	double leftTimeout = dataTimeout_;
+	while (readbuf->size() < (size_t)contentLength) {
+		bool ready = false;
+		while (!ready) {
+			if (cancelled && *cancelled)
+				return -1;
+			ready = fd_util::WaitUntilReady(sock(), CANCEL_INTERVAL, false);
+			if (!ready && leftTimeout >= 0.0) {
+				leftTimeout -= CANCEL_INTERVAL;
+				if (leftTimeout < 0) {
+					ERROR_LOG(IO, "HTTP response timed out");
+					return -1;
+				}
+			}
+		}
+
+		int retval = readbuf->ReadSome(sock(), contentLength - readbuf->size());
+		if (retval <= 0) {
+			ERROR_LOG(IO, "Connection closed during HTTP response: %i", retval);
+			return -1;
+		}
+		leftTimeout = dataTimeout_;
+		if (progress)
+			*progress = (float)readbuf->size() / (float)contentLength;
+	}
+	return 0;
+}
+
 Download::Download(const std::string &url, const std::string &outfile)
 	: url_(url), outfile_(outfile) {
 }
@@ -82,10 +82,23 @@ public:
 		dataTimeout_ = t;
 	}
 
+	// When enabled, requests ask the server to keep the connection open, and responses are
+	// read only up to their Content-Length.  Anything after that (e.g. the next pipelined
+	// response) is left in readbuf, so keep using the same buffer for the next response.
+	void SetKeepAlive(bool k) {
+		keepAlive_ = k;
+	}
+	bool KeepAlive() const {
+		return keepAlive_;
+	}
+
 protected:
+	int ReadEntityWithLength(Buffer *readbuf, int contentLength, float *progress, bool *cancelled);
+
 	const char *userAgent_;
 	const char *httpVersion_;
 	double dataTimeout_ = -1.0;
+	bool keepAlive_ = false;
 };
 
 // Not particularly efficient, but hey - it's a background download, that's pretty cool :P
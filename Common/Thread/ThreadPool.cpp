@@ -112,23 +112,41 @@ void ThreadPool::ParallelLoop(const std::function<void(int,int)> &loop, int lowe
 	int range = upper - lower;
 	if (range >= numThreads_ * 2) { // don't parallelize tiny loops (this could be better, maybe add optional parameter that estimates work per iteration)
 		std::lock_guard<std::mutex> guard(mutex);
-		StartWorkers();
-
-		// could do slightly better load balancing for the generic case, 
-		// but doesn't matter since all our loops are power of 2
-		int chunk = range / numThreads_;
-		int s = lower;
-		for (auto& worker : workers) {
-			worker->Process(loop, s, s+chunk);
-			s+=chunk;
-		}
-		// This is the final chunk.
-		loop(s, upper);
-		for (auto& worker : workers) {
-			worker->WaitForCompletion();
-		}
+		RunLoop(loop, lower, upper);
 	} else {
 		loop(lower, upper);
 	}
 }
 
+bool ThreadPool::TryParallelLoop(const std::function<void(int,int)> &loop, int lower, int upper) {
+	int range = upper - lower;
+	if (range >= numThreads_ * 2) {
+		std::unique_lock<std::mutex> guard(mutex, std::try_to_lock);
+		if (!guard.owns_lock())
+			return false;
+		RunLoop(loop, lower, upper);
+	} else {
+		loop(lower, upper);
+	}
+	return true;
+}
+
+void ThreadPool::RunLoop(const std::function<void(int,int)> &loop, int lower, int upper) {
+	// Caller holds the mutex.
+	StartWorkers();
+
+	// could do slightly better load balancing for the generic case, 
+	// but doesn't matter since all our loops are power of 2
+	int range = upper - lower;
+	int chunk = range / numThreads_;
+	int s = lower;
+	for (auto& worker : workers) {
+		worker->Process(loop, s, s+chunk);
+		s+=chunk;
+	}
+	// This is the final chunk.
+	loop(s, upper);
+	for (auto& worker : workers) {
+		worker->WaitForCompletion();
+	}
+}
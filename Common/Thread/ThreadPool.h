@@ -62,6 +62,8 @@ public:
 	// leading to the stopping and joining of all worker threads (RAII and all that)
 
 	void ParallelLoop(const std::function<void(int,int)> &loop, int lower, int upper);
+	// Same, but returns false without running anything if another loop is in progress.
+	bool TryParallelLoop(const std::function<void(int,int)> &loop, int lower, int upper);
 
 private:
 	int numThreads_;
@@ -70,6 +72,7 @@ private:
 
 	bool workersStarted = false;
 	void StartWorkers();
+	void RunLoop(const std::function<void(int,int)> &loop, int lower, int upper);
 	
 	ThreadPool(const ThreadPool& other) = delete; // prevent copies
 	void operator =(const ThreadPool &other) = delete;
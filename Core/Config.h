@@ -111,10 +111,12 @@ public:
 
 	bool bSeparateSASThread;
 	bool bSeparateIOThread;
+	bool bMpegDecodeAhead;
 	int iIOTimingMethod;
 	int iLockedCPUSpeed;
 	bool bAutoSaveSymbolMap;
 	bool bCacheFullIsoInRam;
+	bool bMemoryMapIso;
 	int iRemoteISOPort;
 	std::string sLastRemoteISOServer;
 	int iLastRemoteISOPort;
@@ -229,6 +231,8 @@ public:
 	int iGlobalVolume;
 	int iAltSpeedVolume;
 	bool bExtraAudioBuffering;  // For bluetooth
+	int iAudioLatency;  // Target in ms, the resampler adds more if it keeps running out.
+	int iAtracDecodeCacheMB;  // Decoded ATRAC tracks kept for replay, 0 to disable.
 	std::string sAudioDevice;
 	bool bAutoAudioDevice;
 
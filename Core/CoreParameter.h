@@ -78,6 +78,10 @@ struct CoreParameter {
 	// Can be modified at runtime.
 	bool unthrottle = false;
 	FPSLimit fpsLimit = FPSLimit::NORMAL;
+	// Skip drawing to the displayed framebuffers on all but one frame in this many, regardless of
+	// timing.  0 or 1 draws normally.  Offscreen and render-to-texture targets are always drawn, so
+	// only reads of the front/back buffers on a skipped frame can see stale pixels.
+	int drawEveryNthFrame = 0;
 
 	bool updateRecent = true;
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "Core/Debugger/DebugInterface.h"
@@ -168,6 +169,10 @@ public:
 	static const std::vector<BreakPoint> GetBreakpoints();
 
 	static bool HasMemChecks();
+	// Quick check without locking, so bulk memory ops can skip memchecks entirely.
+	static bool AnyMemChecks() {
+		return anyMemChecks_.load(std::memory_order_relaxed);
+	}
 
 	static void Update(u32 addr = 0);
 
@@ -186,6 +191,7 @@ private:
 
 	static std::vector<MemCheck> memChecks_;
 	static std::vector<MemCheck *> cleanupMemChecks_;
+	static std::atomic<bool> anyMemChecks_;
 };
 
 
@@ -0,0 +1,104 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <atomic>
+
+#include "Core/Debugger/MemHeatmap.h"
+
+namespace MemHeatmap {
+
+u32 countdown = DEFAULT_INTERVAL;
+
+static std::atomic<bool> enabledRequested;
+static std::atomic<u32> intervalRequested(DEFAULT_INTERVAL);
+static bool active = false;
+static u32 activeInterval = DEFAULT_INTERVAL;
+static u32 jitterSeed = 0x1234;
+
+// Only the emu thread writes these, the debugger may read them anytime.
+static std::atomic<u32> readCounts[PAGE_COUNT];
+static std::atomic<u32> writeCounts[PAGE_COUNT];
+static std::atomic<u64> sampleCount;
+
+static inline void AddCount(std::atomic<u32> &counter) {
+	// No other writers, so no need for a locked add.
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void SetEnabled(bool enabled, u32 interval) {
+	intervalRequested = interval == 0 ? 1 : interval;
+	enabledRequested = enabled;
+}
+
+bool IsEnabled() {
+	return enabledRequested;
+}
+
+bool IsActive() {
+	return active;
+}
+
+bool Update() {
+	bool enabled = enabledRequested;
+	activeInterval = intervalRequested;
+	if (enabled == active)
+		return false;
+
+	active = enabled;
+	countdown = activeInterval;
+	// Already compiled blocks have (or lack) the sampling code.
+	return true;
+}
+
+void Reset() {
+	for (int i = 0; i < PAGE_COUNT; ++i) {
+		readCounts[i].store(0, std::memory_order_relaxed);
+		writeCounts[i].store(0, std::memory_order_relaxed);
+	}
+	sampleCount = 0;
+}
+
+u32 GetInterval() {
+	return intervalRequested;
+}
+
+u64 GetSampleCount() {
+	return sampleCount;
+}
+
+std::vector<PageStats> GetPages() {
+	std::vector<PageStats> pages;
+	for (int i = 0; i < PAGE_COUNT; ++i) {
+		u32 reads = readCounts[i].load(std::memory_order_relaxed);
+		u32 writes = writeCounts[i].load(std::memory_order_relaxed);
+		if (reads != 0 || writes != 0)
+			pages.push_back({ (u32)i << PAGE_SHIFT, reads, writes });
+	}
+	return pages;
+}
+
+void Sample(u32 address, bool isWrite) {
+	// Vary the interval a bit, so loops with a matching period don't always hit the same access.
+	jitterSeed = jitterSeed * 1664525 + 1013904223;
+	countdown = activeInterval / 2 + (jitterSeed >> 8) % activeInterval + 1;
+
+	u32 page = (address & 0x0FFFFFFF) >> PAGE_SHIFT;
+	AddCount(isWrite ? writeCounts[page] : readCounts[page]);
+	sampleCount.store(sampleCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}  // namespace MemHeatmap
@@ -0,0 +1,63 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Sampled counts of guest loads and stores per page of memory.
+// Jitted code only decrements a counter per access, and calls Sample() once it hits zero,
+// so beyond that the cost depends on the sampling interval rather than how much the game accesses.
+namespace MemHeatmap {
+
+enum {
+	PAGE_SHIFT = 12,
+	PAGE_SIZE = 1 << PAGE_SHIFT,
+	// Addresses are counted without the kernel and uncached bits, which leaves 256MB.
+	PAGE_COUNT = 0x10000000 >> PAGE_SHIFT,
+
+	DEFAULT_INTERVAL = 1024,
+};
+
+struct PageStats {
+	u32 address;
+	u32 reads;
+	u32 writes;
+};
+
+// Sample about one access out of every interval.  Can be requested from any thread,
+// takes effect at the next Update().
+void SetEnabled(bool enabled, u32 interval = DEFAULT_INTERVAL);
+bool IsEnabled();
+// Whether the jit should emit sampling code right now.  Emu thread only.
+bool IsActive();
+// Called on the emu thread between frames.  Returns true if the jit cache needs clearing.
+bool Update();
+void Reset();
+
+u32 GetInterval();
+u64 GetSampleCount();
+// Only pages sampled at least once, lowest address first.
+std::vector<PageStats> GetPages();
+
+// Decremented for each access by instrumented code, which then calls Sample() at zero.
+extern u32 countdown;
+void Sample(u32 address, bool isWrite);
+
+}  // namespace MemHeatmap
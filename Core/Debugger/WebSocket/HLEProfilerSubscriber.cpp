@@ -0,0 +1,130 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Common/StringUtils.h"
+#include "Core/Debugger/WebSocket/HLEProfilerSubscriber.h"
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
+#include "Core/HLE/HLE.h"
+#include "Core/System.h"
+
+struct WebSocketHLEProfilerState : public DebuggerSubscriber {
+	~WebSocketHLEProfilerState() override;
+	void Start(DebuggerRequest &req);
+	void Stop(DebuggerRequest &req);
+	void Reset(DebuggerRequest &req);
+	void Stats(DebuggerRequest &req);
+
+protected:
+	bool started_ = false;
+};
+
+DebuggerSubscriber *WebSocketHLEProfilerInit(DebuggerEventHandlerMap &map) {
+	auto p = new WebSocketHLEProfilerState();
+	map["hle.profile.start"] = std::bind(&WebSocketHLEProfilerState::Start, p, std::placeholders::_1);
+	map["hle.profile.stop"] = std::bind(&WebSocketHLEProfilerState::Stop, p, std::placeholders::_1);
+	map["hle.profile.reset"] = std::bind(&WebSocketHLEProfilerState::Reset, p, std::placeholders::_1);
+	map["hle.profile.stats"] = std::bind(&WebSocketHLEProfilerState::Stats, p, std::placeholders::_1);
+
+	return p;
+}
+
+WebSocketHLEProfilerState::~WebSocketHLEProfilerState() {
+	// Don't leave the jit slowed down after the debugger goes away.
+	if (started_)
+		hleSetProfiling(false);
+}
+
+// Start collecting per function HLE stats (hle.profile.start)
+//
+// Parameters:
+//  - reset: optional boolean, true to clear previous stats first.  Defaults to true.
+//
+// Response (same event name) with no extra data.
+//
+// Note: takes effect at the start of the next frame.
+void WebSocketHLEProfilerState::Start(DebuggerRequest &req) {
+	bool reset = true;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (reset)
+		hleResetProfile();
+	hleSetProfiling(true);
+	started_ = true;
+	req.Respond();
+}
+
+// Stop collecting HLE stats (hle.profile.stop)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.  Stats collected so far remain available.
+void WebSocketHLEProfilerState::Stop(DebuggerRequest &req) {
+	hleSetProfiling(false);
+	started_ = false;
+	req.Respond();
+}
+
+// Clear collected HLE stats (hle.profile.reset)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+//
+// Note: takes effect at the start of the next frame, stats are empty until then.
+void WebSocketHLEProfilerState::Reset(DebuggerRequest &req) {
+	hleResetProfile();
+	req.Respond();
+}
+
+// Retrieve collected HLE stats (hle.profile.stats)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - enabled: boolean, whether stats are currently being collected.
+//  - functions: array of objects, slowest first, each with properties:
+//     - module: string module name, e.g. 'sceDisplay'.
+//     - name: string function name.
+//     - nid: unsigned integer function id.
+//     - calls: number of times called.
+//     - hostNanos: total host time spent in the function, in nanoseconds.
+//     - cycles: total emulated cycles the function consumed.
+//     - delayCycles: total emulated cycles the calling thread was delayed for after the call.
+void WebSocketHLEProfilerState::Stats(DebuggerRequest &req) {
+	if (!PSP_IsInited())
+		return req.Fail("CPU not started");
+
+	std::vector<HLEFunctionProfile> profile = hleGetProfile();
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("enabled", hleIsProfiling());
+	json.pushArray("functions");
+	for (const auto &func : profile) {
+		json.pushDict();
+		json.writeString("module", func.module);
+		json.writeString("name", func.name);
+		json.writeUint("nid", func.nid);
+		// These easily exceed 32 bits, and writeFloat() would round them.
+		json.writeRaw("calls", StringFromFormat("%llu", (unsigned long long)func.calls));
+		json.writeRaw("hostNanos", StringFromFormat("%llu", (unsigned long long)func.hostNanos));
+		json.writeRaw("cycles", StringFromFormat("%llu", (unsigned long long)func.cycles));
+		json.writeRaw("delayCycles", StringFromFormat("%llu", (unsigned long long)func.delayCycles));
+		json.pop();
+	}
+	json.pop();
+}
@@ -18,11 +18,23 @@
 #include "Common/StringUtils.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
+#include "Core/Debugger/MemHeatmap.h"
 #include "Core/Debugger/WebSocket/MemorySubscriber.h"
 #include "Core/Debugger/WebSocket/WebSocketUtils.h"
 
+struct WebSocketMemoryState : public DebuggerSubscriber {
+	~WebSocketMemoryState() override;
+	void HeatmapStart(DebuggerRequest &req);
+	void HeatmapStop(DebuggerRequest &req);
+	void HeatmapReset(DebuggerRequest &req);
+	void HeatmapGet(DebuggerRequest &req);
+
+protected:
+	bool heatmapStarted_ = false;
+};
+
 DebuggerSubscriber *WebSocketMemoryInit(DebuggerEventHandlerMap &map) {
-	// No need to bind or alloc state, these are all global.
+	// No need to bind or alloc state for reads and writes, these are all global.
 	map["memory.read_u8"] = &WebSocketMemoryReadU8;
 	map["memory.read_u16"] = &WebSocketMemoryReadU16;
 	map["memory.read_u32"] = &WebSocketMemoryReadU32;
@@ -30,7 +42,19 @@ DebuggerSubscriber *WebSocketMemoryInit(DebuggerEventHandlerMap &map) {
 	map["memory.write_u16"] = &WebSocketMemoryWriteU16;
 	map["memory.write_u32"] = &WebSocketMemoryWriteU32;
 
-	return nullptr;
+	auto p = new WebSocketMemoryState();
+	map["memory.heatmap.start"] = std::bind(&WebSocketMemoryState::HeatmapStart, p, std::placeholders::_1);
+	map["memory.heatmap.stop"] = std::bind(&WebSocketMemoryState::HeatmapStop, p, std::placeholders::_1);
+	map["memory.heatmap.reset"] = std::bind(&WebSocketMemoryState::HeatmapReset, p, std::placeholders::_1);
+	map["memory.heatmap"] = std::bind(&WebSocketMemoryState::HeatmapGet, p, std::placeholders::_1);
+
+	return p;
+}
+
+WebSocketMemoryState::~WebSocketMemoryState() {
+	// Don't leave the jit slowed down after the debugger goes away.
+	if (heatmapStarted_)
+		MemHeatmap::SetEnabled(false);
 }
 
 // Read a byte from memory (memory.read_u8)
@@ -203,3 +227,82 @@ void WebSocketMemoryWriteU32(DebuggerRequest &req) {
 	JsonWriter &json = req.Respond();
 	json.writeUint("value", Memory::Read_U32(addr));
 }
+
+// Start sampling memory accesses per page (memory.heatmap.start)
+//
+// Parameters:
+//  - interval: optional unsigned integer, sample about one access in this many.  Defaults to 1024.
+//  - reset: optional boolean, true to clear previous counts first.  Defaults to true.
+//
+// Response (same event name) with no extra data.
+//
+// Note: takes effect at the start of the next frame.  Only jitted code (including IR) is sampled.
+void WebSocketMemoryState::HeatmapStart(DebuggerRequest &req) {
+	uint32_t interval = MemHeatmap::DEFAULT_INTERVAL;
+	if (!req.ParamU32("interval", &interval, false, DebuggerParamType::OPTIONAL))
+		return;
+	bool reset = true;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+	if (interval == 0)
+		return req.Fail("Interval must be at least 1");
+
+	if (reset)
+		MemHeatmap::Reset();
+	MemHeatmap::SetEnabled(true, interval);
+	heatmapStarted_ = true;
+	req.Respond();
+}
+
+// Stop sampling memory accesses (memory.heatmap.stop)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.  Counts collected so far remain available.
+void WebSocketMemoryState::HeatmapStop(DebuggerRequest &req) {
+	MemHeatmap::SetEnabled(false);
+	heatmapStarted_ = false;
+	req.Respond();
+}
+
+// Clear sampled memory access counts (memory.heatmap.reset)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+void WebSocketMemoryState::HeatmapReset(DebuggerRequest &req) {
+	MemHeatmap::Reset();
+	req.Respond();
+}
+
+// Retrieve sampled memory access counts (memory.heatmap)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - enabled: boolean, whether accesses are currently being sampled.
+//  - interval: unsigned integer, roughly how many accesses each sample stands for.
+//  - samples: total number of samples taken.
+//  - pageSize: unsigned integer, bytes covered by each page.
+//  - pages: array of objects, lowest address first, only pages sampled at least once:
+//     - address: unsigned integer, start of the page, without the kernel or uncached bits.
+//     - reads: number of sampled loads.
+//     - writes: number of sampled stores.
+void WebSocketMemoryState::HeatmapGet(DebuggerRequest &req) {
+	std::vector<MemHeatmap::PageStats> pages = MemHeatmap::GetPages();
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("enabled", MemHeatmap::IsEnabled());
+	json.writeUint("interval", MemHeatmap::GetInterval());
+	json.writeRaw("samples", StringFromFormat("%llu", (unsigned long long)MemHeatmap::GetSampleCount()));
+	json.writeUint("pageSize", MemHeatmap::PAGE_SIZE);
+	json.pushArray("pages");
+	for (const auto &page : pages) {
+		json.pushDict();
+		json.writeUint("address", page.address);
+		json.writeUint("reads", page.reads);
+		json.writeUint("writes", page.writes);
+		json.pop();
+	}
+	json.pop();
+}
@@ -15,8 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <vector>
+
+#include "Common/TimeUtil.h"
 #include "Core/MemMap.h"
 #include "Core/Reporting.h"
+#include "Core/ThreadPools.h"
 #include "Core/MIPS/MIPSTables.h"
 #include "Core/ELF/ElfReader.h"
 #include "Core/Debugger/Breakpoints.h"
@@ -53,151 +58,207 @@ void addrToHiLo(u32 addr, u16 &hi, s16 &lo)
 	}
 }
 
-bool ElfReader::LoadRelocations(const Elf32_Rel *rels, int numRelocs)
+// Works out the relocated op for rels[r], without writing it back.  Only reads memory,
+// so it can run on several threads as long as nothing else is written meanwhile.
+// When quiet, nothing is logged, and anything that would have been counts as an error.
+bool ElfReader::RelocateOp(const Elf32_Rel *rels, int numRelocs, int r, u32 *outAddr, u32 *outOp, std::atomic<int> &numErrors, bool quiet) const
 {
-	int numErrors = 0;
-	DEBUG_LOG(LOADER, "Loading %i relocations...", numRelocs);
-	for (int r = 0; r < numRelocs; r++)
-	{
-		// INFO_LOG(LOADER, "Loading reloc %i  (%p)...", r, rels + r);
-		u32 info = rels[r].r_info;
-		u32 addr = rels[r].r_offset;
+	// INFO_LOG(LOADER, "Loading reloc %i  (%p)...", r, rels + r);
+	u32 info = rels[r].r_info;
+	u32 addr = rels[r].r_offset;
+	*outAddr = 0;
 
-		int type = info & 0xf;
+	int type = info & 0xf;
 
-		int readwrite = (info>>8) & 0xff; 
-		int relative  = (info>>16) & 0xff;
+	int readwrite = (info>>8) & 0xff; 
+	int relative  = (info>>16) & 0xff;
 
-		//0 = code
-		//1 = data
+	//0 = code
+	//1 = data
 
-		if (readwrite >= (int)ARRAY_SIZE(segmentVAddr)) {
-			if (numErrors < 10) {
-				ERROR_LOG_REPORT(LOADER, "Bad segment number %i", readwrite);
-			}
-			numErrors++;
-			continue;
+	if (readwrite >= (int)ARRAY_SIZE(segmentVAddr)) {
+		if (numErrors++ < 10 && !quiet) {
+			ERROR_LOG_REPORT(LOADER, "Bad segment number %i", readwrite);
 		}
+		return false;
+	}
 
-		addr += segmentVAddr[readwrite];
+	addr += segmentVAddr[readwrite];
 
-		// It appears that misaligned relocations are allowed.
-		// Will they work correctly on big-endian?
+	// It appears that misaligned relocations are allowed.
+	// Will they work correctly on big-endian?
 
-		if (((addr & 3) && type != R_MIPS_32) || !Memory::IsValidAddress(addr)) {
-			if (numErrors < 10) {
-				WARN_LOG_REPORT(LOADER, "Suspicious address %08x, skipping reloc, type = %d", addr, type);
-			} else if (numErrors == 10) {
-				WARN_LOG(LOADER, "Too many bad relocations, skipping logging");
-			}
-			numErrors++;
-			continue;
+	if (((addr & 3) && type != R_MIPS_32) || !Memory::IsValidAddress(addr)) {
+		int errorIndex = numErrors++;
+		if (!quiet && errorIndex < 10) {
+			WARN_LOG_REPORT(LOADER, "Suspicious address %08x, skipping reloc, type = %d", addr, type);
+		} else if (!quiet && errorIndex == 10) {
+			WARN_LOG(LOADER, "Too many bad relocations, skipping logging");
 		}
+		return false;
+	}
 
-		u32 op = Memory::Read_Instruction(addr, true).encoding;
+	u32 op = Memory::Read_Instruction(addr, true).encoding;
 
-		const bool log = false;
-		//log=true;
-		if (log) {
-			DEBUG_LOG(LOADER,"rel at: %08x  info: %08x   type: %i",addr, info, type);
-		}
-		u32 relocateTo = segmentVAddr[relative];
+	const bool log = false;
+	//log=true;
+	if (log) {
+		DEBUG_LOG(LOADER,"rel at: %08x  info: %08x   type: %i",addr, info, type);
+	}
+	u32 relocateTo = segmentVAddr[relative];
 
-		switch (type) 
+	switch (type) 
+	{
+	case R_MIPS_32:
+		if (log)
+			DEBUG_LOG(LOADER,"Full address reloc %08x", addr);
+		//full address, no problemo
+		op += relocateTo;
+		break;
+
+	case R_MIPS_26: //j, jal
+		//add on to put in correct address space
+		if (log)
+			DEBUG_LOG(LOADER,"j/jal reloc %08x", addr);
+		op = (op & 0xFC000000) | (((op&0x03FFFFFF)+(relocateTo>>2))&0x03FFFFFF);
+		break;
+
+	case R_MIPS_HI16: //lui part of lui-addiu pairs
 		{
-		case R_MIPS_32:
-			if (log)
-				DEBUG_LOG(LOADER,"Full address reloc %08x", addr);
-			//full address, no problemo
-			op += relocateTo;
-			break;
-
-		case R_MIPS_26: //j, jal
-			//add on to put in correct address space
 			if (log)
-				DEBUG_LOG(LOADER,"j/jal reloc %08x", addr);
-			op = (op & 0xFC000000) | (((op&0x03FFFFFF)+(relocateTo>>2))&0x03FFFFFF);
-			break;
+				DEBUG_LOG(LOADER,"HI reloc %08x", addr);
 
-		case R_MIPS_HI16: //lui part of lui-addiu pairs
+			u32 cur = (op & 0xFFFF) << 16;
+			u16 hi = 0;
+			bool found = false;
+			for (int t = r + 1; t<numRelocs; t++)
 			{
-				if (log)
-					DEBUG_LOG(LOADER,"HI reloc %08x", addr);
-
-				u32 cur = (op & 0xFFFF) << 16;
-				u16 hi = 0;
-				bool found = false;
-				for (int t = r + 1; t<numRelocs; t++)
+				if ((rels[t].r_info & 0xF) == R_MIPS_LO16) 
 				{
-					if ((rels[t].r_info & 0xF) == R_MIPS_LO16) 
-					{
-						u32 corrLoAddr = rels[t].r_offset + segmentVAddr[readwrite];
-						if (log) {
-							DEBUG_LOG(LOADER,"Corresponding lo found at %08x", corrLoAddr);
-						}
-						if (Memory::IsValidAddress(corrLoAddr)) {
-							s16 lo = (s32)(s16)(u16)(Memory::ReadUnchecked_U32(corrLoAddr) & 0xFFFF); //signed??
-							cur += lo;
-							cur += relocateTo;
-							addrToHiLo(cur, hi, lo);
-							found = true;
-							break;
-						} else {
-							ERROR_LOG(LOADER, "Bad corrLoAddr %08x", corrLoAddr);
-						}
+					u32 corrLoAddr = rels[t].r_offset + segmentVAddr[readwrite];
+					if (log) {
+						DEBUG_LOG(LOADER,"Corresponding lo found at %08x", corrLoAddr);
+					}
+					if (Memory::IsValidAddress(corrLoAddr)) {
+						s16 lo = (s32)(s16)(u16)(Memory::ReadUnchecked_U32(corrLoAddr) & 0xFFFF); //signed??
+						cur += lo;
+						cur += relocateTo;
+						addrToHiLo(cur, hi, lo);
+						found = true;
+						break;
+					} else if (quiet) {
+						numErrors++;
+					} else {
+						ERROR_LOG(LOADER, "Bad corrLoAddr %08x", corrLoAddr);
 					}
 				}
-				if (!found) {
+			}
+			if (!found) {
+				if (quiet)
+					numErrors++;
+				else
 					ERROR_LOG_REPORT(LOADER, "R_MIPS_HI16: could not find R_MIPS_LO16");
-				}
-				op = (op & 0xFFFF0000) | (hi);
 			}
-			break;
+			op = (op & 0xFFFF0000) | (hi);
+		}
+		break;
 
-		case R_MIPS_LO16: //addiu part of lui-addiu pairs
-			{
-				if (log)
-					DEBUG_LOG(LOADER,"LO reloc %08x", addr);
-				u32 cur = op & 0xFFFF;
-				cur += relocateTo;
-				cur &= 0xFFFF;
-				op = (op & 0xFFFF0000) | cur;
-			}
-			break;
+	case R_MIPS_LO16: //addiu part of lui-addiu pairs
+		{
+			if (log)
+				DEBUG_LOG(LOADER,"LO reloc %08x", addr);
+			u32 cur = op & 0xFFFF;
+			cur += relocateTo;
+			cur &= 0xFFFF;
+			op = (op & 0xFFFF0000) | cur;
+		}
+		break;
 
-		case R_MIPS_GPREL16: //gp
-			// It seems safe to ignore this, almost a notification of a gp-relative operation?
-			break;
+	case R_MIPS_GPREL16: //gp
+		// It seems safe to ignore this, almost a notification of a gp-relative operation?
+		break;
 
-		case R_MIPS_16:
-			{
-				char temp[256];
-				op = (op & 0xFFFF0000) | (((int)(op & 0xFFFF) + (int)relocateTo) & 0xFFFF);
-				MIPSDisAsm(MIPSOpcode(op), 0, temp);
-			}
-			break;
+	case R_MIPS_16:
+		{
+			char temp[256];
+			op = (op & 0xFFFF0000) | (((int)(op & 0xFFFF) + (int)relocateTo) & 0xFFFF);
+			MIPSDisAsm(MIPSOpcode(op), 0, temp);
+		}
+		break;
 
-		case R_MIPS_NONE:
-			// This shouldn't matter, not sure the purpose of it.
-			break;
+	case R_MIPS_NONE:
+		// This shouldn't matter, not sure the purpose of it.
+		break;
 
-		default:
-			{
-				char temp[256];
-				MIPSDisAsm(MIPSOpcode(op), 0, temp);
-				ERROR_LOG_REPORT(LOADER,"ARGH IT'S AN UNKNOWN RELOCATION!!!!!!!! %08x, type=%d : %s", addr, type, temp);
+	default:
+		if (quiet) {
+			numErrors++;
+		} else {
+			char temp[256];
+			MIPSDisAsm(MIPSOpcode(op), 0, temp);
+			ERROR_LOG_REPORT(LOADER,"ARGH IT'S AN UNKNOWN RELOCATION!!!!!!!! %08x, type=%d : %s", addr, type, temp);
+		}
+		break;
+	}
+	*outAddr = addr;
+	*outOp = op;
+	return true;
+}
+
+bool ElfReader::LoadRelocations(const Elf32_Rel *rels, int numRelocs)
+{
+	std::atomic<int> numErrors(0);
+	DEBUG_LOG(LOADER, "Loading %i relocations...", numRelocs);
+
+	bool relocated = false;
+	// Below this, the threads cost more than they save.
+	if (numRelocs >= 4096) {
+		// Work everything out in parallel first, since HI16 relocs read their (not yet relocated) LO16.
+		// This pass doesn't log, so anything worth logging is left to the in order pass below.
+		std::vector<u32> addrs(numRelocs);
+		std::vector<u32> ops(numRelocs);
+		GlobalThreadPool::Loop([&](int lower, int upper) {
+			for (int r = lower; r < upper; r++) {
+				if (!RelocateOp(rels, numRelocs, r, &addrs[r], &ops[r], numErrors, true))
+					addrs[r] = 0;
+			}
+		}, 0, numRelocs);
+
+		// If the words of two relocations overlap (R_MIPS_32 may be misaligned), the second has to
+		// see the first's result, so only then do it in order.
+		std::vector<u32> sorted(addrs);
+		std::sort(sorted.begin(), sorted.end());
+		auto firstValid = std::upper_bound(sorted.begin(), sorted.end(), 0U);
+		auto overlap = std::adjacent_find(firstValid, sorted.end(), [](u32 a, u32 b) {
+			return b - a < 4;
+		});
+		if (numErrors != 0) {
+			numErrors = 0;
+		} else if (overlap != sorted.end()) {
+			DEBUG_LOG(LOADER, "Overlapping relocations at %08x, relocating in order", *overlap);
+		} else {
+			for (int r = 0; r < numRelocs; r++) {
+				if (addrs[r] != 0)
+					Memory::Write_U32(ops[r], addrs[r]);
 			}
-			break;
+			relocated = true;
 		}
-		Memory::Write_U32(op, addr);
 	}
+
+	if (!relocated) {
+		for (int r = 0; r < numRelocs; r++) {
+			u32 addr, op;
+			if (RelocateOp(rels, numRelocs, r, &addr, &op, numErrors, false))
+				Memory::Write_U32(op, addr);
+		}
+	}
+
 	if (numErrors) {
-		WARN_LOG(LOADER, "%i bad relocations found!!!", numErrors);
+		WARN_LOG(LOADER, "%i bad relocations found!!!", (int)numErrors);
 	}
 	return numErrors == 0;
 }
 
-
 void ElfReader::LoadRelocations2(int rel_seg)
 {
 	u8 *buf, *end, *flag_table, *type_table;
@@ -504,6 +565,7 @@ int ElfReader::LoadInto(u32 loadAddress, bool fromTop)
 	}
 
 	DEBUG_LOG(LOADER,"Relocations:");
+	double relocationStart = time_now_d();
 
 	// Second pass: Do necessary relocations
 	for (int i = 0; i < GetNumSections(); i++)
@@ -585,6 +647,7 @@ int ElfReader::LoadInto(u32 loadAddress, bool fromTop)
 		}
 	}
 
+	relocationTime = time_now_d() - relocationStart;
 	return SCE_KERNEL_ERROR_OK;
 }
 
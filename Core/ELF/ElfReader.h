@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include "Common/CommonTypes.h"
 #include "Core/ELF/ElfTypes.h"
@@ -137,7 +138,14 @@ public:
 	bool LoadRelocations(const Elf32_Rel *rels, int numRelocs);
 	void LoadRelocations2(int rel_seg);
 
+	// Seconds spent relocating in LoadInto().
+	double GetRelocationTime() const {
+		return relocationTime;
+	}
+
 private:
+	bool RelocateOp(const Elf32_Rel *rels, int numRelocs, int r, u32 *outAddr, u32 *outOp, std::atomic<int> &numErrors, bool quiet) const;
+
 	const char *base = nullptr;
 	const u32_le *base32 = nullptr;
 	const Elf32_Ehdr *header = nullptr;
@@ -151,4 +159,5 @@ private:
 	u32 vaddr = 0;
 	u32 segmentVAddr[32];
 	size_t size_ = 0;
+	double relocationTime = 0.0;
 };
@@ -24,6 +24,7 @@
 
 HTTPFileLoader::HTTPFileLoader(const std::string &filename)
 	: url_(filename), filename_(filename) {
+	client_.SetKeepAlive(true);
 }
 
 void HTTPFileLoader::Prepare() {
@@ -183,31 +184,98 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 		return 0;
 	}
 
-	Connect();
-	if (!connected_) {
-		return 0;
+	u8 *dest = (u8 *)data;
+	s64 pos = absolutePos;
+	bool sequential = absolutePos == filepos_;
+
+	// First use anything we've read ahead, or already have requested.
+	while (pos < absoluteEnd) {
+		pos += TakeReadAhead(pos, absoluteEnd, dest + (pos - absolutePos));
+		if (pos >= absoluteEnd || !IsPending(pos))
+			break;
+		if (!ReadPendingResponse()) {
+			Disconnect();
+			break;
+		}
+	}
+	if (pos != absolutePos) {
+		sequential = true;
+	}
+
+	if (pos < absoluteEnd) {
+		// The responses in flight aren't what we need.  Cheaper to reconnect than read them all.
+		if (!pending_.empty()) {
+			Disconnect();
+		}
+
+		Buffer output;
+		bool success = false;
+		for (int attempt = 0; attempt < 2 && !success; ++attempt) {
+			bool reused = connected_;
+			Connect();
+			if (!connected_) {
+				break;
+			}
+
+			success = SendRangeRequest(pos, absoluteEnd);
+			if (success) {
+				// Pipeline the next requests behind this one, so they're in flight while we read.
+				if (sequential && flags != Flags::HINT_UNCACHED) {
+					QueueReadAhead(absoluteEnd);
+				}
+				success = ReadRangeResponse(pos, absoluteEnd, &output);
+			}
+
+			if (success && reused) {
+				keepAliveWorks_ = true;
+			} else if (!success) {
+				Disconnect();
+				if (!reused) {
+					break;
+				}
+				// Either the server dropped an idle connection, or it doesn't do keep-alive at all.
+				if (!keepAliveWorks_) {
+					WARN_LOG(LOADER, "HTTP server closed a kept alive connection, disabling keep-alive");
+					keepAlive_ = false;
+					client_.SetKeepAlive(false);
+				}
+			}
+		}
+
+		if (!success) {
+			latestError_ = "Invalid response reading data";
+			if (pos == absolutePos) {
+				return 0;
+			}
+		}
+
+		size_t readBytes = std::min((size_t)output.size(), (size_t)(absoluteEnd - pos));
+		output.Take(readBytes, (char *)dest + (pos - absolutePos));
+		pos += readBytes;
+	} else if (flags != Flags::HINT_UNCACHED) {
+		QueueReadAhead(absoluteEnd);
 	}
 
+	filepos_ = pos;
+	return (size_t)(pos - absolutePos);
+}
+
+bool HTTPFileLoader::SendRangeRequest(s64 pos, s64 end) {
 	char requestHeaders[4096];
 	// Note that the Range header is *inclusive*.
 	snprintf(requestHeaders, sizeof(requestHeaders),
-		"Range: bytes=%lld-%lld\r\n", absolutePos, absoluteEnd - 1);
+		"Range: bytes=%lld-%lld\r\n", pos, end - 1);
 
 	int err = client_.SendRequest("GET", url_.Resource().c_str(), requestHeaders, nullptr);
-	if (err < 0) {
-		latestError_ = "Invalid response reading data";
-		Disconnect();
-		return 0;
-	}
+	return err >= 0;
+}
 
-	Buffer readbuf;
+bool HTTPFileLoader::ReadRangeResponse(s64 pos, s64 end, Buffer *output) {
 	std::vector<std::string> responseHeaders;
-	int code = client_.ReadResponseHeaders(&readbuf, responseHeaders);
+	int code = client_.ReadResponseHeaders(&readbuf_, responseHeaders);
 	if (code != 206) {
 		ERROR_LOG(LOADER, "HTTP server did not respond with range, received code=%03d", code);
-		latestError_ = "Invalid response reading data";
-		Disconnect();
-		return 0;
+		return false;
 	}
 
 	// TODO: Expire cache via ETag, etc.
@@ -220,10 +288,10 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 			std::string lowerHeader = header;
 			std::transform(lowerHeader.begin(), lowerHeader.end(), lowerHeader.begin(), tolower);
 			if (sscanf(lowerHeader.c_str(), "content-range: bytes %lld-%lld/%lld", &first, &last, &total) >= 2) {
-				if (first == absolutePos && last == absoluteEnd - 1) {
+				if (first == pos && last == end - 1) {
 					supportedResponse = true;
 				} else {
-					ERROR_LOG(LOADER, "Unexpected HTTP range: got %lld-%lld, wanted %lld-%lld.", first, last, absolutePos, absoluteEnd - 1);
+					ERROR_LOG(LOADER, "Unexpected HTTP range: got %lld-%lld, wanted %lld-%lld.", first, last, pos, end - 1);
 				}
 			} else {
 				ERROR_LOG(LOADER, "Unexpected HTTP range response: %s", header.c_str());
@@ -231,27 +299,116 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 		}
 	}
 
+	std::string connection;
+	if (http::GetHeaderValue(responseHeaders, "Connection", &connection)) {
+		std::transform(connection.begin(), connection.end(), connection.begin(), tolower);
+		if (keepAlive_ && connection.find("close") != connection.npos) {
+			INFO_LOG(LOADER, "HTTP server closes connections, disabling keep-alive");
+			keepAlive_ = false;
+			client_.SetKeepAlive(false);
+		}
+	}
+
 	// TODO: Would be nice to read directly.
-	Buffer output;
-	int res = client_.ReadResponseEntity(&readbuf, responseHeaders, &output);
+	int res = client_.ReadResponseEntity(&readbuf_, responseHeaders, output);
 	if (res != 0) {
 		ERROR_LOG(LOADER, "Unable to read HTTP response entity: %d", res);
 		// Let's take anything we got anyway.  Not worse than returning nothing?
+		// The connection is out of sync now, though.
+		Disconnect();
+	} else if (!keepAlive_) {
+		Disconnect();
 	}
 
-	// TODO: Keepalive instead.
-	Disconnect();
-
 	if (!supportedResponse) {
 		ERROR_LOG(LOADER, "HTTP server did not respond with the range we wanted.");
-		latestError_ = "Invalid response reading data";
+		return false;
+	}
+	return true;
+}
+
+size_t HTTPFileLoader::TakeReadAhead(s64 pos, s64 end, u8 *dest) {
+	s64 aheadEnd = aheadPos_ + (s64)aheadData_.size();
+	if (pos < aheadPos_ || pos >= aheadEnd) {
 		return 0;
 	}
 
-	size_t readBytes = output.size();
-	output.Take(readBytes, (char *)data);
-	filepos_ = absolutePos + readBytes;
-	return readBytes;
+	size_t offset = (size_t)(pos - aheadPos_);
+	size_t count = (size_t)(std::min(end, aheadEnd) - pos);
+	memcpy(dest, &aheadData_[offset], count);
+
+	bool wasUsed = aheadUsed_ >= aheadData_.size();
+	aheadUsed_ = std::max(aheadUsed_, offset + count);
+	if (!wasUsed && aheadUsed_ >= aheadData_.size()) {
+		// All of it got used, so read further ahead next time.
+		chunkSize_ = std::min(chunkSize_ * 2, (s64)MAX_CHUNK_SIZE);
+	}
+	return count;
+}
+
+bool HTTPFileLoader::ReadPendingResponse() {
+	PendingRange range = pending_.front();
+	pending_.pop_front();
+
+	Buffer output;
+	if (!ReadRangeResponse(range.pos, range.end, &output)) {
+		return false;
+	}
+	keepAliveWorks_ = true;
+
+	size_t aheadSize = aheadData_.size();
+	if (aheadSize != 0 && aheadPos_ + (s64)aheadSize == range.pos) {
+		// Continues the current data, just drop what's already been read.
+		aheadData_.erase(aheadData_.begin(), aheadData_.begin() + aheadUsed_);
+		aheadPos_ += aheadUsed_;
+	} else {
+		if (aheadUsed_ < aheadSize) {
+			ShrinkChunkSize();
+		}
+		aheadData_.clear();
+		aheadPos_ = range.pos;
+	}
+	aheadUsed_ = 0;
+
+	size_t count = output.size();
+	if (count != 0) {
+		size_t oldSize = aheadData_.size();
+		aheadData_.resize(oldSize + count);
+		output.Take(count, (char *)&aheadData_[oldSize]);
+	}
+	return true;
+}
+
+bool HTTPFileLoader::IsPending(s64 pos) const {
+	for (const PendingRange &range : pending_) {
+		if (range.pos <= pos && pos < range.end) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void HTTPFileLoader::QueueReadAhead(s64 pos) {
+	if (!keepAlive_ || !connected_) {
+		return;
+	}
+
+	s64 next = pos;
+	if (!pending_.empty()) {
+		next = pending_.back().end;
+	} else if (pos >= aheadPos_ && pos < aheadPos_ + (s64)aheadData_.size()) {
+		next = aheadPos_ + (s64)aheadData_.size();
+	}
+
+	while (pending_.size() < MAX_PENDING_REQUESTS && next < filesize_) {
+		s64 end = std::min(next + chunkSize_, filesize_);
+		if (!SendRangeRequest(next, end)) {
+			Disconnect();
+			return;
+		}
+		pending_.push_back({ next, end });
+		next = end;
+	}
 }
 
 void HTTPFileLoader::Connect() {
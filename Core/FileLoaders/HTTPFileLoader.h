@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <deque>
 #include <mutex>
 #include <vector>
 
@@ -64,8 +66,36 @@ private:
 			client_.Disconnect();
 		}
 		connected_ = false;
+		if (!pending_.empty()) {
+			// Throwing away requested data, so we're probably requesting too much.
+			ShrinkChunkSize();
+		}
+		pending_.clear();
+		readbuf_.clear();
+	}
+
+	bool SendRangeRequest(s64 pos, s64 end);
+	bool ReadRangeResponse(s64 pos, s64 end, Buffer *output);
+	size_t TakeReadAhead(s64 pos, s64 end, u8 *dest);
+	bool ReadPendingResponse();
+	bool IsPending(s64 pos) const;
+	void QueueReadAhead(s64 pos);
+	void ShrinkChunkSize() {
+		chunkSize_ = std::max(chunkSize_ / 2, (s64)MIN_CHUNK_SIZE);
 	}
 
+	// A range request sent on the connection whose response we haven't read yet.
+	struct PendingRange {
+		s64 pos;
+		s64 end;
+	};
+
+	enum {
+		MAX_PENDING_REQUESTS = 4,
+		MIN_CHUNK_SIZE = 64 * 1024,
+		MAX_CHUNK_SIZE = 1024 * 1024,
+	};
+
 	s64 filesize_ = 0;
 	s64 filepos_ = 0;
 	Url url_;
@@ -75,6 +105,22 @@ private:
 	bool cancelConnect_ = false;
 	const char *latestError_ = "";
 
+	// Cleared if the server closes connections, then we make one request per connection.
+	bool keepAlive_ = true;
+	// Set once a request has succeeded on a reused connection.
+	bool keepAliveWorks_ = false;
+	// Pipelined requests, in the order the responses will arrive.
+	std::deque<PendingRange> pending_;
+	// Holds any partial next response, so must persist while the connection does.
+	Buffer readbuf_;
+	// Data read ahead from pending requests, starting at aheadPos_.
+	std::vector<u8> aheadData_;
+	s64 aheadPos_ = 0;
+	// How far into aheadData_ has been read.
+	size_t aheadUsed_ = 0;
+	// Grows while reads are sequential, shrinks when read ahead data is wasted.
+	s64 chunkSize_ = MIN_CHUNK_SIZE;
+
 	std::once_flag preparedFlag_;
 	std::mutex readAtMutex_;
 };
@@ -15,7 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 #include "ppsspp_config.h"
 
@@ -23,6 +25,7 @@
 #include "Common/Log.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DirListing.h"
+#include "Core/Config.h"
 #include "Core/FileLoaders/LocalFileLoader.h"
 
 #ifdef _WIN32
@@ -31,10 +34,33 @@
 #include <fcntl.h>
 #endif
 
+#if PPSSPP_ARCH(64BIT) && !PPSSPP_PLATFORM(SWITCH) && !PPSSPP_PLATFORM(UWP) && !defined(__wiiu__)
+// Only worth the address space on 64-bit.
+#define LOCAL_FILE_MMAP 1
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif
+
 #ifndef O_CLOEXEC
 #define O_CLOEXEC 0
 #endif
 
+// After this many reads in a row, we consider the access pattern sequential or random.
+static const int ACCESS_PATTERN_THRESHOLD = 8;
+// How far ahead to ask the OS to read when sequential.
+static const s64 SEQUENTIAL_PREFETCH_SIZE = 2 * 1024 * 1024;
+// madvise requires page alignment, this covers all the page sizes we run on.
+static const s64 ADVISE_ALIGN = 64 * 1024;
+
+enum {
+	ADVICE_NORMAL,
+	ADVICE_SEQUENTIAL,
+	ADVICE_RANDOM,
+};
+
 LocalFileLoader::LocalFileLoader(const std::string &filename)
 	: filesize_(0), filename_(filename) {
 	if (filename.empty()) {
@@ -56,6 +82,7 @@ LocalFileLoader::LocalFileLoader(const std::string &filename)
 	filesize_ = off;
 	lseek(fd_, 0, SEEK_SET);
 #endif
+	MapFile();
 
 #else // _WIN32
 
@@ -78,10 +105,12 @@ LocalFileLoader::LocalFileLoader(const std::string &filename)
 	}
 	filesize_ = end_offset.QuadPart;
 	SetFilePointerEx(handle_, zero, nullptr, FILE_BEGIN);
+	MapFile();
 #endif // _WIN32
 }
 
 LocalFileLoader::~LocalFileLoader() {
+	UnmapFile();
 #ifndef _WIN32
 	if (fd_ != -1) {
 		close(fd_);
@@ -122,7 +151,113 @@ std::string LocalFileLoader::Path() const {
 	return filename_;
 }
 
+void LocalFileLoader::MapFile() {
+#ifdef LOCAL_FILE_MMAP
+	// If the file can't be read (bad media, removed drive, truncated file), touching the mapping
+	// crashes (SIGBUS / EXCEPTION_IN_PAGE_ERROR) where a regular read would just come up short.
+	// So only when asked to.
+	if (!g_Config.bMemoryMapIso) {
+		return;
+	}
+	if (filesize_ == 0 || filesize_ != (u64)(size_t)filesize_) {
+		return;
+	}
+
+#ifndef _WIN32
+	// Mapping something that isn't a regular file (like a block device) can behave oddly.
+	struct stat st;
+	if (fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+		return;
+	}
+	void *ptr = mmap(nullptr, (size_t)filesize_, PROT_READ, MAP_SHARED, fd_, 0);
+	if (ptr == MAP_FAILED) {
+		WARN_LOG(FILESYS, "Unable to map %s, using regular reads", filename_.c_str());
+		return;
+	}
+	mapped_ = (const u8 *)ptr;
+#else
+	mapping_ = CreateFileMapping(handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_) {
+		WARN_LOG(FILESYS, "Unable to map %s, using regular reads", filename_.c_str());
+		return;
+	}
+	mapped_ = (const u8 *)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (!mapped_) {
+		WARN_LOG(FILESYS, "Unable to map view of %s, using regular reads", filename_.c_str());
+		CloseHandle(mapping_);
+		mapping_ = nullptr;
+	}
+#endif
+#endif
+}
+
+void LocalFileLoader::UnmapFile() {
+#ifdef LOCAL_FILE_MMAP
+#ifndef _WIN32
+	if (mapped_) {
+		munmap((void *)mapped_, (size_t)filesize_);
+	}
+#else
+	if (mapped_) {
+		UnmapViewOfFile(mapped_);
+	}
+	if (mapping_) {
+		CloseHandle(mapping_);
+	}
+	mapping_ = nullptr;
+#endif
+	mapped_ = nullptr;
+#endif
+}
+
+void LocalFileLoader::AdviseAccess(s64 pos, size_t size) {
+#if defined(LOCAL_FILE_MMAP) && !defined(_WIN32) && defined(MADV_WILLNEED)
+	s64 end = pos + (s64)size;
+	s64 expected = nextPos_.exchange(end);
+	if (pos != expected) {
+		sequentialRun_ = 0;
+		if (++randomRun_ == ACCESS_PATTERN_THRESHOLD && advice_.exchange(ADVICE_RANDOM) != ADVICE_RANDOM) {
+			// Scattered small reads, the kernel's readaround would mostly be wasted.
+			madvise((void *)mapped_, (size_t)filesize_, MADV_RANDOM);
+		}
+		return;
+	}
+
+	randomRun_ = 0;
+	if (++sequentialRun_ < ACCESS_PATTERN_THRESHOLD) {
+		return;
+	}
+	if (advice_.exchange(ADVICE_SEQUENTIAL) != ADVICE_SEQUENTIAL) {
+		madvise((void *)mapped_, (size_t)filesize_, MADV_SEQUENTIAL);
+	}
+
+	// Keep a window ahead of the reads on its way in, so we don't stall on page faults.
+	s64 prefetched = prefetchedEnd_;
+	if (end + SEQUENTIAL_PREFETCH_SIZE / 2 > prefetched && end < (s64)filesize_) {
+		s64 start = std::max(prefetched, end) & ~(ADVISE_ALIGN - 1);
+		s64 len = std::min(SEQUENTIAL_PREFETCH_SIZE, (s64)filesize_ - start);
+		madvise((void *)(mapped_ + start), (size_t)len, MADV_WILLNEED);
+		prefetchedEnd_ = start + len;
+	}
+#endif
+}
+
+size_t LocalFileLoader::ReadMapped(s64 absolutePos, size_t bytes, size_t count, void *data) {
+	if (absolutePos < 0 || (u64)absolutePos >= filesize_) {
+		return 0;
+	}
+
+	size_t size = (size_t)std::min((u64)(bytes * count), filesize_ - (u64)absolutePos);
+	AdviseAccess(absolutePos, size);
+	memcpy(data, mapped_ + absolutePos, size);
+	return size / bytes;
+}
+
 size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags) {
+	if (mapped_) {
+		return ReadMapped(absolutePos, bytes, count, data);
+	}
+
 #if PPSSPP_PLATFORM(SWITCH)
 	// Toolchain has no fancy IO API.  We must lock.
 	std::lock_guard<std::mutex> guard(readLock_);
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include "Common/CommonTypes.h"
 #include "Core/Loaders.h"
@@ -36,11 +37,26 @@ public:
 	virtual size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override;
 
 private:
+	void MapFile();
+	void UnmapFile();
+	size_t ReadMapped(s64 absolutePos, size_t bytes, size_t count, void *data);
+	void AdviseAccess(s64 pos, size_t size);
+
 #ifndef _WIN32
 	int fd_;
 #else
 	HANDLE handle_;
+	HANDLE mapping_ = nullptr;
 #endif
+	// The whole file, if we were able to map it.
+	const u8 *mapped_ = nullptr;
+
+	// Access pattern tracking for mapped reads, to pick readahead hints.
+	std::atomic<s64> nextPos_{ 0 };
+	std::atomic<int> sequentialRun_{ 0 };
+	std::atomic<int> randomRun_{ 0 };
+	std::atomic<s64> prefetchedEnd_{ 0 };
+	std::atomic<int> advice_{ 0 };
 	u64 filesize_;
 	std::string filename_;
 	std::mutex readLock_;
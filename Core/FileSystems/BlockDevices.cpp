@@ -18,11 +18,13 @@
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
+#include <memory>
 
 #include "Common/Data/Text/I18n.h"
 #include "Common/File/FileUtil.h"
 #include "Common/Log.h"
 #include "Common/Swap.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Core/Loaders.h"
 #include "Core/Host.h"
 #include "Core/FileSystems/BlockDevices.h"
@@ -34,7 +36,7 @@ extern "C"
 #include "ext/libkirk/kirk_engine.h"
 };
 
-std::mutex NPDRMDemoBlockDevice::mutex_;
+std::mutex NPDRMDemoBlockDevice::kirkMutex_;
 
 BlockDevice *constructBlockDevice(FileLoader *fileLoader) {
 	// Check for CISO
@@ -380,7 +382,7 @@ bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	: fileLoader_(fileLoader)
 {
-	std::lock_guard<std::mutex> guard(mutex_);
+	std::lock_guard<std::mutex> guard(kirkMutex_);
 	MAC_KEY mkey;
 	CIPHER_KEY ckey;
 	u8 np_header[256];
@@ -414,9 +416,6 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	blockSize = blockLBAs*2048;
 	numBlocks = (lbaSize+blockLBAs-1)/blockLBAs; // total blocks;
 
-	blockBuf = new u8[blockSize];
-	tempBuf  = new u8[blockSize];
-
 	tableOffset = *(u32_le*)(np_header+0x6c); // table offset
 
 	tableSize = numBlocks*32;
@@ -440,56 +439,112 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 		p[7] ^= k0;
 		p += 8;
 	}
-
-	currentBlock = -1;
-
 }
 
 NPDRMDemoBlockDevice::~NPDRMDemoBlockDevice()
 {
-	std::lock_guard<std::mutex> guard(mutex_);
+	// The read-ahead thread uses our buffers, so wait for it.
+	{
+		std::lock_guard<std::mutex> guard(blocksMutex_);
+		aheadStop_ = true;
+	}
+	aheadWake_.notify_one();
+	if (aheadThread_.joinable())
+		aheadThread_.join();
+
 	delete [] table;
-	delete [] tempBuf;
-	delete [] blockBuf;
+	for (auto &it : blocks_)
+		delete [] it.second.data;
+	blocks_.clear();
 }
 
 int lzrc_decompress(void *out, int out_len, void *in, int in_len);
 
 bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 {
-	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
-	std::lock_guard<std::mutex> guard(mutex_);
-	CIPHER_KEY ckey;
-	int block, lba, lzsize;
-	size_t readSize;
-	u8 *readBuf;
+	if (blockNumber < 0)
+		return false;
+	u32 block = blockNumber / blockLBAs;
+	int lba = blockNumber % blockLBAs;
+	if (block >= numBlocks)
+		return false;
 
-	lba = blockNumber-currentBlock;
-	if(lba>=0 && lba<blockLBAs){
-		memcpy(outPtr, blockBuf+lba*2048, 2048);
+	std::unique_lock<std::mutex> guard(blocksMutex_);
+	auto cached = blocks_.find(block);
+	if (cached != blocks_.end()) {
+		cached->second.lastUsed = ++generation_;
+		memcpy(outPtr, cached->second.data + lba * 2048, 2048);
+		guard.unlock();
+
+		if (!uncached)
+			StartReadAhead(block + 1);
 		return true;
 	}
+	guard.unlock();
 
-	block = blockNumber/blockLBAs;
-	lba = blockNumber%blockLBAs;
-	currentBlock = block*blockLBAs;
+	u8 *blockBuf = new u8[blockSize];
+	if (!DecryptBlock(block, blockBuf, uncached)) {
+		delete [] blockBuf;
+		return false;
+	}
+	memcpy(outPtr, blockBuf + lba * 2048, 2048);
+
+	if (uncached) {
+		delete [] blockBuf;
+		return true;
+	}
+
+	guard.lock();
+	// The read-ahead thread may have beaten us to it.
+	if (blocks_.find(block) == blocks_.end())
+		CacheBlock(block, blockBuf);
+	else
+		delete [] blockBuf;
+	guard.unlock();
+
+	StartReadAhead(block + 1);
+	return true;
+}
+
+bool NPDRMDemoBlockDevice::DecryptBlock(u32 block, u8 *outBuf, bool uncached)
+{
+	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
+	CIPHER_KEY ckey;
+	int lzsize;
+	size_t readSize;
+	u8 *readBuf;
 
 	if(table[block].unk_1c!=0){
-		if((u32)block==(numBlocks-1))
-			return true; // demos make by fake_np
+		if(block==(numBlocks-1)){
+			// demos make by fake_np
+			memset(outBuf, 0, blockSize);
+			return true;
+		}
 		else
 			return false;
 	}
 
-	if(table[block].size<blockSize)
-		readBuf = tempBuf;
-	else
-		readBuf = blockBuf;
+	if(table[block].size<0 || table[block].size>blockSize){
+		ERROR_LOG(LOADER, "Invalid NPUMDIMG block size %d", table[block].size);
+		NotifyReadError();
+		return false;
+	}
+
+	std::lock_guard<std::mutex> readGuard(readMutex_);
+	std::unique_ptr<u8[]> tempBuf;
+	if(table[block].size<blockSize){
+		tempBuf.reset(new u8[table[block].size]);
+		readBuf = tempBuf.get();
+	}else{
+		readBuf = outBuf;
+	}
 
 	readSize = fileLoader_->ReadAt(psarOffset+table[block].offset, 1, table[block].size, readBuf, flags);
 	if(readSize != (size_t)table[block].size){
-		if((u32)block==(numBlocks-1))
+		if(block==(numBlocks-1)){
+			memset(outBuf, 0, blockSize);
 			return true;
+		}
 		else
 			return false;
 	}
@@ -499,13 +554,14 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	}
 
 	if((table[block].flag&4)==0){
+		std::lock_guard<std::mutex> guard(kirkMutex_);
 		sceDrmBBCipherInit(&ckey, 1, 2, hkey, vkey, table[block].offset>>4);
 		sceDrmBBCipherUpdate(&ckey, readBuf, table[block].size);
 		sceDrmBBCipherFinal(&ckey);
 	}
 
 	if(table[block].size<blockSize){
-		lzsize = lzrc_decompress(blockBuf, 0x00100000, readBuf, table[block].size);
+		lzsize = lzrc_decompress(outBuf, 0x00100000, readBuf, table[block].size);
 		if(lzsize!=blockSize){
 			ERROR_LOG(LOADER, "LZRC decompress error! lzsize=%d\n", lzsize);
 			NotifyReadError();
@@ -513,7 +569,68 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 		}
 	}
 
-	memcpy(outPtr, blockBuf+lba*2048, 2048);
-
 	return true;
 }
+
+void NPDRMDemoBlockDevice::CacheBlock(u32 block, u8 *data)
+{
+	// Caller holds blocksMutex_.
+	if (blocks_.size() >= MAX_BLOCKS_CACHED) {
+		auto oldest = blocks_.begin();
+		for (auto it = blocks_.begin(); it != blocks_.end(); ++it) {
+			if (it->second.lastUsed < oldest->second.lastUsed)
+				oldest = it;
+		}
+		delete [] oldest->second.data;
+		blocks_.erase(oldest);
+	}
+
+	CachedBlock &entry = blocks_[block];
+	entry.data = data;
+	entry.lastUsed = ++generation_;
+}
+
+void NPDRMDemoBlockDevice::StartReadAhead(u32 block)
+{
+	std::unique_lock<std::mutex> guard(blocksMutex_);
+	if (block >= numBlocks || blocks_.find(block) != blocks_.end())
+		return;
+	if (std::find(aheadQueue_.begin(), aheadQueue_.end(), block) != aheadQueue_.end())
+		return;
+
+	// Only the latest few requests matter, older ones were for reads that have moved on.
+	if (aheadQueue_.size() >= 4)
+		aheadQueue_.pop_front();
+	aheadQueue_.push_back(block);
+	if (!aheadThread_.joinable())
+		aheadThread_ = std::thread([this] { ReadAheadFunc(); });
+	guard.unlock();
+	aheadWake_.notify_one();
+}
+
+void NPDRMDemoBlockDevice::ReadAheadFunc()
+{
+	setCurrentThreadName("NPDRMReadAhead");
+
+	std::unique_lock<std::mutex> guard(blocksMutex_);
+	while (true) {
+		aheadWake_.wait(guard, [this] { return aheadStop_ || !aheadQueue_.empty(); });
+		if (aheadStop_)
+			break;
+
+		u32 block = aheadQueue_.front();
+		aheadQueue_.pop_front();
+		if (blocks_.find(block) != blocks_.end())
+			continue;
+
+		guard.unlock();
+		u8 *blockBuf = new u8[blockSize];
+		bool success = DecryptBlock(block, blockBuf, false);
+		guard.lock();
+
+		if (success && blocks_.find(block) == blocks_.end())
+			CacheBlock(block, blockBuf);
+		else
+			delete [] blockBuf;
+	}
+}
@@ -23,7 +23,11 @@
 // The ISOFileSystemReader reads from a BlockDevice, so it automatically works
 // with CISO images.
 
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <thread>
 
 #include "Common/CommonTypes.h"
 #include "Core/ELF/PBPReader.h"
@@ -113,8 +117,25 @@ public:
 	bool IsDisc() override { return false; }
 
 private:
+	struct CachedBlock {
+		u8 *data;
+		u64 lastUsed;
+	};
+
+	enum {
+		MAX_BLOCKS_CACHED = 16,
+	};
+
+	bool DecryptBlock(u32 block, u8 *outBuf, bool uncached);
+	void CacheBlock(u32 block, u8 *data);
+	void StartReadAhead(u32 block);
+	void ReadAheadFunc();
+
 	FileLoader *fileLoader_;
-	static std::mutex mutex_;
+	// File loaders aren't thread safe, so reads and LZRC take this per-device lock.
+	std::mutex readMutex_;
+	// libkirk keeps its state in globals, so decryption is serialized across all devices.
+	static std::mutex kirkMutex_;
 	u32 lbaSize;
 
 	u32 psarOffset;
@@ -126,9 +147,16 @@ private:
 	u8 hkey[16];
 	struct table_info *table;
 
-	int currentBlock;
-	u8 *blockBuf;
-	u8 *tempBuf;
+	// Decrypted blocks, evicted least recently used first.
+	std::map<u32, CachedBlock> blocks_;
+	std::mutex blocksMutex_;
+	u64 generation_ = 0;
+
+	// Blocks for the read-ahead thread to decrypt, also guarded by blocksMutex_.
+	std::deque<u32> aheadQueue_;
+	std::condition_variable aheadWake_;
+	bool aheadStop_ = false;
+	std::thread aheadThread_;
 };
 
 
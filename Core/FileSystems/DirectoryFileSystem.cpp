@@ -25,6 +25,7 @@
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/DiskFree.h"
 #include "Common/File/VFS/VFS.h"
@@ -56,20 +57,61 @@
 #include <fcntl.h>
 #endif
 
+// How long (in seconds) cached host metadata is trusted before we ask the host again.
+static const double HOST_CACHE_TTL = 1.0;
+
 #if HOST_IS_CASE_SENSITIVE
-static bool FixFilenameCase(const std::string &path, std::string &filename)
+static std::string LowerCaseFilename(const std::string &filename) {
+	std::string lower = filename;
+	for (size_t i = 0; i < lower.size(); i++)
+		lower[i] = tolower(lower[i]);
+	return lower;
+}
+
+static const FixPathCaseDirectory &ScanPathCase(const std::string &path, FixPathCaseCache *cache) {
+	double now = time_now_d();
+	auto it = cache->find(path);
+	if (it != cache->end() && now - it->second.scanTime < HOST_CACHE_TTL)
+		return it->second;
+
+	FixPathCaseDirectory &dir = (*cache)[path];
+	dir.names.clear();
+	dir.lowerNames.clear();
+	dir.scanTime = now;
+	DIR *dirp = opendir(path.c_str());
+	if (!dirp)
+		return dir;
+
+	struct dirent *result = NULL;
+	while ((result = readdir(dirp))) {
+		dir.names.insert(result->d_name);
+		// Like the uncached scan, the last match wins if several differ only in case.
+		dir.lowerNames[LowerCaseFilename(result->d_name)] = result->d_name;
+	}
+	closedir(dirp);
+	return dir;
+}
+
+static bool FixFilenameCase(const std::string &path, std::string &filename, FixPathCaseCache *cache)
 {
+	if (cache) {
+		const FixPathCaseDirectory &dir = ScanPathCase(path, cache);
+		if (dir.names.count(filename))
+			return true;
+		auto match = dir.lowerNames.find(LowerCaseFilename(filename));
+		if (match == dir.lowerNames.end())
+			return false;
+		filename = match->second;
+		return true;
+	}
+
 	// Are we lucky?
 	if (File::Exists(path + filename))
 		return true;
 
 	size_t filenameSize = filename.size();  // size in bytes, not characters
-	for (size_t i = 0; i < filenameSize; i++)
-	{
-		filename[i] = tolower(filename[i]);
-	}
+	filename = LowerCaseFilename(filename);
 
-	//TODO: lookup filename in cache for "path"
 	struct dirent *result = NULL;
 
 	DIR *dirp = opendir(path.c_str());
@@ -102,7 +144,7 @@ static bool FixFilenameCase(const std::string &path, std::string &filename)
 	return retValue;
 }
 
-bool FixPathCase(const std::string &basePath, std::string &path, FixPathCaseBehavior behavior)
+bool FixPathCase(const std::string &basePath, std::string &path, FixPathCaseBehavior behavior, FixPathCaseCache *cache)
 {
 	size_t len = path.size();
 
@@ -133,7 +175,7 @@ bool FixPathCase(const std::string &basePath, std::string &path, FixPathCaseBeha
 			std::string component = path.substr(start, i - start);
 
 			// Fix case and stop on nonexistant path component
-			if (FixFilenameCase(fullPath, component) == false) {
+			if (FixFilenameCase(fullPath, component, cache) == false) {
 				// Still counts as success if partial matches allowed or if this
 				// is the last component and only the ones before it are required
 				return (behavior == FPC_PARTIAL_ALLOWED || (behavior == FPC_PATH_MUST_EXIST && i >= len));
@@ -180,13 +222,13 @@ std::string DirectoryFileHandle::GetLocalPath(const std::string &basePath, std::
 	return result;
 }
 
-bool DirectoryFileHandle::Open(const std::string &basePath, std::string &fileName, FileAccess access, u32 &error) {
+bool DirectoryFileHandle::Open(const std::string &basePath, std::string &fileName, FileAccess access, u32 &error, FixPathCaseCache *caseCache) {
 	error = 0;
 
 #if HOST_IS_CASE_SENSITIVE
 	if (access & (FILEACCESS_APPEND|FILEACCESS_CREATE|FILEACCESS_WRITE)) {
 		DEBUG_LOG(FILESYS, "Checking case for path %s", fileName.c_str());
-		if (!FixPathCase(basePath, fileName, FPC_PATH_MUST_EXIST)) {
+		if (!FixPathCase(basePath, fileName, FPC_PATH_MUST_EXIST, caseCache)) {
 			error = SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
 			return false;  // or go on and attempt (for a better error code than just 0?)
 		}
@@ -286,7 +328,7 @@ bool DirectoryFileHandle::Open(const std::string &basePath, std::string &fileNam
 
 #if HOST_IS_CASE_SENSITIVE
 	if (!success && !(access & FILEACCESS_CREATE)) {
-		if (!FixPathCase(basePath, fileName, FPC_PATH_MUST_EXIST)) {
+		if (!FixPathCase(basePath, fileName, FPC_PATH_MUST_EXIST, caseCache)) {
 			error = SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
 			return false;
 		}
@@ -469,6 +511,69 @@ void DirectoryFileSystem::CloseAll() {
 	entries.clear();
 }
 
+// Guest paths are case insensitive and may use either slash, so "/PSP/SAVEDATA/" and
+// "psp\\savedata" share an entry.  No leading or trailing slash, the root is "".
+static std::string CacheKey(const std::string &path) {
+	std::string key;
+	key.reserve(path.size());
+	for (char c : path) {
+		if (c == '/' || c == '\\') {
+			if (!key.empty() && key.back() != '/')
+				key.push_back('/');
+		} else {
+			key.push_back(tolower(c));
+		}
+	}
+	if (!key.empty() && key.back() == '/')
+		key.pop_back();
+	return key;
+}
+
+static std::string ParentCacheKey(const std::string &key) {
+	size_t slash = key.find_last_of('/');
+	return slash == key.npos ? "" : key.substr(0, slash);
+}
+
+template <typename T>
+static void EraseCacheSubtree(std::map<std::string, T> &cache, const std::string &key) {
+	cache.erase(key);
+	const std::string prefix = key.empty() ? key : key + "/";
+	auto it = cache.lower_bound(prefix);
+	while (it != cache.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+		it = cache.erase(it);
+}
+
+void DirectoryFileSystem::InvalidateCache() {
+	fileInfoCache_.clear();
+	dirListingCache_.clear();
+	caseCache_.clear();
+}
+
+void DirectoryFileSystem::InvalidatePath(const std::string &path, bool namesChanged) {
+	const std::string key = CacheKey(path);
+	const std::string parent = ParentCacheKey(key);
+	dirListingCache_.erase(parent);
+	if (!namesChanged) {
+		fileInfoCache_.erase(key);
+		return;
+	}
+
+	EraseCacheSubtree(fileInfoCache_, key);
+	EraseCacheSubtree(dirListingCache_, key);
+	// These are keyed by the host directory path (case fixed), so compare the same way.
+	const std::string prefix = key + "/";
+	for (auto it = caseCache_.begin(); it != caseCache_.end(); ) {
+		const std::string &hostDir = it->first;
+		bool inBase = hostDir.compare(0, basePath.size(), basePath) == 0;
+		std::string dirKey = CacheKey(inBase ? hostDir.substr(basePath.size()) : hostDir);
+		bool under = key.empty() || dirKey == key || dirKey.compare(0, prefix.size(), prefix) == 0;
+		if (under || dirKey == parent)
+			it = caseCache_.erase(it);
+		else
+			++it;
+	}
+}
+
 std::string DirectoryFileSystem::GetLocalPath(std::string localpath) {
 	if (localpath.empty())
 		return basePath;
@@ -492,13 +597,14 @@ bool DirectoryFileSystem::MkDir(const std::string &dirname) {
 	// duplicate (different case) directories
 
 	std::string fixedCase = dirname;
-	if (!FixPathCase(basePath,fixedCase, FPC_PARTIAL_ALLOWED))
+	if (!FixPathCase(basePath,fixedCase, FPC_PARTIAL_ALLOWED, &caseCache_))
 		result = false;
 	else
 		result = File::CreateFullPath(GetLocalPath(fixedCase));
 #else
 	result = File::CreateFullPath(GetLocalPath(dirname));
 #endif
+	InvalidatePath(dirname, true);
 	return ReplayApplyDisk(ReplayAction::MKDIR, result, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
@@ -507,12 +613,14 @@ bool DirectoryFileSystem::RmDir(const std::string &dirname) {
 
 #if HOST_IS_CASE_SENSITIVE
 	// Maybe we're lucky?
-	if (File::DeleteDirRecursively(fullName))
+	if (File::DeleteDirRecursively(fullName)) {
+		InvalidatePath(dirname, true);
 		return (bool)ReplayApplyDisk(ReplayAction::RMDIR, true, CoreTiming::GetGlobalTimeUs());
+	}
 
 	// Nope, fix case and try again.  Should we try again?
 	fullName = dirname;
-	if (!FixPathCase(basePath,fullName, FPC_FILE_MUST_EXIST))
+	if (!FixPathCase(basePath,fullName, FPC_FILE_MUST_EXIST, &caseCache_))
 		return (bool)ReplayApplyDisk(ReplayAction::RMDIR, false, CoreTiming::GetGlobalTimeUs());
 
 	fullName = GetLocalPath(fullName);
@@ -524,6 +632,7 @@ bool DirectoryFileSystem::RmDir(const std::string &dirname) {
 	return 0 == rmdir(fullName.c_str());
 #endif*/
 	bool result = File::DeleteDirRecursively(fullName);
+	InvalidatePath(dirname, true);
 	return ReplayApplyDisk(ReplayAction::RMDIR, result, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
@@ -545,10 +654,11 @@ int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &
 		return ReplayApplyDisk(ReplayAction::FILE_RENAME, SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS, CoreTiming::GetGlobalTimeUs());
 
 	std::string fullFrom = GetLocalPath(from);
+	const std::string guestTo = fullTo;
 
 #if HOST_IS_CASE_SENSITIVE
 	// In case TO should overwrite a file with different case.  Check error code?
-	if (!FixPathCase(basePath,fullTo, FPC_PATH_MUST_EXIST))
+	if (!FixPathCase(basePath,fullTo, FPC_PATH_MUST_EXIST, &caseCache_))
 		return ReplayApplyDisk(ReplayAction::FILE_RENAME, -1, CoreTiming::GetGlobalTimeUs());
 #endif
 
@@ -566,7 +676,7 @@ int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &
 	{
 		// May have failed due to case sensitivity on FROM, so try again.  Check error code?
 		fullFrom = from;
-		if (!FixPathCase(basePath,fullFrom, FPC_FILE_MUST_EXIST))
+		if (!FixPathCase(basePath,fullFrom, FPC_FILE_MUST_EXIST, &caseCache_))
 			return ReplayApplyDisk(ReplayAction::FILE_RENAME, -1, CoreTiming::GetGlobalTimeUs());
 		fullFrom = GetLocalPath(fullFrom);
 
@@ -578,6 +688,11 @@ int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &
 	}
 #endif
 
+	if (retValue) {
+		InvalidatePath(from, true);
+		InvalidatePath(guestTo, true);
+	}
+
 	// TODO: Better error codes.
 	int result = retValue ? 0 : (int)SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS;
 	return ReplayApplyDisk(ReplayAction::FILE_RENAME, result, CoreTiming::GetGlobalTimeUs());
@@ -596,7 +711,7 @@ bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
 	{
 		// May have failed due to case sensitivity, so try again.  Try even if it fails?
 		fullName = filename;
-		if (!FixPathCase(basePath,fullName, FPC_FILE_MUST_EXIST))
+		if (!FixPathCase(basePath,fullName, FPC_FILE_MUST_EXIST, &caseCache_))
 			return (bool)ReplayApplyDisk(ReplayAction::FILE_REMOVE, false, CoreTiming::GetGlobalTimeUs());
 		fullName = GetLocalPath(fullName);
 
@@ -608,13 +723,17 @@ bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
 	}
 #endif
 
+	if (retValue)
+		InvalidatePath(filename, true);
 	return ReplayApplyDisk(ReplayAction::FILE_REMOVE, retValue, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
 int DirectoryFileSystem::OpenFile(std::string filename, FileAccess access, const char *devicename) {
 	OpenFileEntry entry;
 	u32 err = 0;
-	bool success = entry.hFile.Open(basePath, filename, access, err);
+	bool success = entry.hFile.Open(basePath, filename, access, err, &caseCache_);
+	if (success && (access & (FILEACCESS_WRITE | FILEACCESS_APPEND | FILEACCESS_CREATE | FILEACCESS_TRUNCATE)))
+		InvalidatePath(filename, (access & FILEACCESS_CREATE) != 0);
 	if (err == 0 && !success) {
 		err = SCE_KERNEL_ERROR_ERRNO_FILE_NOT_FOUND;
 	}
@@ -650,6 +769,8 @@ void DirectoryFileSystem::CloseFile(u32 handle) {
 	if (iter != entries.end()) {
 		hAlloc->FreeHandle(handle);
 		iter->second.hFile.Close();
+		if (iter->second.access & (FILEACCESS_WRITE | FILEACCESS_APPEND | FILEACCESS_TRUNCATE))
+			InvalidatePath(iter->second.guestFilename, false);
 		entries.erase(iter);
 	} else {
 		//This shouldn't happen...
@@ -702,6 +823,7 @@ size_t DirectoryFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, i
 	if (iter != entries.end())
 	{
 		size_t bytesWritten = iter->second.hFile.Write(pointer,size);
+		InvalidatePath(iter->second.guestFilename, false);
 		return bytesWritten;
 	} else {
 		//This shouldn't happen...
@@ -722,19 +844,33 @@ size_t DirectoryFileSystem::SeekFile(u32 handle, s32 position, FileMove type) {
 }
 
 PSPFileInfo DirectoryFileSystem::GetFileInfo(std::string filename) {
+	const std::string cacheKey = CacheKey(filename);
+	const double now = time_now_d();
+	auto cached = fileInfoCache_.find(cacheKey);
+	if (cached != fileInfoCache_.end() && now - cached->second.time < HOST_CACHE_TTL) {
+		PSPFileInfo x = cached->second.info;
+		x.name = filename;
+		return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
+	}
+
 	PSPFileInfo x;
 	x.name = filename;
 
 	std::string fullName = GetLocalPath(filename);
 	if (!File::Exists(fullName)) {
 #if HOST_IS_CASE_SENSITIVE
-		if (! FixPathCase(basePath,filename, FPC_FILE_MUST_EXIST))
+		if (! FixPathCase(basePath,filename, FPC_FILE_MUST_EXIST, &caseCache_)) {
+			fileInfoCache_[cacheKey] = { x, now };
 			return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
+		}
 		fullName = GetLocalPath(filename);
 
-		if (! File::Exists(fullName))
+		if (! File::Exists(fullName)) {
+			fileInfoCache_[cacheKey] = { x, now };
 			return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
+		}
 #else
+		fileInfoCache_[cacheKey] = { x, now };
 		return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
 #endif
 	}
@@ -758,6 +894,7 @@ PSPFileInfo DirectoryFileSystem::GetFileInfo(std::string filename) {
 		}
 	}
 
+	fileInfoCache_[cacheKey] = { x, now };
 	return ReplayApplyDiskFileInfo(x, CoreTiming::GetGlobalTimeUs());
 }
 
@@ -840,7 +977,16 @@ static std::string SimulateVFATBug(std::string filename) {
 }
 
 std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(std::string path) {
-	std::vector<PSPFileInfo> myVector;
+	const std::string cacheKey = CacheKey(path);
+	const double now = time_now_d();
+	auto cached = dirListingCache_.find(cacheKey);
+	if (cached != dirListingCache_.end() && now - cached->second.time < HOST_CACHE_TTL)
+		return ReplayApplyDiskListing(cached->second.entries, CoreTiming::GetGlobalTimeUs());
+
+	CachedDirListing &listing = dirListingCache_[cacheKey];
+	listing.entries.clear();
+	listing.time = now;
+	std::vector<PSPFileInfo> &myVector = listing.entries;
 	bool listingRoot = path == "/" || path == "\\";
 
 #ifdef _WIN32
@@ -898,7 +1044,7 @@ std::vector<PSPFileInfo> DirectoryFileSystem::GetDirListing(std::string path) {
 	DIR *dp = opendir(localPath.c_str());
 
 #if HOST_IS_CASE_SENSITIVE
-	if (dp == NULL && FixPathCase(basePath,path, FPC_FILE_MUST_EXIST)) {
+	if (dp == NULL && FixPathCase(basePath,path, FPC_FILE_MUST_EXIST, &caseCache_)) {
 		// May have failed due to case sensitivity, try again
 		localPath = GetLocalPath(path);
 		dp = opendir(localPath.c_str());
@@ -952,7 +1098,7 @@ u64 DirectoryFileSystem::FreeSpace(const std::string &path) {
 
 #if HOST_IS_CASE_SENSITIVE
 	std::string fixedCase = path;
-	if (FixPathCase(basePath, fixedCase, FPC_FILE_MUST_EXIST)) {
+	if (FixPathCase(basePath, fixedCase, FPC_FILE_MUST_EXIST, &caseCache_)) {
 		// May have failed due to case sensitivity, try again.
 		if (free_disk_space(GetLocalPath(fixedCase), result)) {
 			return ReplayApplyDisk64(ReplayAction::FREESPACE, result, CoreTiming::GetGlobalTimeUs());
@@ -983,6 +1129,7 @@ void DirectoryFileSystem::DoState(PointerWrap &p) {
 
 	if (p.mode == p.MODE_READ) {
 		CloseAll();
+		InvalidateCache();
 		u32 key;
 		OpenFileEntry entry;
 		for (u32 i = 0; i < num; i++) {
@@ -990,7 +1137,7 @@ void DirectoryFileSystem::DoState(PointerWrap &p) {
 			Do(p, entry.guestFilename);
 			Do(p, entry.access);
 			u32 err;
-			if (!entry.hFile.Open(basePath,entry.guestFilename,entry.access, err)) {
+			if (!entry.hFile.Open(basePath,entry.guestFilename,entry.access, err, &caseCache_)) {
 				ERROR_LOG(FILESYS, "Failed to reopen file while loading state: %s", entry.guestFilename.c_str());
 				continue;
 			}
@@ -20,6 +20,7 @@
 // TODO: Remove the Windows-specific code, FILE is fine there too.
 
 #include <map>
+#include <set>
 #include "Core/FileSystems/FileSystem.h"
 
 #ifdef _WIN32
@@ -46,6 +47,17 @@ typedef void * HANDLE;
 
 #endif
 
+// Directory contents seen while fixing case, keyed by host directory path (with trailing slash.)
+// Filled on the first case miss in each directory, so later misses don't scan it again.
+// Rescanned once older than a second, so files added on the host side show up.
+struct FixPathCaseDirectory {
+	std::set<std::string> names;
+	// Lowercased name -> actual name.
+	std::map<std::string, std::string> lowerNames;
+	double scanTime = 0.0;
+};
+typedef std::map<std::string, FixPathCaseDirectory> FixPathCaseCache;
+
 #if HOST_IS_CASE_SENSITIVE
 enum FixPathCaseBehavior {
 	FPC_FILE_MUST_EXIST,  // all path components must exist (rmdir, move from)
@@ -53,7 +65,7 @@ enum FixPathCaseBehavior {
 	FPC_PARTIAL_ALLOWED,  // don't care how many exist (mkdir recursive)
 };
 
-bool FixPathCase(const std::string &basePath, std::string &path, FixPathCaseBehavior behavior);
+bool FixPathCase(const std::string &basePath, std::string &path, FixPathCaseBehavior behavior, FixPathCaseCache *cache = nullptr);
 #endif
 
 struct DirectoryFileHandle {
@@ -75,7 +87,7 @@ struct DirectoryFileHandle {
 	}
 
 	std::string GetLocalPath(const std::string &basePath, std::string localpath);
-	bool Open(const std::string &basePath, std::string &fileName, FileAccess access, u32 &err);
+	bool Open(const std::string &basePath, std::string &fileName, FileAccess access, u32 &err, FixPathCaseCache *caseCache = nullptr);
 	size_t Read(u8* pointer, s64 size);
 	size_t Write(const u8* pointer, s64 size);
 	size_t Seek(s32 position, FileMove type);
@@ -123,8 +135,29 @@ private:
 	std::string basePath;
 	IHandleAllocator *hAlloc;
 	FileSystemFlags flags;
+
+	// Host metadata, keyed by the normalized guest path (see CacheKey.)  Games (and savedata listing
+	// especially) ask for the same files over and over, so we only go to the host once in a while.
+	// Our own changes drop just the affected entries; changes made on the host side are picked up
+	// when an entry gets older than a second.
+	struct CachedFileInfo {
+		PSPFileInfo info;
+		double time;
+	};
+	struct CachedDirListing {
+		std::vector<PSPFileInfo> entries;
+		double time;
+	};
+	std::map<std::string, CachedFileInfo> fileInfoCache_;
+	std::map<std::string, CachedDirListing> dirListingCache_;
+	FixPathCaseCache caseCache_;
+
 	// In case of Windows: Translate slashes, etc.
 	std::string GetLocalPath(std::string localpath);
+	void InvalidateCache();
+	// Drops cached info for path and the listing of its parent.  If names may have changed
+	// (create, remove, rename), also anything under path and the case lookups for its parent.
+	void InvalidatePath(const std::string &path, bool namesChanged);
 };
 
 // VFSFileSystem: Ability to map in Android APK paths as well! Does not support all features, only meant for fonts.
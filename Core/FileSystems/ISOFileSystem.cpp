@@ -194,6 +194,7 @@ ISOFileSystem::ISOFileSystem(IHandleAllocator *_hAlloc, BlockDevice *_blockDevic
 
 	treeroot->startsector = desc.root.firstDataSector();
 	treeroot->dirsize = desc.root.dataLength();
+	pathIndex_.insert(PathIndex::value_type("", treeroot));
 }
 
 ISOFileSystem::~ISOFileSystem() {
@@ -201,7 +202,32 @@ ISOFileSystem::~ISOFileSystem() {
 	delete treeroot;
 }
 
-void ISOFileSystem::ReadDirectory(TreeEntry *root) {
+std::string ISOFileSystem::IndexKey(const std::string &path, size_t start, size_t end) {
+	std::string key;
+	key.resize(end - start);
+	for (size_t i = start; i < end; ++i)
+		key[i - start] = (char)tolower((unsigned char)path[i]);
+	return key;
+}
+
+ISOFileSystem::TreeEntry *ISOFileSystem::LookupIndex(const std::string &key, const std::string &path, size_t start) {
+	auto range = pathIndex_.equal_range(key);
+	if (range.first == range.second)
+		return nullptr;
+
+	// Several names that only differ in case.  The old search was case sensitive, so an exact match wins.
+	auto second = range.first;
+	if (++second != range.second) {
+		for (auto it = range.first; it != range.second; ++it) {
+			const std::string full = EntryFullPath(it->second);
+			if (full.size() == key.size() + 1 && full.compare(1, key.size(), path, start, key.size()) == 0)
+				return it->second;
+		}
+	}
+	return range.first->second;
+}
+
+void ISOFileSystem::ReadDirectory(TreeEntry *root, const std::string &rootKey) {
 	for (u32 secnum = root->startsector, endsector = root->startsector + (root->dirsize + 2047) / 2048; secnum < endsector; ++secnum) {
 		u8 theSector[2048];
 		if (!blockDevice->ReadBlock(secnum, theSector)) {
@@ -262,6 +288,11 @@ void ISOFileSystem::ReadDirectory(TreeEntry *root) {
 				}
 			}
 			root->children.push_back(entry);
+
+			// Names that only differ in case share a key, LookupIndex() sorts them out.
+			std::string key = rootKey.empty() ? rootKey : rootKey + "/";
+			key += IndexKey(entry->name, 0, entry->name.size());
+			pathIndex_.insert(PathIndex::value_type(key, entry));
 		}
 	}
 	root->valid = true;
@@ -285,50 +316,42 @@ ISOFileSystem::TreeEntry *ISOFileSystem::GetFromPath(const std::string &path, bo
 	if (pathLength > pathIndex && path[pathIndex] == '/')
 		++pathIndex;
 
-	if (pathLength <= pathIndex)
-		return treeroot;
+	// "dir/" is the same as "dir".
+	size_t pathEnd = pathLength;
+	if (pathEnd > pathIndex + 1 && path[pathEnd - 1] == '/')
+		--pathEnd;
+
+	const std::string key = IndexKey(path, pathIndex, pathEnd);
+	TreeEntry *entry = LookupIndex(key, path, pathIndex);
+	if (!entry) {
+		// Not indexed yet.  Read the parent directories in turn, which indexes their children.
+		size_t componentStart = 0;
+		while (true) {
+			const std::string dirKey = componentStart == 0 ? std::string() : key.substr(0, componentStart - 1);
+			TreeEntry *dir = LookupIndex(dirKey, path, pathIndex);
+			if (!dir || !dir->isDirectory)
+				break;
+			if (!dir->valid)
+				ReadDirectory(dir, dirKey);
 
-	TreeEntry *entry = treeroot;
-	while (true) {
-		if (!entry->valid) {
-			ReadDirectory(entry);
-		}
-		TreeEntry *nextEntry = nullptr;
-		std::string name = "";
-		if (pathLength > pathIndex) {
-			size_t nextSlashIndex = path.find_first_of('/', pathIndex);
-			if (nextSlashIndex == std::string::npos)
-				nextSlashIndex = pathLength;
-
-			const std::string firstPathComponent = path.substr(pathIndex, nextSlashIndex - pathIndex);
-			for (size_t i = 0; i < entry->children.size(); i++) {
-				const std::string &n = entry->children[i]->name;
-				if (firstPathComponent == n) {
-					//yay we got it
-					nextEntry = entry->children[i];
-					name = n;
-					break;
-				}
+			size_t nextSlash = key.find('/', componentStart);
+			if (nextSlash == std::string::npos) {
+				entry = LookupIndex(key, path, pathIndex);
+				break;
 			}
+			componentStart = nextSlash + 1;
 		}
-		
-		if (nextEntry) {
-			entry = nextEntry;
-			if (!entry->valid)
-				ReadDirectory(entry);
-			pathIndex += name.length();
-			if (pathIndex < pathLength && path[pathIndex] == '/')
-				++pathIndex;
-
-			if (pathLength <= pathIndex)
-				return entry;
-		} else {
-			if (catchError)
-				ERROR_LOG(FILESYS, "File '%s' not found", path.c_str());
+	}
 
-			return 0;
-		}
+	if (!entry) {
+		if (catchError)
+			ERROR_LOG(FILESYS, "File '%s' not found", path.c_str());
+		return 0;
 	}
+
+	if (!entry->valid)
+		ReadDirectory(entry, key);
+	return entry;
 }
 
 int ISOFileSystem::OpenFile(std::string filename, FileAccess access, const char *devicename) {
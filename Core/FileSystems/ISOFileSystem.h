@@ -19,6 +19,8 @@
 
 #include <map>
 #include <list>
+#include <string>
+#include <unordered_map>
 
 #include "FileSystem.h"
 
@@ -92,8 +94,17 @@ private:
 
 	TreeEntry entireISO;
 
-	void ReadDirectory(TreeEntry *root);
+	// Flat index of every entry read so far, keyed by lowercased path relative to the root
+	// (no leading or trailing slash, "" is the root.)  Directories are still read lazily,
+	// their children are added here the first time they're needed.
+	typedef std::unordered_multimap<std::string, TreeEntry *> PathIndex;
+	PathIndex pathIndex_;
+
+	void ReadDirectory(TreeEntry *root, const std::string &rootKey);
 	TreeEntry *GetFromPath(const std::string &path, bool catchError = true);
+	static std::string IndexKey(const std::string &path, size_t start, size_t end);
+	// Key is IndexKey(path, start, ...), path is used to prefer an exact case match.
+	TreeEntry *LookupIndex(const std::string &key, const std::string &path, size_t start);
 	std::string EntryFullPath(TreeEntry *e);
 };
 
@@ -275,7 +275,7 @@ int VirtualDiscFileSystem::getFileListIndex(std::string &fileName)
 	std::string fullName = GetLocalPath(fileName);
 	if (! File::Exists(fullName)) {
 #if HOST_IS_CASE_SENSITIVE
-		if (! FixPathCase(basePath,fileName, FPC_FILE_MUST_EXIST))
+		if (! FixPathCase(basePath,fileName, FPC_FILE_MUST_EXIST, &caseCache_))
 			return -1;
 		fullName = GetLocalPath(fileName);
 
@@ -602,7 +602,7 @@ PSPFileInfo VirtualDiscFileSystem::GetFileInfo(std::string filename) {
 	std::string fullName = GetLocalPath(filename);
 	if (! File::Exists(fullName)) {
 #if HOST_IS_CASE_SENSITIVE
-		if (! FixPathCase(basePath,filename, FPC_FILE_MUST_EXIST))
+		if (! FixPathCase(basePath,filename, FPC_FILE_MUST_EXIST, &caseCache_))
 			return x;
 		fullName = GetLocalPath(filename);
 
@@ -666,7 +666,11 @@ static void tmFromFiletime(tm &dest, FILETIME &src)
 
 std::vector<PSPFileInfo> VirtualDiscFileSystem::GetDirListing(std::string path)
 {
-	std::vector<PSPFileInfo> myVector;
+	auto cached = dirListingCache_.find(path);
+	if (cached != dirListingCache_.end())
+		return cached->second;
+
+	std::vector<PSPFileInfo> &myVector = dirListingCache_[path];
 #ifdef _WIN32
 	WIN32_FIND_DATA findData;
 	HANDLE hFind;
@@ -714,7 +718,7 @@ std::vector<PSPFileInfo> VirtualDiscFileSystem::GetDirListing(std::string path)
 	DIR *dp = opendir(localPath.c_str());
 
 #if HOST_IS_CASE_SENSITIVE
-	if(dp == NULL && FixPathCase(basePath,path, FPC_FILE_MUST_EXIST)) {
+	if(dp == NULL && FixPathCase(basePath,path, FPC_FILE_MUST_EXIST, &caseCache_)) {
 		// May have failed due to case sensitivity, try again
 		localPath = GetLocalPath(path);
 		dp = opendir(localPath.c_str());
@@ -184,4 +184,8 @@ private:
 	u32 lastReadBlock_;
 
 	std::map<std::string, Handler *> handlers;
+
+	// The disc is read-only, so host listings and case lookups can be kept for the whole session.
+	std::map<std::string, std::vector<PSPFileInfo>> dirListingCache_;
+	FixPathCaseCache caseCache_;
 };
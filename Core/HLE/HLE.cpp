@@ -15,8 +15,11 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <atomic>
 #include <cstdarg>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -70,6 +73,23 @@ static const char *hleAfterSyscallReschedReason;
 static const HLEFunction *latestSyscall = nullptr;
 static int idleOp;
 
+struct HLESyscallEntry {
+	// Picked once when registered, so calls don't need to check flags.
+	void (*call)(const HLEFunction *info);
+	const HLEFunction *info;
+};
+
+// Every registered function, module after module.
+static std::vector<HLESyscallEntry> syscallTable;
+// Index of each module's first function in syscallTable, indexed the same as moduleDB.
+static std::vector<u32> syscallModuleBase;
+
+static int GetSyscallIndex(MIPSOpcode op);
+void CallSyscallWithFlags(const HLEFunction *info);
+void CallSyscallWithoutFlags(const HLEFunction *info);
+static void CallIdleSyscall(const HLEFunction *info);
+static void CallUnimplementedSyscall(const HLEFunction *info);
+
 struct HLEMipsCallInfo {
 	u32 func;
 	PSPAction *action;
@@ -92,6 +112,30 @@ struct HLEMipsCallStack {
 	};
 };
 
+struct HLEProfileCounters {
+	// Only the emu thread writes these, atomics just so they can be read safely from others.
+	std::atomic<u64> calls;
+	std::atomic<u64> hostNanos;
+	std::atomic<u64> cycles;
+	std::atomic<u64> delayCycles;
+};
+
+// Indexed the same as moduleDB, then by function.
+static std::vector<std::vector<HLEProfileCounters>> profileCounters;
+// Held while moduleDB and profileCounters grow or shrink, and while other threads read them.
+static std::mutex profileLock;
+static std::atomic<bool> hleProfilingRequested;
+// Resets are done on the emu thread, since it adds to the counters without locking.
+static std::atomic<bool> hleProfileResetRequested;
+static bool hleProfiling = false;
+// The function being profiled, if inside a syscall.
+static HLEProfileCounters *hleCurrentProfile = nullptr;
+
+static inline void AddProfileCount(std::atomic<u64> &counter, u64 value) {
+	// No other writers, so no need for a locked add.
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
 // No need to save state, always flushed at a syscall end.
 static std::vector<HLEMipsCallInfo> enqueuedMipsCalls;
 // Does need to be saved, referenced by the stack and owned.
@@ -119,6 +163,8 @@ void HLEInit() {
 	RegisterAllModules();
 	delayedResultEvent = CoreTiming::RegisterEvent("HLEDelayedResult", hleDelayResultFinish);
 	idleOp = GetSyscallOp("FakeSysCalls", NID_IDLE);
+	// The idle func doesn't need any of the bookkeeping.
+	syscallTable[GetSyscallIndex(MIPSOpcode(idleOp))].call = &CallIdleSyscall;
 }
 
 void HLEDoState(PointerWrap &p) {
@@ -153,7 +199,14 @@ void HLEDoState(PointerWrap &p) {
 void HLEShutdown() {
 	hleAfterSyscall = HLE_AFTER_NOTHING;
 	latestSyscall = nullptr;
-	moduleDB.clear();
+	hleCurrentProfile = nullptr;
+	{
+		std::lock_guard<std::mutex> guard(profileLock);
+		moduleDB.clear();
+		profileCounters.clear();
+	}
+	syscallTable.clear();
+	syscallModuleBase.clear();
 	enqueuedMipsCalls.clear();
 	for (auto p : mipsCallActions) {
 		delete p;
@@ -164,7 +217,20 @@ void HLEShutdown() {
 void RegisterModule(const char *name, int numFunctions, const HLEFunction *funcTable)
 {
 	HLEModule module = {name, numFunctions, funcTable};
+	std::lock_guard<std::mutex> guard(profileLock);
 	moduleDB.push_back(module);
+	syscallModuleBase.push_back((u32)syscallTable.size());
+	for (int i = 0; i < numFunctions; ++i) {
+		const HLEFunction *info = &funcTable[i];
+		if (!info->func)
+			syscallTable.push_back({ &CallUnimplementedSyscall, info });
+		else if (info->flags != 0)
+			syscallTable.push_back({ &CallSyscallWithFlags, info });
+		else
+			syscallTable.push_back({ &CallSyscallWithoutFlags, info });
+	}
+	// Value initialized, so the counters start at zero.
+	profileCounters.push_back(std::vector<HLEProfileCounters>(numFunctions));
 }
 
 int GetModuleIndex(const char *moduleName)
@@ -367,6 +433,8 @@ bool hleExecuteDebugBreak(const HLEFunction &func)
 
 u32 hleDelayResult(u32 result, const char *reason, int usec)
 {
+	if (hleCurrentProfile)
+		AddProfileCount(hleCurrentProfile->delayCycles, usToCycles(usec));
 	if (__KernelIsDispatchEnabled())
 	{
 		CoreTiming::ScheduleEvent(usToCycles(usec), delayedResultEvent, __KernelGetCurThread());
@@ -379,6 +447,8 @@ u32 hleDelayResult(u32 result, const char *reason, int usec)
 
 u64 hleDelayResult(u64 result, const char *reason, int usec)
 {
+	if (hleCurrentProfile)
+		AddProfileCount(hleCurrentProfile->delayCycles, usToCycles(usec));
 	if (__KernelIsDispatchEnabled())
 	{
 		u64 param = (result & 0xFFFFFFFF00000000) | __KernelGetCurThread();
@@ -393,6 +463,8 @@ u64 hleDelayResult(u64 result, const char *reason, int usec)
 void hleEatCycles(int cycles) {
 	// Maybe this should Idle, at least for larger delays?  Could that cause issues?
 	currentMIPS->downcount -= cycles;
+	if (hleCurrentProfile)
+		AddProfileCount(hleCurrentProfile->cycles, cycles);
 }
 
 void hleEatMicro(int usec) {
@@ -620,7 +692,7 @@ static void updateSyscallStats(int modulenum, int funcnum, double total)
 	}
 }
 
-inline void CallSyscallWithFlags(const HLEFunction *info)
+void CallSyscallWithFlags(const HLEFunction *info)
 {
 	latestSyscall = info;
 	const u32 flags = info->flags;
@@ -646,7 +718,7 @@ inline void CallSyscallWithFlags(const HLEFunction *info)
 		SetDeadbeefRegs();
 }
 
-inline void CallSyscallWithoutFlags(const HLEFunction *info)
+void CallSyscallWithoutFlags(const HLEFunction *info)
 {
 	latestSyscall = info;
 	info->func();
@@ -657,41 +729,65 @@ inline void CallSyscallWithoutFlags(const HLEFunction *info)
 		SetDeadbeefRegs();
 }
 
-const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op)
+static void CallIdleSyscall(const HLEFunction *info)
+{
+	info->func();
+}
+
+static void CallUnimplementedSyscall(const HLEFunction *info)
+{
+	RETURN(SCE_KERNEL_ERROR_LIBRARY_NOT_YET_LINKED);
+	ERROR_LOG_REPORT(HLE, "Unimplemented HLE function %s", info->name ? info->name : "(\?\?\?)");
+}
+
+static int GetSyscallIndex(MIPSOpcode op)
 {
 	u32 callno = (op >> 6) & 0xFFFFF; //20 bits
 	int funcnum = callno & 0xFFF;
 	int modulenum = (callno & 0xFF000) >> 12;
 	if (funcnum == 0xfff) {
 		ERROR_LOG(HLE, "Unknown syscall: Module: %s (module: %d func: %d)", modulenum > (int)moduleDB.size() ? "(unknown)" : moduleDB[modulenum].name, modulenum, funcnum);
-		return NULL;
+		return -1;
 	}
 	if (modulenum >= (int)moduleDB.size()) {
 		ERROR_LOG(HLE, "Syscall had bad module number %d - probably executing garbage", modulenum);
-		return NULL;
+		return -1;
 	}
 	if (funcnum >= moduleDB[modulenum].numFunctions) {
 		ERROR_LOG(HLE, "Syscall had bad function number %d in module %d - probably executing garbage", funcnum, modulenum);
-		return NULL;
+		return -1;
 	}
-	return &moduleDB[modulenum].funcTable[funcnum];
+	return (int)syscallModuleBase[modulenum] + funcnum;
 }
 
-void *GetQuickSyscallFunc(MIPSOpcode op) {
-	if (coreCollectDebugStats)
-		return nullptr;
+const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op)
+{
+	int index = GetSyscallIndex(op);
+	return index >= 0 ? syscallTable[index].info : nullptr;
+}
+
+int GetQuickSyscallIndex(MIPSOpcode op) {
+	// Profiling needs CallSyscall, since it knows the module and function number.
+	if (coreCollectDebugStats || hleProfiling)
+		return -1;
+
+	int index = GetSyscallIndex(op);
+	if (index < 0 || !syscallTable[index].info->func)
+		return -1;
+	DEBUG_LOG(HLE, "Compiling syscall to %s", syscallTable[index].info->name);
+	return index;
+}
 
-	const HLEFunction *info = GetSyscallFuncPointer(op);
-	if (!info || !info->func)
+void *GetQuickSyscallFunc(MIPSOpcode op) {
+	int index = GetQuickSyscallIndex(op);
+	if (index < 0)
 		return nullptr;
-	DEBUG_LOG(HLE, "Compiling syscall to %s", info->name);
+	return (void *)syscallTable[index].call;
+}
 
-	// TODO: Do this with a flag?
-	if (op == idleOp)
-		return (void *)info->func;
-	if (info->flags != 0)
-		return (void *)&CallSyscallWithFlags;
-	return (void *)&CallSyscallWithoutFlags;
+void CallQuickSyscall(int index) {
+	const HLESyscallEntry &entry = syscallTable[index];
+	entry.call(entry.info);
 }
 
 static double hleSteppingTime = 0.0;
@@ -704,39 +800,108 @@ void CallSyscall(MIPSOpcode op)
 {
 	PROFILE_THIS_SCOPE("syscall");
 	double start = 0.0;  // need to initialize to fix the race condition where coreCollectDebugStats is enabled in the middle of this func.
-	if (coreCollectDebugStats) {
+	if (coreCollectDebugStats || hleProfiling) {
 		start = time_now_d();
 	}
 
-	const HLEFunction *info = GetSyscallFuncPointer(op);
-	if (!info) {
+	int index = GetSyscallIndex(op);
+	if (index < 0) {
 		RETURN(SCE_KERNEL_ERROR_LIBRARY_NOT_YET_LINKED);
 		return;
 	}
 
-	if (info->func) {
-		if (op == idleOp)
-			info->func();
-		else if (info->flags != 0)
-			CallSyscallWithFlags(info);
-		else
-			CallSyscallWithoutFlags(info);
-	}
-	else {
-		RETURN(SCE_KERNEL_ERROR_LIBRARY_NOT_YET_LINKED);
-		ERROR_LOG_REPORT(HLE, "Unimplemented HLE function %s", info->name ? info->name : "(\?\?\?)");
+	u32 callno = (op >> 6) & 0xFFFFF; //20 bits
+	int funcnum = callno & 0xFFF;
+	int modulenum = (callno & 0xFF000) >> 12;
+	if (hleProfiling && op != idleOp)
+		hleCurrentProfile = &profileCounters[modulenum][funcnum];
+
+	const HLESyscallEntry &entry = syscallTable[index];
+	entry.call(entry.info);
+
+	if (hleCurrentProfile) {
+		double total = time_now_d() - start - hleSteppingTime;
+		AddProfileCount(hleCurrentProfile->calls, 1);
+		AddProfileCount(hleCurrentProfile->hostNanos, (u64)(std::max(total, 0.0) * 1000000000.0));
+		hleCurrentProfile = nullptr;
+		if (!coreCollectDebugStats)
+			hleSteppingTime = 0.0;
 	}
 
 	if (coreCollectDebugStats) {
-		u32 callno = (op >> 6) & 0xFFFFF; //20 bits
-		int funcnum = callno & 0xFFF;
-		int modulenum = (callno & 0xFF000) >> 12;
 		double total = time_now_d() - start - hleSteppingTime;
 		hleSteppingTime = 0.0;
 		updateSyscallStats(modulenum, funcnum, total);
 	}
 }
 
+void hleSetProfiling(bool enabled) {
+	hleProfilingRequested = enabled;
+}
+
+bool hleIsProfiling() {
+	return hleProfilingRequested;
+}
+
+static void ResetProfileCounters() {
+	for (auto &moduleCounters : profileCounters) {
+		for (auto &counters : moduleCounters) {
+			counters.calls = 0;
+			counters.hostNanos = 0;
+			counters.cycles = 0;
+			counters.delayCycles = 0;
+		}
+	}
+}
+
+bool hleUpdateProfiling() {
+	if (hleProfileResetRequested.exchange(false))
+		ResetProfileCounters();
+
+	bool enabled = hleProfilingRequested;
+	if (enabled == hleProfiling)
+		return false;
+	hleProfiling = enabled;
+	// Blocks already compiled may call functions directly, skipping CallSyscall.
+	return true;
+}
+
+void hleResetProfile() {
+	hleProfileResetRequested = true;
+}
+
+std::vector<HLEFunctionProfile> hleGetProfile() {
+	std::vector<HLEFunctionProfile> result;
+	std::lock_guard<std::mutex> guard(profileLock);
+	// Already as good as zero.
+	if (hleProfileResetRequested)
+		return result;
+	for (size_t i = 0; i < profileCounters.size() && i < moduleDB.size(); ++i) {
+		const HLEModule &module = moduleDB[i];
+		for (size_t j = 0; j < profileCounters[i].size(); ++j) {
+			const HLEProfileCounters &counters = profileCounters[i][j];
+			u64 calls = counters.calls.load(std::memory_order_relaxed);
+			if (calls == 0)
+				continue;
+
+			HLEFunctionProfile profile;
+			profile.module = module.name;
+			profile.name = module.funcTable[j].name;
+			profile.nid = module.funcTable[j].ID;
+			profile.calls = calls;
+			profile.hostNanos = counters.hostNanos.load(std::memory_order_relaxed);
+			profile.cycles = counters.cycles.load(std::memory_order_relaxed);
+			profile.delayCycles = counters.delayCycles.load(std::memory_order_relaxed);
+			result.push_back(profile);
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const HLEFunctionProfile &a, const HLEFunctionProfile &b) {
+		return a.hostNanos > b.hostNanos;
+	});
+	return result;
+}
+
 size_t hleFormatLogArgs(char *message, size_t sz, const char *argmask) {
 	char *p = message;
 	size_t used = 0;
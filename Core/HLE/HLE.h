@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <cstdarg>
 #include <type_traits>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
@@ -128,6 +129,30 @@ u64 hleDelayResult(u64 result, const char *reason, int usec);
 void hleEatCycles(int cycles);
 void hleEatMicro(int usec);
 
+// Totals for one HLE function since profiling was last reset.
+struct HLEFunctionProfile {
+	const char *module;
+	const char *name;
+	u32 nid;
+	u64 calls;
+	// Host time spent in the call, not counting time stepping in the debugger.
+	u64 hostNanos;
+	// Emulated cost: cycles eaten with hleEatCycles(), and time waited with hleDelayResult().
+	u64 cycles;
+	u64 delayCycles;
+};
+
+// Per syscall profiling.  When off, it costs nothing, when on, syscalls skip the jit's quick path.
+// Can be requested from any thread, takes effect at the next hleUpdateProfiling().
+void hleSetProfiling(bool enabled);
+bool hleIsProfiling();
+// Called on the emu thread between frames.  Returns true if the jit cache needs clearing.
+bool hleUpdateProfiling();
+// Also takes effect at the next hleUpdateProfiling(), until then hleGetProfile() returns nothing.
+void hleResetProfile();
+// Only functions called at least once, slowest total host time first.
+std::vector<HLEFunctionProfile> hleGetProfile();
+
 inline int hleDelayResult(int result, const char *reason, int usec)
 {
 	return hleDelayResult((u32) result, reason, usec);
@@ -154,6 +179,9 @@ void HLEReturnFromMipsCall();
 const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op);
 // For jit, takes arg: const HLEFunction *
 void *GetQuickSyscallFunc(MIPSOpcode op);
+// Index for CallQuickSyscall, or -1 if CallSyscall must be used instead.
+int GetQuickSyscallIndex(MIPSOpcode op);
+void CallQuickSyscall(int index);
 
 void hleDoLogInternal(LogTypes::LOG_TYPE t, LogTypes::LOG_LEVELS level, u64 res, const char *file, int line, const char *reportTag, char retmask, const char *reason, const char *formatted_reason);
 
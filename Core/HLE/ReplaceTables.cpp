@@ -25,6 +25,7 @@
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/MemMap.h"
+#include "Core/MemMapHelpers.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
 #include "Core/MIPS/MIPSAnalyst.h"
@@ -152,8 +153,10 @@ static int Replace_memcpy() {
 	}
 	RETURN(destPtr);
 
-	CBreakPoints::ExecMemCheck(srcPtr, false, bytes, currentMIPS->pc);
-	CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
+	if (CBreakPoints::AnyMemChecks()) {
+		CBreakPoints::ExecMemCheck(srcPtr, false, bytes, currentMIPS->pc);
+		CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
+	}
 
 	return 10 + bytes / 4;  // approximation
 }
@@ -194,8 +197,10 @@ static int Replace_memcpy_jak() {
 	currentMIPS->r[MIPS_REG_A3] = destPtr + bytes;
 	RETURN(destPtr);
 
-	CBreakPoints::ExecMemCheck(srcPtr, false, bytes, currentMIPS->pc);
-	CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
+	if (CBreakPoints::AnyMemChecks()) {
+		CBreakPoints::ExecMemCheck(srcPtr, false, bytes, currentMIPS->pc);
+		CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
+	}
 
 	return 5 + bytes * 8 + 2;  // approximation. This is a slow memcpy - a byte copy loop..
 }
@@ -204,27 +209,14 @@ static int Replace_memcpy16() {
 	u32 destPtr = PARAM(0);
 	u32 srcPtr = PARAM(1);
 	u32 bytes = PARAM(2) * 16;
-	bool skip = false;
 
 	// Some games use memcpy on executable code.  We need to flush emuhack ops.
-	currentMIPS->InvalidateICache(srcPtr, bytes);
-	if ((skipGPUReplacements & (int)GPUReplacementSkip::MEMCPY) == 0) {
-		if (Memory::IsVRAMAddress(destPtr) || Memory::IsVRAMAddress(srcPtr)) {
-			skip = gpu->PerformMemoryCopy(destPtr, srcPtr, bytes);
-		}
-	}
-	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointer(destPtr);
-		const u8 *src = Memory::GetPointer(srcPtr);
-		if (dst && src) {
-			memmove(dst, src, bytes);
-		}
-	}
+	int flags = Memory::MEMBLOCK_INVALIDATE_SRC;
+	if ((skipGPUReplacements & (int)GPUReplacementSkip::MEMCPY) == 0)
+		flags |= Memory::MEMBLOCK_NOTIFY_GPU;
+	Memory::MemcpyBlock(destPtr, srcPtr, bytes, flags);
 	RETURN(destPtr);
 
-	CBreakPoints::ExecMemCheck(srcPtr, false, bytes, currentMIPS->pc);
-	CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
-
 	return 10 + bytes / 4;  // approximation
 }
 
@@ -270,27 +262,14 @@ static int Replace_memmove() {
 	u32 destPtr = PARAM(0);
 	u32 srcPtr = PARAM(1);
 	u32 bytes = PARAM(2);
-	bool skip = false;
 
 	// Some games use memcpy on executable code.  We need to flush emuhack ops.
-	if ((skipGPUReplacements & (int)GPUReplacementSkip::MEMMOVE) == 0) {
-		currentMIPS->InvalidateICache(srcPtr, bytes);
-		if (Memory::IsVRAMAddress(destPtr) || Memory::IsVRAMAddress(srcPtr)) {
-			skip = gpu->PerformMemoryCopy(destPtr, srcPtr, bytes);
-		}
-	}
-	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointer(destPtr);
-		const u8 *src = Memory::GetPointer(srcPtr);
-		if (dst && src) {
-			memmove(dst, src, bytes);
-		}
-	}
+	int flags = 0;
+	if ((skipGPUReplacements & (int)GPUReplacementSkip::MEMMOVE) == 0)
+		flags |= Memory::MEMBLOCK_INVALIDATE_SRC | Memory::MEMBLOCK_NOTIFY_GPU;
+	Memory::MemcpyBlock(destPtr, srcPtr, bytes, flags);
 	RETURN(destPtr);
 
-	CBreakPoints::ExecMemCheck(srcPtr, false, bytes, currentMIPS->pc);
-	CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
-
 	return 10 + bytes / 4;  // approximation
 }
 
@@ -298,20 +277,12 @@ static int Replace_memset() {
 	u32 destPtr = PARAM(0);
 	u8 value = PARAM(1);
 	u32 bytes = PARAM(2);
-	bool skip = false;
-	if (Memory::IsVRAMAddress(destPtr) && (skipGPUReplacements & (int)GPUReplacementSkip::MEMSET) == 0) {
-		skip = gpu->PerformMemorySet(destPtr, value, bytes);
-	}
-	if (!skip && bytes != 0) {
-		u8 *dst = Memory::GetPointer(destPtr);
-		if (dst) {
-			memset(dst, value, bytes);
-		}
-	}
+	int flags = 0;
+	if ((skipGPUReplacements & (int)GPUReplacementSkip::MEMSET) == 0)
+		flags |= Memory::MEMBLOCK_NOTIFY_GPU;
+	Memory::MemsetBlock(destPtr, value, bytes, flags);
 	RETURN(destPtr);
 
-	CBreakPoints::ExecMemCheck(destPtr, true, bytes, currentMIPS->pc);
-
 	return 10 + bytes / 4;  // approximation
 }
 
@@ -346,14 +317,156 @@ static int Replace_memset_jak() {
 	return 5 + bytes * 6 + 2;  // approximation (hm, inspecting the disasm this should be 5 + 6 * bytes + 2, but this is what works..)
 }
 
+static int Replace_memcmp() {
+	u32 aPtr = PARAM(0);
+	u32 bPtr = PARAM(1);
+	u32 bytes = PARAM(2);
+
+	int result = 0;
+	u32 compared = 0;
+	if (bytes != 0 && Memory::IsValidRange(aPtr, bytes) && Memory::IsValidRange(bPtr, bytes)) {
+		const u8 *a = Memory::GetPointerUnchecked(aPtr);
+		const u8 *b = Memory::GetPointerUnchecked(bPtr);
+		// Games may look at the actual difference, so find the first mismatch rather than using memcmp's sign.
+		while (compared < bytes && a[compared] == b[compared])
+			compared++;
+		if (compared < bytes)
+			result = (int)a[compared] - (int)b[compared];
+	} else if (bytes != 0) {
+		// Partly invalid, go byte by byte up to the first bad address, like the real function would.
+		while (compared < bytes) {
+			bool valid = Memory::IsValidAddress(aPtr + compared) && Memory::IsValidAddress(bPtr + compared);
+			// Read_U8 reports the bad access, if any.
+			u8 a = Memory::Read_U8(aPtr + compared);
+			u8 b = Memory::Read_U8(bPtr + compared);
+			if (a != b) {
+				result = (int)a - (int)b;
+				break;
+			}
+			if (!valid)
+				break;
+			compared++;
+		}
+	}
+	RETURN(result);
+
+	if (CBreakPoints::AnyMemChecks() && bytes != 0) {
+		CBreakPoints::ExecMemCheck(aPtr, false, compared == bytes ? bytes : compared + 1, currentMIPS->pc);
+		CBreakPoints::ExecMemCheck(bPtr, false, compared == bytes ? bytes : compared + 1, currentMIPS->pc);
+	}
+
+	return 10 + compared * 4;  // approximation
+}
+
+static int Replace_memchr() {
+	u32 srcPtr = PARAM(0);
+	u8 value = PARAM(1);
+	u32 bytes = PARAM(2);
+
+	u32 result = 0;
+	u32 searched = 0;
+	if (bytes != 0 && Memory::IsValidRange(srcPtr, bytes)) {
+		const u8 *src = Memory::GetPointerUnchecked(srcPtr);
+		const u8 *found = (const u8 *)memchr(src, value, bytes);
+		searched = found ? (u32)(found - src) + 1 : bytes;
+		if (found)
+			result = srcPtr + searched - 1;
+	} else if (bytes != 0) {
+		while (searched < bytes) {
+			u32 addr = srcPtr + searched++;
+			bool valid = Memory::IsValidAddress(addr);
+			if (Memory::Read_U8(addr) == value && valid) {
+				result = addr;
+				break;
+			}
+			if (!valid)
+				break;
+		}
+	}
+	RETURN(result);
+
+	if (CBreakPoints::AnyMemChecks() && searched != 0)
+		CBreakPoints::ExecMemCheck(srcPtr, false, searched, currentMIPS->pc);
+
+	return 10 + searched * 3;  // approximation
+}
+
+// Like strnlen, but never reads past the end of valid memory.
+static u32 GuestStrLen(u32 ptr, u32 maxLen = 0xFFFFFFFF) {
+	u32 validLen = Memory::IsValidAddress(ptr) ? Memory::ValidSize(ptr, maxLen) : 0;
+	if (validLen == 0)
+		return 0;
+	const char *str = (const char *)Memory::GetPointerUnchecked(ptr);
+	const char *end = (const char *)memchr(str, 0, validLen);
+	return end ? (u32)(end - str) : validLen;
+}
+
 static int Replace_strlen() {
 	u32 srcPtr = PARAM(0);
-	const char *src = (const char *)Memory::GetPointer(srcPtr);
-	u32 len = src ? (u32)strlen(src) : 0UL;
+	u32 len = GuestStrLen(srcPtr);
 	RETURN(len);
 	return 7 + len * 4;  // approximation
 }
 
+static int Replace_strnlen() {
+	u32 srcPtr = PARAM(0);
+	u32 len = GuestStrLen(srcPtr, PARAM(1));
+	RETURN(len);
+	return 7 + len * 4;  // approximation
+}
+
+static int Replace_strchr() {
+	u32 srcPtr = PARAM(0);
+	char value = (char)PARAM(1);
+	u32 len = GuestStrLen(srcPtr);
+	const char *src = (const char *)Memory::GetPointer(srcPtr);
+
+	u32 result = 0;
+	if (src) {
+		// Searching for the terminator finds it, like the real thing.
+		const char *found = value == 0 ? src + len : (const char *)memchr(src, value, len);
+		if (found)
+			result = srcPtr + (u32)(found - src);
+	}
+	RETURN(result);
+	return 10 + len * 4;  // approximation
+}
+
+static int Replace_strrchr() {
+	u32 srcPtr = PARAM(0);
+	char value = (char)PARAM(1);
+	u32 len = GuestStrLen(srcPtr);
+	const char *src = (const char *)Memory::GetPointer(srcPtr);
+
+	u32 result = 0;
+	if (src) {
+		if (value == 0) {
+			result = srcPtr + len;
+		} else {
+			for (u32 i = len; i > 0; --i) {
+				if (src[i - 1] == value) {
+					result = srcPtr + i - 1;
+					break;
+				}
+			}
+		}
+	}
+	RETURN(result);
+	return 10 + len * 4;  // approximation
+}
+
+static int Replace_strcat() {
+	u32 destPtr = PARAM(0);
+	u32 srcPtr = PARAM(1);
+	u32 destLen = GuestStrLen(destPtr);
+	u32 srcLen = GuestStrLen(srcPtr);
+	if (Memory::IsValidRange(destPtr, destLen + srcLen + 1) && Memory::IsValidRange(srcPtr, srcLen + 1)) {
+		memmove(Memory::GetPointerUnchecked(destPtr + destLen), Memory::GetPointerUnchecked(srcPtr), srcLen + 1);
+	}
+	RETURN(destPtr);
+	return 10 + (destLen + srcLen) * 4;  // approximation
+}
+
 static int Replace_strcpy() {
 	u32 destPtr = PARAM(0);
 	char *dst = (char *)Memory::GetPointer(destPtr);
@@ -1270,11 +1383,18 @@ static const ReplacementTableEntry entries[] = {
 	{ "memmove", &Replace_memmove, 0, 0 },
 	{ "memset", &Replace_memset, 0, 0 },
 	{ "memset_jak", &Replace_memset_jak, 0, 0 },
+	{ "memcmp", &Replace_memcmp, 0, REPFLAG_DISABLED },
+	{ "bcmp", &Replace_memcmp, 0, REPFLAG_DISABLED },
+	{ "memchr", &Replace_memchr, 0, REPFLAG_DISABLED },
 	{ "strlen", &Replace_strlen, 0, REPFLAG_DISABLED },
 	{ "strcpy", &Replace_strcpy, 0, REPFLAG_DISABLED },
 	{ "strncpy", &Replace_strncpy, 0, REPFLAG_DISABLED },
 	{ "strcmp", &Replace_strcmp, 0, REPFLAG_DISABLED },
 	{ "strncmp", &Replace_strncmp, 0, REPFLAG_DISABLED },
+	{ "strnlen", &Replace_strnlen, 0, REPFLAG_DISABLED },
+	{ "strchr", &Replace_strchr, 0, REPFLAG_DISABLED },
+	{ "strrchr", &Replace_strrchr, 0, REPFLAG_DISABLED },
+	{ "strcat", &Replace_strcat, 0, REPFLAG_DISABLED },
 	{ "fabsf", &Replace_fabsf, JITFUNC(Replace_fabsf), REPFLAG_ALLOWINLINE | REPFLAG_DISABLED },
 	{ "dl_write_matrix", &Replace_dl_write_matrix, 0, REPFLAG_DISABLED }, // &MIPSComp::Jit::Replace_dl_write_matrix, REPFLAG_DISABLED },
 	{ "dl_write_matrix_2", &Replace_dl_write_matrix, 0, REPFLAG_DISABLED },
@@ -1398,6 +1518,42 @@ const ReplacementTableEntry *GetReplacementFunc(int i) {
 	return &entries[i];
 }
 
+const char *ReplacementMatchToString(ReplacementMatch match) {
+	switch (match) {
+	case ReplacementMatch::NONE: return "none";
+	case ReplacementMatch::NAMED: return "named";
+	case ReplacementMatch::HASHED: return "hashed";
+	case ReplacementMatch::DISABLED: return "disabled";
+	case ReplacementMatch::REPLACED: return "replaced";
+	}
+	return "unknown";
+}
+
+ReplacementMatch MatchReplacement(u64 hash, int funcSize, const std::string &symbolName, std::string *hashName) {
+	const char *knownName = MIPSAnalyst::LookupHash(hash, funcSize);
+	if (hashName)
+		*hashName = knownName ? knownName : "";
+
+	// Disabled entries aren't in replacementNameLookup, and this isn't used at runtime, so just search.
+	const std::string name = knownName ? knownName : symbolName;
+	bool anyEnabled = false;
+	bool anyDisabled = false;
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		if (!entries[i].name || name != entries[i].name)
+			continue;
+		if (entries[i].flags & REPFLAG_DISABLED)
+			anyDisabled = true;
+		else
+			anyEnabled = true;
+	}
+
+	if (!knownName)
+		return anyEnabled || anyDisabled ? ReplacementMatch::NAMED : ReplacementMatch::NONE;
+	if (anyEnabled)
+		return ReplacementMatch::REPLACED;
+	return anyDisabled ? ReplacementMatch::DISABLED : ReplacementMatch::HASHED;
+}
+
 static bool WriteReplaceInstruction(u32 address, int index) {
 	u32 prevInstr = Memory::Read_Instruction(address, false).encoding;
 	if (MIPS_IS_REPLACEMENT(prevInstr)) {
@@ -34,6 +34,8 @@
 #pragma once
 
 #include <map>
+#include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
@@ -72,6 +74,23 @@ void RestoreReplacedInstructions(u32 startAddr, u32 endAddr);
 bool GetReplacedOpAt(u32 address, u32 *op);
 bool CanReplaceJalTo(u32 dest, const ReplacementTableEntry **entry, u32 *funcSize);
 
+// How a function relates to the replacement table, for tools looking for new candidates.
+enum class ReplacementMatch {
+	// Nothing known about it.
+	NONE,
+	// Not in the hash database, but its symbol is named like a replacement.  Probably a new variant.
+	NAMED,
+	// In the hash database, but there's no replacement for it.
+	HASHED,
+	// Has a replacement, but it's disabled.
+	DISABLED,
+	REPLACED,
+};
+
+const char *ReplacementMatchToString(ReplacementMatch match);
+// Fills hashName with the name from the hash database, if any.
+ReplacementMatch MatchReplacement(u64 hash, int funcSize, const std::string &symbolName, std::string *hashName);
+
 // For savestates.  If you call SaveAndClearReplacements(), you must call RestoreSavedReplacements().
 std::map<u32, u32> SaveAndClearReplacements();
 void RestoreSavedReplacements(const std::map<u32, u32> &saved);
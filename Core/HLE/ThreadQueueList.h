@@ -17,8 +17,10 @@
 
 #pragma once
 
+#include "Common/BitSet.h"
 #include "Core/HLE/sceKernel.h"
 #include "Common/Serialize/Serializer.h"
+#include "Common/Serialize/SerializeFuncs.h"
 
 struct ThreadQueueList {
 	// Number of queues (number of priority levels starting at 0.)
@@ -51,6 +53,7 @@ struct ThreadQueueList {
 
 	ThreadQueueList() {
 		memset(queues, 0, sizeof(queues));
+		memset(nonEmpty, 0, sizeof(nonEmpty));
 		first = invalid();
 	}
 
@@ -75,37 +78,27 @@ struct ThreadQueueList {
 	}
 
 	inline SceUID pop_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
+		int priority = first_priority();
+		if (priority >= 0)
+			return pop(priority);
 
 		_dbg_assert_msg_(false, "ThreadQueueList should not be empty.");
 		return 0;
 	}
 
 	inline SceUID pop_first_better(u32 priority) {
-		Queue *cur = first;
 		// Don't bother looking past (worse than) this priority.
-		Queue *stop = &queues[priority];
-		while (cur < stop) {
-			if (cur->size() > 0)
-				return cur->data[cur->first++];
-			cur = cur->next;
-		}
+		int best = first_priority();
+		if (best >= 0 && best < (int)priority)
+			return pop(best);
 
 		return 0;
 	}
 
 	inline SceUID peek_first() {
-		Queue *cur = first;
-		while (cur != invalid()) {
-			if (cur->size() > 0)
-				return cur->data[cur->first];
-			cur = cur->next;
-		}
+		int priority = first_priority();
+		if (priority >= 0)
+			return queues[priority].data[queues[priority].first];
 
 		return 0;
 	}
@@ -113,6 +106,7 @@ struct ThreadQueueList {
 	inline void push_front(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
 		cur->data[--cur->first] = threadID;
+		nonEmpty[priority >> 5] |= 1U << (priority & 31);
 		// If we ran out of room toward the front, add more room for next time.
 		if (cur->first == 0)
 			rebalance(priority);
@@ -121,6 +115,7 @@ struct ThreadQueueList {
 	inline void push_back(u32 priority, const SceUID threadID) {
 		Queue *cur = &queues[priority];
 		cur->data[cur->end++] = threadID;
+		nonEmpty[priority >> 5] |= 1U << (priority & 31);
 		if (cur->full())
 			rebalance(priority);
 	}
@@ -139,6 +134,8 @@ struct ThreadQueueList {
 
 				// Now we're one shorter.
 				--cur->end;
+				if (cur->empty())
+					nonEmpty[priority >> 5] &= ~(1U << (priority & 31));
 				return;
 			}
 		}
@@ -164,6 +161,7 @@ struct ThreadQueueList {
 				free(queues[i].data);
 		}
 		memset(queues, 0, sizeof(queues));
+		memset(nonEmpty, 0, sizeof(nonEmpty));
 		first = invalid();
 	}
 
@@ -210,8 +208,10 @@ struct ThreadQueueList {
 				cur->end = cur->first + size;
 			}
 
-			if (size != 0)
+			if (size != 0) {
 				DoArray(p, &cur->data[cur->first], size);
+				nonEmpty[i >> 5] |= 1U << (i & 31);
+			}
 		}
 	}
 
@@ -220,6 +220,23 @@ private:
 		return (Queue *)-1;
 	}
 
+	// Best (lowest) priority with any threads queued, or -1 if all are empty.
+	inline int first_priority() const {
+		for (int i = 0; i < NUM_QUEUES / 32; ++i) {
+			if (nonEmpty[i] != 0)
+				return i * 32 + LeastSignificantSetBit(nonEmpty[i]);
+		}
+		return -1;
+	}
+
+	inline SceUID pop(int priority) {
+		Queue *cur = &queues[priority];
+		SceUID threadID = cur->data[cur->first++];
+		if (cur->empty())
+			nonEmpty[priority >> 5] &= ~(1U << (priority & 31));
+		return threadID;
+	}
+
 	// Initialize a priority level and link to other queues.
 	void link(u32 priority, int size) {
 		_dbg_assert_msg_(queues[priority].data == nullptr, "ThreadQueueList::Queue should only be initialized once.");
@@ -286,4 +303,6 @@ private:
 	Queue *first;
 	// The priority level queues of thread ids.
 	Queue queues[NUM_QUEUES];
+	// A bit per priority level that has threads queued, so finding the best one doesn't walk the queues.
+	u32 nonEmpty[NUM_QUEUES / 32];
 };
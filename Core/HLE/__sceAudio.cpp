@@ -15,18 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
-#include <atomic>
-#include <mutex>
+#include <cstring>
 
 #include "Common/CommonTypes.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Data/Collections/FixedSizeQueue.h"
 
-#ifdef _M_SSE
-#include <emmintrin.h>
-#endif
-
 #include "Core/Config.h"
 #include "Core/CoreTiming.h"
 #include "Core/Host.h"
@@ -48,14 +43,15 @@
 
 StereoResampler resampler;
 
-// Should be used to lock anything related to the outAudioQueue.
-// atomic locks are used on the lock. TODO: make this lock-free
-std::atomic_flag atomicLock_;
-
-// We copy samples as they are written into this simple ring buffer.
-// Might try something more efficient later.
+// We copy samples as they are written into this simple ring buffer, applying the volume.
+// No locking needed: both enqueue (from HLE calls) and __AudioUpdate (a CoreTiming event) run on
+// the emu thread.  The only thread boundary is the resampler, which is lock-free.
 FixedSizeQueue<s16_le, 32768 * 8> chanSampleQueues[PSP_AUDIO_CHANNEL_MAX + 1];
 
+// Only for the debug stats, not saved.
+static int chanUnderrunCount[PSP_AUDIO_CHANNEL_MAX + 1];
+static int chanOverrunCount[PSP_AUDIO_CHANNEL_MAX + 1];
+
 int eventAudioUpdate = -1;
 int eventHostAudioUpdate = -1;
 int mixFrequency = 44100;
@@ -104,6 +100,8 @@ static void __AudioCPUMHzChange() {
 
 void __AudioInit() {
 	resampler.ResetStatCounters();
+	memset(chanUnderrunCount, 0, sizeof(chanUnderrunCount));
+	memset(chanOverrunCount, 0, sizeof(chanOverrunCount));
 	mixFrequency = 44100;
 	srcFrequency = 0;
 
@@ -234,6 +232,15 @@ u32 __AudioEnqueue(AudioChannel &chan, int chanNum, bool blocking) {
 		return ret;
 	}
 
+	// Either format is expanded to stereo in the queue.
+	const u32 totalSamples = chan.sampleCount * 2;
+	if (totalSamples > (u32)chanSampleQueues[chanNum].room()) {
+		// Would wrap over samples not yet mixed.  Can't really happen with blocking, since we only overshoot by one call.
+		chanOverrunCount[chanNum]++;
+		ERROR_LOG(SCEAUDIO, "Channel %i buffer overrun, dropping %i samples", chanNum, chan.sampleCount);
+		return ret;
+	}
+
 	int leftVol = chan.leftVolume;
 	int rightVol = chan.rightVolume;
 
@@ -242,7 +249,6 @@ u32 __AudioEnqueue(AudioChannel &chan, int chanNum, bool blocking) {
 
 		// Good news: the volume doesn't affect the values at all.
 		// We can just do a direct memory copy.
-		const u32 totalSamples = chan.sampleCount * (chan.format == PSP_AUDIO_FORMAT_STEREO ? 2 : 1);
 		s16_le *buf1 = 0, *buf2 = 0;
 		size_t sz1, sz2;
 		chanSampleQueues[chanNum].pushPointers(totalSamples, &buf1, &sz1, &buf2, &sz2);
@@ -259,8 +265,6 @@ u32 __AudioEnqueue(AudioChannel &chan, int chanNum, bool blocking) {
 		rightVol <<=1;
 
 		if (chan.format == PSP_AUDIO_FORMAT_STEREO) {
-			const u32 totalSamples = chan.sampleCount * 2;
-
 			s16_le *sampleData = (s16_le *) Memory::GetPointer(chan.sampleAddress);
 
 			// Walking a pointer for speed.  But let's make sure we wouldn't trip on an invalid ptr.
@@ -352,6 +356,7 @@ void __AudioUpdate(bool resetRecording) {
 		bool needsResample = i == PSP_AUDIO_CHANNEL_SRC && srcFrequency != 0 && srcFrequency != mixFrequency;
 		size_t sz = needsResample ? (hwBlockSize * 2 * srcFrequency) / mixFrequency : hwBlockSize * 2;
 		if (sz > chanSampleQueues[i].size()) {
+			chanUnderrunCount[i]++;
 			ERROR_LOG(SCEAUDIO, "Channel %i buffer underrun at %i of %i", i, (int)chanSampleQueues[i].size() / 2, (int)sz / 2);
 		}
 
@@ -399,22 +404,14 @@ void __AudioUpdate(bool resetRecording) {
 		}
 
 		if (firstChannel) {
-			for (size_t s = 0; s < sz1; s++)
-				mixBuffer[s] = buf1[s];
-			if (buf2) {
-				for (size_t s = 0; s < sz2; s++)
-					mixBuffer[s + sz1] = buf2[s];
-			}
+			ConvertS16ToS32(mixBuffer, buf1, sz1);
+			if (buf2)
+				ConvertS16ToS32(mixBuffer + sz1, buf2, sz2);
 			firstChannel = false;
 		} else {
-			// Surprisingly hard to SIMD efficiently on SSE2 due to lack of 16-to-32-bit sign extension. NEON should be straight-forward though, and SSE4.1 can do it nicely.
-			// Actually, the cmple/pack trick should work fine...
-			for (size_t s = 0; s < sz1; s++)
-				mixBuffer[s] += buf1[s];
-			if (buf2) {
-				for (size_t s = 0; s < sz2; s++)
-					mixBuffer[s + sz1] += buf2[s];
-			}
+			MixS16ToS32(mixBuffer, buf1, sz1);
+			if (buf2)
+				MixS16ToS32(mixBuffer + sz1, buf2, sz2);
 		}
 	}
 
@@ -450,9 +447,7 @@ void __AudioUpdate(bool resetRecording) {
 			}
 		} else {
 			if (g_Config.bDumpAudio) {
-				for (int i = 0; i < hwBlockSize * 2; i++) {
-					clampedMixBuffer[i] = clamp_s16(mixBuffer[i]);
-				}
+				ClampBufferToS16(clampedMixBuffer, mixBuffer, hwBlockSize * 2, 0);
 				g_wave_writer.AddStereoSamples(clampedMixBuffer, hwBlockSize);
 			} else {
 				__StopLogAudio();
@@ -470,6 +465,14 @@ int __AudioMix(short *outstereo, int numFrames, int sampleRate) {
 
 void __AudioGetDebugStats(char *buf, size_t bufSize) {
 	resampler.GetAudioDebugStats(buf, bufSize);
+
+	size_t len = strlen(buf);
+	for (u32 i = 0; i < PSP_AUDIO_CHANNEL_MAX + 1 && len < bufSize; i++) {
+		if (chanUnderrunCount[i] != 0 || chanOverrunCount[i] != 0) {
+			snprintf(buf + len, bufSize - len, "Channel %d: %d underruns, %d overruns\n", i, chanUnderrunCount[i], chanOverrunCount[i]);
+			len += strlen(buf + len);
+		}
+	}
 }
 
 void __PushExternalAudio(const s32 *audio, int numSamples) {
@@ -16,6 +16,9 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
@@ -35,6 +38,8 @@
 #include "Core/HLE/sceKernelMemory.h"
 #include "Core/HLE/sceAtrac.h"
 
+#include "ext/xxhash.h"
+
 // Notes about sceAtrac buffer management
 //
 // sceAtrac decodes from a buffer the game fills, where this buffer is one of:
@@ -151,6 +156,77 @@ struct InputBuffer {
 	u32 fileoffset;
 };
 
+// Decoded PCM of fully loaded tracks, shared between contexts. Background music tends to loop
+// forever, so after the first time through, we can just copy the samples.
+struct AtracCachedFrame {
+	// Hash of the packet the samples came from and the ones before it that feed the decoder's
+	// overlap, in case the game changed the data under us.
+	u32 packetHash;
+	u32 numSamples;
+	std::vector<s16> pcm;
+};
+
+struct AtracCachedStream {
+	std::unordered_map<int, AtracCachedFrame> frames;
+	// Position in atracDecodeCacheLRU.
+	std::list<u64>::iterator lruPos;
+	size_t bytes = 0;
+};
+
+static std::unordered_map<u64, AtracCachedStream> atracDecodeCache;
+// Stream hashes, least recently used first.
+static std::list<u64> atracDecodeCacheLRU;
+static size_t atracDecodeCacheBytes = 0;
+
+static void AtracDecodeCacheClear() {
+	atracDecodeCache.clear();
+	atracDecodeCacheLRU.clear();
+	atracDecodeCacheBytes = 0;
+}
+
+static const AtracCachedFrame *AtracDecodeCacheLookup(u64 streamHash, int sample, u32 packetHash) {
+	auto stream = atracDecodeCache.find(streamHash);
+	if (stream == atracDecodeCache.end())
+		return nullptr;
+	atracDecodeCacheLRU.splice(atracDecodeCacheLRU.end(), atracDecodeCacheLRU, stream->second.lruPos);
+	auto frame = stream->second.frames.find(sample);
+	if (frame == stream->second.frames.end() || frame->second.packetHash != packetHash)
+		return nullptr;
+	return &frame->second;
+}
+
+static void AtracDecodeCacheInsert(u64 streamHash, int sample, u32 packetHash, const s16 *pcm, u32 numSamples, int channels) {
+	const size_t maxBytes = (size_t)g_Config.iAtracDecodeCacheMB * 1024 * 1024;
+	const size_t bytes = numSamples * channels * sizeof(s16);
+	// Make room by dropping whole tracks that haven't played recently. If the current track
+	// alone doesn't fit, we just cache as much of it as we can.
+	while (atracDecodeCacheBytes + bytes > maxBytes) {
+		// A lookup always comes first, so the current track is the most recently used.
+		if (atracDecodeCacheLRU.empty() || atracDecodeCacheLRU.front() == streamHash)
+			return;
+		auto oldest = atracDecodeCache.find(atracDecodeCacheLRU.front());
+		atracDecodeCacheBytes -= oldest->second.bytes;
+		atracDecodeCache.erase(oldest);
+		atracDecodeCacheLRU.pop_front();
+	}
+
+	auto inserted = atracDecodeCache.emplace(streamHash, AtracCachedStream());
+	AtracCachedStream &stream = inserted.first->second;
+	if (inserted.second) {
+		stream.lruPos = atracDecodeCacheLRU.insert(atracDecodeCacheLRU.end(), streamHash);
+	} else {
+		atracDecodeCacheLRU.splice(atracDecodeCacheLRU.end(), atracDecodeCacheLRU, stream.lruPos);
+	}
+	AtracCachedFrame &frame = stream.frames[sample];
+	stream.bytes -= frame.pcm.size() * sizeof(s16);
+	atracDecodeCacheBytes -= frame.pcm.size() * sizeof(s16);
+	frame.packetHash = packetHash;
+	frame.numSamples = numSamples;
+	frame.pcm.assign(pcm, pcm + numSamples * channels);
+	stream.bytes += bytes;
+	atracDecodeCacheBytes += bytes;
+}
+
 struct Atrac;
 int __AtracSetContext(Atrac *atrac);
 void _AtracGenerateContext(Atrac *atrac, SceAtracId *context);
@@ -204,6 +280,8 @@ struct Atrac {
 		dataBuf_ = 0;
 		ignoreDataBuf_ = false;
 		bufferState_ = ATRAC_STATUS_NO_DATA;
+		decodeCacheHash_ = 0;
+		decoderStale_ = false;
 
 		if (context_.IsValid())
 			kernelMemory.Free(context_.ptr);
@@ -233,7 +311,7 @@ struct Atrac {
 	}
 
 	void DoState(PointerWrap &p) {
-		auto s = p.Section("Atrac", 1, 9);
+		auto s = p.Section("Atrac", 1, 10);
 		if (!s)
 			return;
 
@@ -336,6 +414,12 @@ struct Atrac {
 			bool oldResetBuffer = false;
 			Do(p, oldResetBuffer);
 		}
+
+		if (s >= 10) {
+			Do(p, decoderStale_);
+		} else {
+			decoderStale_ = false;
+		}
 	}
 
 	int Analyze(u32 addr, u32 size);
@@ -426,6 +510,11 @@ struct Atrac {
 	// Indicates that the dataBuf_ array should not be used.
 	bool ignoreDataBuf_;
 
+	// Identifies the track in the decode cache, or 0 if it can't use it.
+	u64 decodeCacheHash_ = 0;
+	// Frames were served from the cache, so the decoder needs to be primed again before use.
+	bool decoderStale_ = false;
+
 	u32 codecType_;
 	AtracStatus bufferState_;
 
@@ -483,7 +572,7 @@ struct Atrac {
 		return ignoreDataBuf_ ? Memory::GetPointer(first_.addr) : dataBuf_;
 	}
 
-	void SeekToSample(int sample) {
+	void SeekToSample(int sample, bool force = false) {
 #ifdef USE_FFMPEG
 		// Discard any pending packet data.
 		packet_->size = 0;
@@ -493,7 +582,7 @@ struct Atrac {
 		const u32 unalignedSamples = (offsetSamples + sample) % SamplesPerFrame();
 		int seekFrame = sample + offsetSamples - unalignedSamples;
 
-		if ((sample != currentSample_ || sample == 0) && codecCtx_ != nullptr) {
+		if ((force || sample != currentSample_ || sample == 0) && codecCtx_ != nullptr) {
 			// Prefill the decode buffer with packets before the first sample offset.
 			avcodec_flush_buffers(codecCtx_);
 
@@ -581,6 +670,31 @@ struct Atrac {
 
 	void CalculateStreamInfo(u32 *readOffset);
 
+	// Only tracks entirely in memory are cached, streamed data changes all the time.
+	void UpdateDecodeCacheHash() {
+		bool usable = g_Config.iAtracDecodeCacheMB > 0 && bufferState_ == ATRAC_STATUS_ALL_DATA_LOADED;
+		usable = usable && (codecType_ == PSP_MODE_AT_3 || codecType_ == PSP_MODE_AT_3_PLUS);
+		usable = usable && (!ignoreDataBuf_ || Memory::IsValidRange(first_.addr, first_.filesize));
+		if (!usable) {
+			decodeCacheHash_ = 0;
+		} else if (decodeCacheHash_ == 0) {
+			// The output also depends on the channel count and where the track ends.
+			u64 seed = ((u64)outputChannels_ << 32) | (u32)endSample_;
+			decodeCacheHash_ = XXH3_64bits_withSeed(BufferStart(), first_.filesize, seed) | 1;
+		}
+	}
+
+	// Covers the packet at off and the ones SeekToSample() primes the decoder with, since the
+	// decoded samples depend on those too.
+	u32 PacketHash(u32 off) {
+		if (off >= first_.size)
+			return 0;
+		const u32 backfill = bytesPerFrame_ * 2;
+		const u32 start = off - dataOff_ < backfill ? dataOff_ : off - backfill;
+		const u32 end = std::min(off + (u32)bytesPerFrame_, first_.size);
+		return (u32)XXH3_64bits(BufferStart() + start, end - start);
+	}
+
 	u32 StreamBufferEnd() const {
 		// The buffer is always aligned to a frame in size, not counting an optional header.
 		// The header will only initially exist after the data is first set.
@@ -665,6 +779,7 @@ void __AtracShutdown() {
 		delete atracIDs[i];
 		atracIDs[i] = NULL;
 	}
+	AtracDecodeCacheClear();
 }
 
 static Atrac *getAtrac(int atracID) {
@@ -1180,73 +1295,98 @@ u32 _AtracDecodeData(int atracID, u8 *outbuf, u32 outbufPtr, u32 *SamplesNum, u3
 			}
 
 			if (!atrac->failedDecode_ && (atrac->codecType_ == PSP_MODE_AT_3 || atrac->codecType_ == PSP_MODE_AT_3_PLUS)) {
-				atrac->SeekToSample(atrac->currentSample_);
-
-				AtracDecodeResult res = ATDECODE_FEEDME;
-				while (atrac->FillPacket(-skipSamples)) {
-					res = atrac->DecodePacket();
-					if (res == ATDECODE_FAILED) {
-						*SamplesNum = 0;
-						*finish = 1;
-						return ATRAC_ERROR_ALL_DATA_DECODED;
+				atrac->UpdateDecodeCacheHash();
+				u32 packetHash = 0;
+				const AtracCachedFrame *cached = nullptr;
+				if (atrac->decodeCacheHash_ != 0) {
+					packetHash = atrac->PacketHash(atrac->FileOffsetBySample(atrac->currentSample_ - skipSamples));
+					cached = AtracDecodeCacheLookup(atrac->decodeCacheHash_, atrac->currentSample_, packetHash);
+				}
+
+				if (cached) {
+					numSamples = cached->numSamples;
+					if (outbuf != nullptr) {
+						u32 outBytes = (u32)(cached->pcm.size() * sizeof(s16));
+						memcpy(outbuf, &cached->pcm[0], outBytes);
+						if (outbufPtr != 0) {
+							CBreakPoints::ExecMemCheck(outbufPtr, true, outBytes, currentMIPS->pc);
+						}
 					}
+					// The decoder didn't see this frame, so it'll need to catch up if we miss later.
+					atrac->decoderStale_ = true;
+				} else {
+					atrac->SeekToSample(atrac->currentSample_, atrac->decoderStale_);
+					atrac->decoderStale_ = false;
+
+					AtracDecodeResult res = ATDECODE_FEEDME;
+					while (atrac->FillPacket(-skipSamples)) {
+						res = atrac->DecodePacket();
+						if (res == ATDECODE_FAILED) {
+							*SamplesNum = 0;
+							*finish = 1;
+							return ATRAC_ERROR_ALL_DATA_DECODED;
+						}
 
-					if (res == ATDECODE_GOTFRAME) {
+						if (res == ATDECODE_GOTFRAME) {
 #ifdef USE_FFMPEG
-						// got a frame
-						int skipped = std::min(skipSamples, atrac->frame_->nb_samples);
-						skipSamples -= skipped;
-						numSamples = atrac->frame_->nb_samples - skipped;
+							// got a frame
+							int skipped = std::min(skipSamples, atrac->frame_->nb_samples);
+							skipSamples -= skipped;
+							numSamples = atrac->frame_->nb_samples - skipped;
 
-						// If we're at the end, clamp to samples we want.  It always returns a full chunk.
-						numSamples = std::min(maxSamples, numSamples);
-
-						if (skipped > 0 && numSamples == 0) {
-							// Wait for the next one.
-							res = ATDECODE_FEEDME;
-						}
+							// If we're at the end, clamp to samples we want.  It always returns a full chunk.
+							numSamples = std::min(maxSamples, numSamples);
 
-						if (outbuf != NULL && numSamples != 0) {
-							int inbufOffset = 0;
-							if (skipped != 0) {
-								AVSampleFormat fmt = (AVSampleFormat)atrac->frame_->format;
-								// We want the offset per channel.
-								inbufOffset = av_samples_get_buffer_size(NULL, 1, skipped, fmt, 1);
+							if (skipped > 0 && numSamples == 0) {
+								// Wait for the next one.
+								res = ATDECODE_FEEDME;
 							}
 
-							u8 *out = outbuf;
-							const u8 *inbuf[2] = {
-								atrac->frame_->extended_data[0] + inbufOffset,
-								atrac->frame_->extended_data[1] + inbufOffset,
-							};
-							int avret = swr_convert(atrac->swrCtx_, &out, numSamples, inbuf, numSamples);
-							if (outbufPtr != 0) {
-								u32 outBytes = numSamples * atrac->outputChannels_ * sizeof(s16);
-								CBreakPoints::ExecMemCheck(outbufPtr, true, outBytes, currentMIPS->pc);
-							}
-							if (avret < 0) {
-								ERROR_LOG(ME, "swr_convert: Error while converting %d", avret);
-							} else {
-								ToLEndian((s16*)out, avret * atrac->outputChannels_);
+							if (outbuf != NULL && numSamples != 0) {
+								int inbufOffset = 0;
+								if (skipped != 0) {
+									AVSampleFormat fmt = (AVSampleFormat)atrac->frame_->format;
+									// We want the offset per channel.
+									inbufOffset = av_samples_get_buffer_size(NULL, 1, skipped, fmt, 1);
+								}
+
+								u8 *out = outbuf;
+								const u8 *inbuf[2] = {
+									atrac->frame_->extended_data[0] + inbufOffset,
+									atrac->frame_->extended_data[1] + inbufOffset,
+								};
+								int avret = swr_convert(atrac->swrCtx_, &out, numSamples, inbuf, numSamples);
+								if (outbufPtr != 0) {
+									u32 outBytes = numSamples * atrac->outputChannels_ * sizeof(s16);
+									CBreakPoints::ExecMemCheck(outbufPtr, true, outBytes, currentMIPS->pc);
+								}
+								if (avret < 0) {
+									ERROR_LOG(ME, "swr_convert: Error while converting %d", avret);
+								} else {
+									ToLEndian((s16*)out, avret * atrac->outputChannels_);
+									if (atrac->decodeCacheHash_ != 0 && (u32)avret == numSamples) {
+										AtracDecodeCacheInsert(atrac->decodeCacheHash_, atrac->currentSample_, packetHash, (const s16 *)out, numSamples, atrac->outputChannels_);
+									}
+								}
 							}
-						}
 #endif // USE_FFMPEG
+						}
+						if (res == ATDECODE_GOTFRAME || res == ATDECODE_BADFRAME) {
+							// We only want one frame per call, let's continue the next time.
+							break;
+						}
 					}
-					if (res == ATDECODE_GOTFRAME || res == ATDECODE_BADFRAME) {
-						// We only want one frame per call, let's continue the next time.
-						break;
-					}
-				}
 
-				if (res != ATDECODE_GOTFRAME && atrac->currentSample_ < atrac->endSample_) {
-					// Never got a frame.  We may have dropped a GHA frame or otherwise have a bug.
-					// For now, let's try to provide an extra "frame" if possible so games don't infinite loop.
-					if (atrac->FileOffsetBySample(atrac->currentSample_) < atrac->first_.filesize) {
-						numSamples = std::min(maxSamples, atrac->SamplesPerFrame());
-						u32 outBytes = numSamples * atrac->outputChannels_ * sizeof(s16);
-						if (outbuf != nullptr) {
-							memset(outbuf, 0, outBytes);
-							CBreakPoints::ExecMemCheck(outbufPtr, true, outBytes, currentMIPS->pc);
+					if (res != ATDECODE_GOTFRAME && atrac->currentSample_ < atrac->endSample_) {
+						// Never got a frame.  We may have dropped a GHA frame or otherwise have a bug.
+						// For now, let's try to provide an extra "frame" if possible so games don't infinite loop.
+						if (atrac->FileOffsetBySample(atrac->currentSample_) < atrac->first_.filesize) {
+							numSamples = std::min(maxSamples, atrac->SamplesPerFrame());
+							u32 outBytes = numSamples * atrac->outputChannels_ * sizeof(s16);
+							if (outbuf != nullptr) {
+								memset(outbuf, 0, outBytes);
+								CBreakPoints::ExecMemCheck(outbufPtr, true, outBytes, currentMIPS->pc);
+							}
 						}
 					}
 				}
@@ -1264,7 +1404,14 @@ u32 _AtracDecodeData(int atracID, u8 *outbuf, u32 outbufPtr, u32 *SamplesNum, u3
 			bool hitEnd = atrac->currentSample_ >= atrac->endSample_ || (numSamples == 0 && atrac->first_.size >= atrac->first_.filesize);
 			int loopEndAdjusted = atrac->loopEndSample_ - atrac->FirstOffsetExtra() - atrac->firstSampleOffset_;
 			if ((hitEnd || atrac->currentSample_ > loopEndAdjusted) && loopNum != 0) {
-				atrac->SeekToSample(atrac->loopStartSample_ - atrac->FirstOffsetExtra() - atrac->firstSampleOffset_);
+				int loopStart = atrac->loopStartSample_ - atrac->FirstOffsetExtra() - atrac->firstSampleOffset_;
+				if (atrac->decodeCacheHash_ != 0) {
+					// The loop will likely come from the cache, so only prime the decoder if it's needed.
+					atrac->currentSample_ = loopStart;
+					atrac->decoderStale_ = true;
+				} else {
+					atrac->SeekToSample(loopStart);
+				}
 				if (atrac->bufferState_ != ATRAC_STATUS_FOR_SCESAS) {
 					if (atrac->loopNum_ > 0)
 						atrac->loopNum_--;
@@ -97,6 +97,8 @@ static int vCount;
 static u32 hCountBase;
 static int isVblank;
 static int numSkippedFrames;
+// Frames since the last one drawn to the display with CoreParameter::drawEveryNthFrame.
+static int numPacedFrames;
 static bool hasSetMode;
 static int resumeMode;
 static int holdMode;
@@ -203,6 +205,7 @@ void __DisplayInit() {
 	width = 480;
 	height = 272;
 	numSkippedFrames = 0;
+	numPacedFrames = 0;
 	numVBlanks = 0;
 	numVBlanksSinceFlip = 0;
 	flippedThisFrame = false;
@@ -824,6 +827,27 @@ void __DisplayFlip(int cyclesLate) {
 		if (numSkippedFrames >= maxFrameskip || GPURecord::IsActivePending()) {
 			skipFrame = false;
 		}
+		// Fixed cadence, used for fast test runs.  Only draws to the displayed framebuffers are
+		// skipped, so offscreen and render-to-texture targets the game reads back stay correct.
+		int drawInterval = PSP_CoreParameter().drawEveryNthFrame;
+		if (drawInterval > 1 && !GPURecord::IsActivePending()) {
+			skipFrame = false;
+			u32 displayed = framebuf.topaddr;
+			if (displayed != gstate_c.pacedDisplayFramebufs[0]) {
+				gstate_c.pacedDisplayFramebufs[1] = gstate_c.pacedDisplayFramebufs[0];
+				gstate_c.pacedDisplayFramebufs[0] = displayed;
+			}
+			if (numPacedFrames + 1 < drawInterval) {
+				gstate_c.skipDrawReason |= SKIPDRAW_PACED_DISPLAY_FB;
+				numPacedFrames++;
+			} else {
+				gstate_c.skipDrawReason &= ~SKIPDRAW_PACED_DISPLAY_FB;
+				numPacedFrames = 0;
+			}
+		} else {
+			gstate_c.skipDrawReason &= ~SKIPDRAW_PACED_DISPLAY_FB;
+			numPacedFrames = 0;
+		}
 
 		if (skipFrame) {
 			gstate_c.skipDrawReason |= SKIPDRAW_SKIPFRAME;
@@ -45,14 +45,7 @@ void __DmacDoState(PointerWrap &p) {
 }
 
 static int __DmacMemcpy(u32 dst, u32 src, u32 size) {
-	bool skip = false;
-	if (Memory::IsVRAMAddress(src) || Memory::IsVRAMAddress(dst)) {
-		skip = gpu->PerformMemoryCopy(dst, src, size);
-	}
-	if (!skip) {
-		Memory::Memcpy(dst, Memory::GetPointer(src), size);
-		currentMIPS->InvalidateICache(dst, size);
-	}
+	Memory::MemcpyBlock(dst, src, size, Memory::MEMBLOCK_NOTIFY_GPU | Memory::MEMBLOCK_INVALIDATE_DEST);
 
 	// This number seems strangely reproducible.
 	if (size >= 272) {
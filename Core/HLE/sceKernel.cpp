@@ -473,7 +473,8 @@ void KernelObject::GetQuickInfo(char *ptr, int size)
 }
 
 KernelObjectPool::KernelObjectPool() {
-	memset(occupied, 0, sizeof(bool)*maxCount);
+	memset(pool, 0, sizeof(pool));
+	memset(types, 0, sizeof(types));
 	nextID = initialNextID;
 }
 
@@ -484,8 +485,8 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 		rangeBottom = nextID++;
 
 	for (int i = rangeBottom; i < rangeTop; i++) {
-		if (!occupied[i]) {
-			occupied[i] = true;
+		if (types[i] == 0) {
+			types[i] = obj->GetIDType();
 			pool[i] = obj;
 			pool[i]->uid = i + handleOffset;
 			return i + handleOffset;
@@ -501,23 +502,23 @@ bool KernelObjectPool::IsValid(SceUID handle) const {
 	if (index < 0 || index >= maxCount)
 		return false;
 	else
-		return occupied[index];
+		return types[index] != 0;
 }
 
 void KernelObjectPool::Clear() {
 	for (int i = 0; i < maxCount; i++) {
 		// brutally clear everything, no validation
-		if (occupied[i])
+		if (types[i] != 0)
 			delete pool[i];
 		pool[i] = nullptr;
-		occupied[i] = false;
+		types[i] = 0;
 	}
 	nextID = initialNextID;
 }
 
 void KernelObjectPool::List() {
 	for (int i = 0; i < maxCount; i++) {
-		if (occupied[i]) {
+		if (types[i] != 0) {
 			char buffer[256];
 			if (pool[i]) {
 				pool[i]->GetQuickInfo(buffer, 256);
@@ -532,7 +533,7 @@ void KernelObjectPool::List() {
 int KernelObjectPool::GetCount() const {
 	int count = 0;
 	for (int i = 0; i < maxCount; i++) {
-		if (occupied[i])
+		if (types[i] != 0)
 			count++;
 	}
 	return count;
@@ -558,6 +559,10 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 	}
 
 	Do(p, nextID);
+	// Saved as a bool per slot.
+	bool occupied[maxCount];
+	for (int i = 0; i < maxCount; ++i)
+		occupied[i] = types[i] != 0;
 	DoArray(p, occupied, maxCount);
 	for (int i = 0; i < maxCount; ++i) {
 		if (!occupied[i])
@@ -573,6 +578,7 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 				return;
 
 			pool[i]->uid = i + handleOffset;
+			types[i] = pool[i]->GetIDType();
 		} else {
 			type = pool[i]->GetIDType();
 			Do(p, type);
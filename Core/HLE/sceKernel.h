@@ -428,7 +428,6 @@ public:
 	}
 };
 
-// TODO: Delete the "occupied" array, rely on non-zero pool entries?
 class KernelObjectPool {
 public:
 	KernelObjectPool();
@@ -444,10 +443,9 @@ public:
 	u32 Destroy(SceUID handle) {
 		u32 error;
 		if (Get<T>(handle, error)) {
-			occupied[handle-handleOffset] = false;
 			delete pool[handle-handleOffset];
-			// Why weren't we zeroing before?
 			pool[handle-handleOffset] = nullptr;
+			types[handle-handleOffset] = 0;
 		}
 		return error;
 	};
@@ -456,33 +454,30 @@ public:
 
 	template <class T>
 	T* Get(SceUID handle, u32 &outError) {
-		if (handle < handleOffset || handle >= handleOffset+maxCount || !occupied[handle-handleOffset]) {
+		// Unsigned, so handles below the offset fail the range check too.
+		const u32 index = (u32)handle - handleOffset;
+		if (index < maxCount && types[index] == T::GetStaticIDType()) {
+			outError = SCE_KERNEL_ERROR_OK;
+			return static_cast<T *>(pool[index]);
+		}
+
+		if (index >= maxCount || types[index] == 0) {
 			// Tekken 6 spams 0x80020001 gets wrong with no ill effects, also on the real PSP
 			if (handle != 0 && (u32)handle != 0x80020001) {
 				WARN_LOG(SCEKERNEL, "Kernel: Bad %s handle %d (%08x)", T::GetStaticTypeName(), handle, handle);
 			}
-			outError = T::GetMissingErrorCode();
-			return 0;
 		} else {
-			// Previously we had a dynamic_cast here, but since RTTI was disabled traditionally,
-			// it just acted as a static cast and everything worked. This means that we will never
-			// see the Wrong type object error below, but we'll just have to live with that danger.
-			T* t = static_cast<T*>(pool[handle - handleOffset]);
-			if (t == nullptr || t->GetIDType() != T::GetStaticIDType()) {
-				WARN_LOG(SCEKERNEL, "Kernel: Wrong object type for %d (%08x), was %s, should have been %s", handle, handle, t ? t->GetTypeName() : "null", T::GetStaticTypeName());
-				outError = T::GetMissingErrorCode();
-				return 0;
-			}
-			outError = SCE_KERNEL_ERROR_OK;
-			return t;
+			WARN_LOG(SCEKERNEL, "Kernel: Wrong object type for %d (%08x), was %s, should have been %s", handle, handle, pool[index]->GetTypeName(), T::GetStaticTypeName());
 		}
+		outError = T::GetMissingErrorCode();
+		return 0;
 	}
 
 	// ONLY use this when you KNOW the handle is valid.
 	template <class T>
 	T *GetFast(SceUID handle) {
 		const SceUID realHandle = handle - handleOffset;
-		_dbg_assert_(realHandle >= 0 && realHandle < maxCount && occupied[realHandle]);
+		_dbg_assert_(realHandle >= 0 && realHandle < maxCount && types[realHandle] != 0);
 		return static_cast<T *>(pool[realHandle]);
 	}
 
@@ -490,11 +485,8 @@ public:
 	void Iterate(bool func(T *, ArgT), ArgT arg) {
 		int type = T::GetStaticIDType();
 		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i])
-				continue;
-			T *t = static_cast<T *>(pool[i]);
-			if (t->GetIDType() == type) {
-				if (!func(t, arg))
+			if (types[i] == type) {
+				if (!func(static_cast<T *>(pool[i]), arg))
 					break;
 			}
 		}
@@ -503,10 +495,7 @@ public:
 	int ListIDType(int type, SceUID_le *uids, int count) const {
 		int total = 0;
 		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i]) {
-				continue;
-			}
-			if (pool[i]->GetIDType() == type) {
+			if (types[i] == type) {
 				if (total < count) {
 					*uids++ = pool[i]->GetUID();
 				}
@@ -517,12 +506,11 @@ public:
 	}
 
 	bool GetIDType(SceUID handle, int *type) const {
-		if (handle < handleOffset || handle >= handleOffset+maxCount || !occupied[handle-handleOffset]) {
+		if (handle < handleOffset || handle >= handleOffset+maxCount || types[handle-handleOffset] == 0) {
 			ERROR_LOG(SCEKERNEL, "Kernel: Bad object handle %i (%08x)", handle, handle);
 			return false;
 		}
-		KernelObject *t = pool[handle - handleOffset];
-		*type = t->GetIDType();
+		*type = types[handle - handleOffset];
 		return true;
 	}
 
@@ -537,7 +525,8 @@ private:
 		initialNextID = 0x10
 	};
 	KernelObject *pool[maxCount];
-	bool occupied[maxCount];
+	// The GetIDType() of each object, or 0 if the slot is free.  Avoids virtual calls on lookup.
+	int types[maxCount];
 	int nextID;
 };
 
@@ -26,6 +26,7 @@
 #include "Common/Serialize/SerializeSet.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/HLE/HLE.h"
@@ -1073,14 +1074,14 @@ static bool KernelImportModuleFuncs(PSPModule *module, u32 *firstImportStubAddr,
 	return true;
 }
 
-static int gzipDecompress(u8 *OutBuffer, int OutBufferLength, u8 *InBuffer) {
+static int gzipDecompress(u8 *OutBuffer, int OutBufferLength, u8 *InBuffer, int InBufferLength) {
 	int err;
 	z_stream stream;
 	u8 *outBufferPtr;
 
 	outBufferPtr = OutBuffer;
 	stream.next_in = InBuffer;
-	stream.avail_in = (uInt)OutBufferLength;
+	stream.avail_in = (uInt)InBufferLength;
 	stream.next_out = outBufferPtr;
 	stream.avail_out = (uInt)OutBufferLength;
 	stream.zalloc = (alloc_func)0;
@@ -1104,6 +1105,10 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 	loadedModules.insert(module->GetUID());
 	memset(&module->nm, 0, sizeof(module->nm));
 
+	// Where the time goes, logged at the end.
+	double loadStart = time_now_d();
+	double decryptTime = 0.0, inflateTime = 0.0, elfTime = 0.0, scanTime = 0.0, finalizeTime = 0.0;
+
 	bool reportedModule = false;
 	u32 devkitVersion = 0;
 	u8 *newptr = 0;
@@ -1148,7 +1153,9 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 		newptr = new u8[maxElfSize];
 		ptr = newptr;
 		magicPtr = (u32_le *)ptr;
+		double decryptStart = time_now_d();
 		int ret = pspDecryptPRX(in, (u8*)ptr, head->psp_size);
+		decryptTime = time_now_d() - decryptStart;
 		if (reportedModule) {
 			// This should happen for all "kernel" modules.
 			*error_string = "Missing key";
@@ -1193,10 +1200,12 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 			// decompress if required
 			if (isGzip)
 			{
+				double inflateStart = time_now_d();
 				auto temp = new u8[ret];
 				memcpy(temp, ptr, ret);
-				gzipDecompress((u8 *)ptr, maxElfSize, temp);
+				gzipDecompress((u8 *)ptr, maxElfSize, temp, ret);
 				delete[] temp;
+				inflateTime = time_now_d() - inflateStart;
 			}
 
 			// If we've made it this far, it should be safe to dump.
@@ -1223,7 +1232,9 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 	// Open ELF reader
 	ElfReader reader((void*)ptr, elfSize);
 
+	double elfStart = time_now_d();
 	int result = reader.LoadInto(loadAddress, fromTop);
+	elfTime = time_now_d() - elfStart;
 	if (result != SCE_KERNEL_ERROR_OK) 	{
 		ERROR_LOG(SCEMODULE, "LoadInto failed with error %08x",result);
 		if (newptr)
@@ -1313,6 +1324,7 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 	}
 
 	if (!module->isFake) {
+		double scanStart = time_now_d();
 		bool scan = true;
 #if defined(MOBILE_DEVICE)
 		scan = g_Config.bFuncReplacements;
@@ -1362,8 +1374,11 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 			}
 		}
 
+		scanTime = time_now_d() - scanStart;
 		if (scan) {
+			double finalizeStart = time_now_d();
 			MIPSAnalyst::FinalizeScan(insertSymbols);
+			finalizeTime = time_now_d() - finalizeStart;
 		}
 	}
 
@@ -1540,6 +1555,10 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 		}
 	}
 
+	double relocTime = reader.GetRelocationTime();
+	INFO_LOG(LOADER, "Loaded module %s in %0.2f ms: decrypt %0.2f, inflate %0.2f, load %0.2f, relocate %0.2f, scan %0.2f, hash/replace %0.2f",
+		moduleName, (time_now_d() - loadStart) * 1000.0, decryptTime * 1000.0, inflateTime * 1000.0, (elfTime - relocTime) * 1000.0, relocTime * 1000.0, scanTime * 1000.0, finalizeTime * 1000.0);
+
 	error = 0;
 	return module;
 }
@@ -109,16 +109,26 @@ struct BufferQueue {
 	}
 
 	int get_front(unsigned char *buf, int wantedsize) {
-		if (wantedsize <= 0)
+		return get_at(buf, wantedsize, 0);
+	}
+
+	// Like get_front(), but starting offset bytes into the queue.
+	int get_at(unsigned char *buf, int wantedsize, int offset) {
+		if (wantedsize <= 0 || offset < 0)
+			return 0;
+		int bytesgot = getQueueSize() - offset;
+		if (bytesgot <= 0)
 			return 0;
-		int bytesgot = getQueueSize();
 		if (wantedsize < bytesgot)
 			bytesgot = wantedsize;
-		if (start + bytesgot <= bufQueueSize) {
-			memcpy(buf, bufQueue + start, bytesgot);
+		int pos = start + offset;
+		if (pos >= bufQueueSize)
+			pos -= bufQueueSize;
+		if (pos + bytesgot <= bufQueueSize) {
+			memcpy(buf, bufQueue + pos, bytesgot);
 		} else {
-			int size = bufQueueSize - start;
-			memcpy(buf, bufQueue + start, size);
+			int size = bufQueueSize - pos;
+			memcpy(buf, bufQueue + pos, size);
 			memcpy(buf + size, bufQueue, bytesgot - size);
 		}
 		return bytesgot;
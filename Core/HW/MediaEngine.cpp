@@ -15,7 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include "Common/ColorConv.h"
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Core/Config.h"
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/HW/MediaEngine.h"
@@ -39,8 +41,16 @@ extern "C" {
 #include "libswscale/swscale.h"
 
 }
+
+// Decoding ahead keeps frames around while the next ones decode, so they must be reference counted.
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55, 0, 100)
+#define USE_MPEG_DECODE_AHEAD
+#endif
 #endif // USE_FFMPEG
 
+// How many stepVideo() calls worth of frames the decode thread may get ahead.
+static const int MPEG_DECODE_AHEAD_STEPS = 4;
+
 #ifdef USE_FFMPEG
 static AVPixelFormat getSwsFormat(int pspFormat)
 {
@@ -123,8 +133,16 @@ MediaEngine::MediaEngine(): m_pdata(0) {
 	m_pCodecCtxs.clear();
 	m_pFrame = 0;
 	m_pFrameRGB = 0;
+	m_pDecodeFrame = 0;
 	m_pIOContext = 0;
 	m_sws_ctx = 0;
+	m_frameIsYUV = false;
+	m_decodeAhead = false;
+	m_decodeStop = false;
+	m_decodeWaiting = false;
+	m_decodeAheadBytes = 0;
+	m_decodeStepBytes = 0;
+	m_decodeStepLastRead = 0;
 #endif
 	m_sws_fmt = 0;
 	m_buffer = 0;
@@ -173,6 +191,13 @@ void MediaEngine::DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
+#ifdef USE_FFMPEG
+	if (p.mode == p.MODE_READ) {
+		// Whatever was decoded ahead is from before the state, the stream is reopened below anyway.
+		stopDecodeAhead();
+	}
+#endif
+
 	Do(p, m_videoStream);
 	Do(p, m_audioStream);
 
@@ -200,8 +225,13 @@ void MediaEngine::DoState(PointerWrap &p) {
 	u32 hasopencontext = false;
 #endif
 	Do(p, hasopencontext);
-	if (m_pdata)
+	if (m_pdata) {
+#ifdef USE_FFMPEG
+		// The decode thread only reads ahead, so m_pdata is exactly what the game has consumed.
+		std::lock_guard<std::mutex> guard(m_decodeLock);
+#endif
 		m_pdata->DoState(p);
+	}
 	if (m_demux)
 		m_demux->DoState(p);
 
@@ -236,9 +266,7 @@ static int MpegReadbuffer(void *opaque, uint8_t *buf, int buf_size) {
 		memcpy(buf, mpeg->m_mpegheader + mpeg->m_mpegheaderReadPos, size);
 		mpeg->m_mpegheaderReadPos += size;
 	} else {
-		size = mpeg->m_pdata->pop_front(buf, buf_size);
-		if (size > 0)
-			mpeg->m_decodingsize = size;
+		size = mpeg->readStreamData(buf, buf_size);
 	}
 	return size;
 }
@@ -342,12 +370,15 @@ bool MediaEngine::openContext(bool keepReadPos) {
 void MediaEngine::closeContext()
 {
 #ifdef USE_FFMPEG
+	stopDecodeAhead();
 	if (m_buffer)
 		av_free(m_buffer);
 	if (m_pFrameRGB)
 		av_frame_free(&m_pFrameRGB);
 	if (m_pFrame)
 		av_frame_free(&m_pFrame);
+	if (m_pDecodeFrame)
+		av_frame_free(&m_pDecodeFrame);
 	if (m_pIOContext && m_pIOContext->buffer)
 		av_free(m_pIOContext->buffer);
 	if (m_pIOContext)
@@ -360,6 +391,7 @@ void MediaEngine::closeContext()
 	sws_freeContext(m_sws_ctx);
 	m_sws_ctx = NULL;
 	m_pIOContext = 0;
+	m_frameIsYUV = false;
 #endif
 	m_buffer = 0;
 }
@@ -389,8 +421,16 @@ bool MediaEngine::reloadStream()
 int MediaEngine::addStreamData(const u8 *buffer, int addSize) {
 	int size = addSize;
 	if (size > 0 && m_pdata) {
-		if (!m_pdata->push(buffer, size)) 
-			size  = 0;
+		{
+#ifdef USE_FFMPEG
+			std::lock_guard<std::mutex> guard(m_decodeLock);
+#endif
+			if (!m_pdata->push(buffer, size))
+				size = 0;
+#ifdef USE_FFMPEG
+			m_decodeWake.notify_all();
+#endif
+		}
 		if (m_demux) {
 			m_demux->addStreamData(buffer, addSize);
 		}
@@ -450,6 +490,16 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 	}
 
 #ifdef USE_FFMPEG
+	if (m_decodeAhead) {
+		// The frames decoded ahead are from the old stream, and FFmpeg has already read past what
+		// the game consumed, so start over from there.  Probing gets the header again rather than
+		// ringbuffer data.  The decoder still has to wait for a keyframe, which is why decode ahead
+		// is off by default.
+		closeContext();
+		AudioClose(&m_audioContext);
+		openContext(false);
+	}
+
 	if (m_pFormatCtx && m_pCodecCtxs.find(streamNum) == m_pCodecCtxs.end()) {
 		// Get a pointer to the codec context for the video stream
 		if ((u32)streamNum >= m_pFormatCtx->nb_streams) {
@@ -471,6 +521,10 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 			return false;
 		}
 
+#ifdef USE_MPEG_DECODE_AHEAD
+		m_pCodecCtx->refcounted_frames = 1;
+#endif
+
 		AVDictionary *opt = nullptr;
 		// Allow ffmpeg to use any number of threads it wants.  Without this, it doesn't use threads.
 		av_dict_set(&opt, "threads", "0", 0);
@@ -516,6 +570,7 @@ bool MediaEngine::setVideoDim(int width, int height)
 	sws_freeContext(m_sws_ctx);
 	m_sws_ctx = NULL;
 	m_sws_fmt = -1;
+	m_frameIsYUV = false;
 
 	if (m_desWidth == 0 || m_desHeight == 0) {
 		// Can't setup SWS yet, so stop for now.
@@ -592,11 +647,80 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 	if (!m_pFrame)
 		return false;
 
+	if (!m_decodeAhead && canDecodeAhead())
+		startDecodeAhead();
+
+	DecodedStep step{};
+	if (m_decodeAhead) {
+		takeDecodedStep(step);
+		if (step.lastReadSize > 0)
+			m_decodingsize = step.lastReadSize;
+	} else {
+		if (!m_pDecodeFrame)
+			m_pDecodeFrame = av_frame_alloc();
+		step.frame = m_pDecodeFrame;
+		decodeStep(m_pCodecCtx, step);
+	}
+
+	if (step.gotFrame) {
+		// A skipped frame isn't converted, so writes keep showing the previous one.  If that one
+		// was left as YUV, it's still needed in m_pFrame.
+		AVFrame *decoded = step.frame;
+		if (!skipFrame || !m_frameIsYUV) {
+			av_frame_unref(m_pFrame);
+			av_frame_move_ref(m_pFrame, step.frame);
+			decoded = m_pFrame;
+		}
+
+		if (!m_pFrameRGB) {
+			setVideoDim();
+		}
+		if (m_pFrameRGB && !skipFrame) {
+			// Unscaled 4:2:0 (all PSP videos) is converted on write, straight to the PSP format.
+			m_frameIsYUV = m_pFrame->format == AV_PIX_FMT_YUV420P && m_pFrame->width == m_desWidth && m_pFrame->height == m_desHeight;
+			if (!m_frameIsYUV) {
+				updateSwsFormat(videoPixelMode);
+				// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
+				// Update the linesize for the new format too.  We started with the largest size, so it should fit.
+				m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
+
+				sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
+					m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
+			}
+		}
+
+		if (av_frame_get_best_effort_timestamp(decoded) != AV_NOPTS_VALUE)
+			m_videopts = av_frame_get_best_effort_timestamp(decoded) + av_frame_get_pkt_duration(decoded) - m_firstTimeStamp;
+		else
+			m_videopts += av_frame_get_pkt_duration(decoded);
+	}
+	if (step.frame == m_pDecodeFrame)
+		av_frame_unref(step.frame);
+	else
+		av_frame_free(&step.frame);
+
+	if (step.hitEnd) {
+		// Sometimes, m_readSize is less than m_streamSize at the end, but not by much.
+		// This is kinda a hack, but the ringbuffer would have to be prematurely empty too.
+		std::lock_guard<std::mutex> guard(m_decodeLock);
+		m_isVideoEnd = !step.gotFrame && (m_pdata->getQueueSize() == 0);
+		if (m_isVideoEnd)
+			m_decodingsize = 0;
+	}
+	return step.gotFrame;
+#else
+	// If video engine is not available, just add to the timestamp at least.
+	m_videopts += 3003;
+	return true;
+#endif // USE_FFMPEG
+}
+
+#ifdef USE_FFMPEG
+bool MediaEngine::decodeStep(AVCodecContext *codecCtx, DecodedStep &step) {
 	AVPacket packet;
 	av_init_packet(&packet);
 	int frameFinished;
-	bool bGetFrame = false;
-	while (!bGetFrame) {
+	while (!step.gotFrame) {
 		bool dataEnd = av_read_frame(m_pFormatCtx, &packet) < 0;
 		// Even if we've read all frames, some may have been re-ordered frames at the end.
 		// Still need to decode those, so keep calling avcodec_decode_video2().
@@ -610,33 +734,12 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 				av_free_packet(&packet);
 #endif
 
-			int result = avcodec_decode_video2(m_pCodecCtx, m_pFrame, &frameFinished, &packet);
+			int result = avcodec_decode_video2(codecCtx, step.frame, &frameFinished, &packet);
 			if (frameFinished) {
-				if (!m_pFrameRGB) {
-					setVideoDim();
-				}
-				if (m_pFrameRGB && !skipFrame) {
-					updateSwsFormat(videoPixelMode);
-					// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
-					// Update the linesize for the new format too.  We started with the largest size, so it should fit.
-					m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
-
-					sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
-						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
-				}
-
-				if (av_frame_get_best_effort_timestamp(m_pFrame) != AV_NOPTS_VALUE)
-					m_videopts = av_frame_get_best_effort_timestamp(m_pFrame) + av_frame_get_pkt_duration(m_pFrame) - m_firstTimeStamp;
-				else
-					m_videopts += av_frame_get_pkt_duration(m_pFrame);
-				bGetFrame = true;
+				step.gotFrame = true;
 			}
 			if (result <= 0 && dataEnd) {
-				// Sometimes, m_readSize is less than m_streamSize at the end, but not by much.
-				// This is kinda a hack, but the ringbuffer would have to be prematurely empty too.
-				m_isVideoEnd = !bGetFrame && (m_pdata->getQueueSize() == 0);
-				if (m_isVideoEnd)
-					m_decodingsize = 0;
+				step.hitEnd = true;
 				break;
 			}
 		}
@@ -646,14 +749,94 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 		av_free_packet(&packet);
 #endif
 	}
-	return bGetFrame;
+	return step.gotFrame;
+}
+
+bool MediaEngine::canDecodeAhead() {
+#ifdef USE_MPEG_DECODE_AHEAD
+	if (!g_Config.bMpegDecodeAhead || !m_pFormatCtx || !m_pdata)
+		return false;
+	// The rest of the header is read outside m_pdata, let's not complicate that.
+	if (m_mpegheaderReadPos < m_mpegheaderSize)
+		return false;
+	return m_pCodecCtxs.find(m_videoStream) != m_pCodecCtxs.end();
 #else
-	// If video engine is not available, just add to the timestamp at least.
-	m_videopts += 3003;
-	return true;
-#endif // USE_FFMPEG
+	return false;
+#endif
+}
+
+void MediaEngine::startDecodeAhead() {
+	m_decodeStop = false;
+	m_decodeWaiting = false;
+	m_decodeAheadBytes = 0;
+	m_decodeAhead = true;
+	m_decodeThread = std::thread(&MediaEngine::decodeAheadThread, this, m_pCodecCtxs[m_videoStream]);
+}
+
+void MediaEngine::stopDecodeAhead() {
+	if (!m_decodeAhead)
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(m_decodeLock);
+		m_decodeStop = true;
+		m_decodeWake.notify_all();
+	}
+	m_decodeThread.join();
+	m_decodeAhead = false;
+
+	for (DecodedStep &step : m_decodeQueue) {
+		av_frame_free(&step.frame);
+	}
+	m_decodeQueue.clear();
+	m_decodeAheadBytes = 0;
+}
+
+void MediaEngine::decodeAheadThread(AVCodecContext *codecCtx) {
+	setCurrentThreadName("MpegDecode");
+
+	std::unique_lock<std::mutex> guard(m_decodeLock);
+	while (!m_decodeStop) {
+		if ((int)m_decodeQueue.size() >= MPEG_DECODE_AHEAD_STEPS) {
+			m_decodeWake.wait(guard);
+			continue;
+		}
+
+		m_decodeStepBytes = 0;
+		m_decodeStepLastRead = 0;
+		guard.unlock();
+
+		DecodedStep step{};
+		step.frame = av_frame_alloc();
+		decodeStep(codecCtx, step);
+
+		guard.lock();
+		step.bytesRead = m_decodeStepBytes;
+		step.lastReadSize = m_decodeStepLastRead;
+		m_decodeQueue.push_back(step);
+		m_decodeDone.notify_one();
+	}
 }
 
+void MediaEngine::takeDecodedStep(DecodedStep &step) {
+	std::unique_lock<std::mutex> guard(m_decodeLock);
+	m_decodeWaiting = true;
+	// If it's waiting for more data, it can stop now: the game won't add any until we return.
+	m_decodeWake.notify_all();
+	while (m_decodeQueue.empty()) {
+		m_decodeDone.wait(guard);
+	}
+	m_decodeWaiting = false;
+
+	step = m_decodeQueue.front();
+	m_decodeQueue.pop_front();
+	// Now the game has actually consumed this data.
+	m_pdata->pop_front(nullptr, step.bytesRead);
+	m_decodeAheadBytes -= step.bytesRead;
+	m_decodeWake.notify_all();
+}
+#endif
+
 // Helpers that null out alpha (which seems to be the case on the PSP.)
 // Some games depend on this, for example Sword Art Online (doesn't clear A's from buffer.)
 inline void writeVideoLineRGBA(void *destp, const void *srcp, int width) {
@@ -693,6 +876,43 @@ inline void writeVideoLineABGR4444(void *destp, const void *srcp, int width) {
 	}
 }
 
+#ifdef USE_FFMPEG
+static void writeVideoLineYUV(u8 *dest, const AVFrame *frame, int x, int y, int width, int videoPixelMode) {
+	if (width <= 0)
+		return;
+	const u8 *ySrc = frame->data[0] + y * frame->linesize[0] + x;
+	const u8 *uSrc = frame->data[1] + (y / 2) * frame->linesize[1] + x / 2;
+	const u8 *vSrc = frame->data[2] + (y / 2) * frame->linesize[2] + x / 2;
+
+	const int bpp = getPixelFormatBytes(videoPixelMode);
+	// Starting on the second pixel of a chroma pair, do that one alone so the rest line up.
+	int count = (x & 1) ? 1 : width;
+	while (width > 0) {
+		switch (videoPixelMode) {
+		case GE_CMODE_32BIT_ABGR8888:
+			ConvertYUV420ToRGBA8888((u32_le *)dest, ySrc, uSrc, vSrc, count);
+			break;
+		case GE_CMODE_16BIT_BGR5650:
+			ConvertYUV420ToRGB565((u16_le *)dest, ySrc, uSrc, vSrc, count);
+			break;
+		case GE_CMODE_16BIT_ABGR5551:
+			ConvertYUV420ToRGBA5551((u16_le *)dest, ySrc, uSrc, vSrc, count);
+			break;
+		case GE_CMODE_16BIT_ABGR4444:
+			ConvertYUV420ToRGBA4444((u16_le *)dest, ySrc, uSrc, vSrc, count);
+			break;
+		}
+
+		dest += count * bpp;
+		ySrc += count;
+		uSrc += (count + 1) / 2;
+		vSrc += (count + 1) / 2;
+		width -= count;
+		count = width;
+	}
+}
+#endif
+
 int MediaEngine::writeVideoImage(u32 bufferPtr, int frameWidth, int videoPixelMode) {
 	if (!Memory::IsValidAddress(bufferPtr) || frameWidth > 2048) {
 		// Clearly invalid values.  Let's just not.
@@ -731,38 +951,44 @@ int MediaEngine::writeVideoImage(u32 bufferPtr, int frameWidth, int videoPixelMo
 		imgbuf = new u8[videoImageSize];
 	}
 
-	switch (videoPixelMode) {
-	case GE_CMODE_32BIT_ABGR8888:
+	if (m_frameIsYUV && videoLineSize != 0) {
 		for (int y = 0; y < height; y++) {
-			writeVideoLineRGBA(imgbuf + videoLineSize * y, data, width);
-			data += width * sizeof(u32);
+			writeVideoLineYUV(imgbuf + videoLineSize * y, m_pFrame, 0, y, width, videoPixelMode);
 		}
-		break;
+	} else {
+		switch (videoPixelMode) {
+		case GE_CMODE_32BIT_ABGR8888:
+			for (int y = 0; y < height; y++) {
+				writeVideoLineRGBA(imgbuf + videoLineSize * y, data, width);
+				data += width * sizeof(u32);
+			}
+			break;
 
-	case GE_CMODE_16BIT_BGR5650:
-		for (int y = 0; y < height; y++) {
-			writeVideoLineABGR5650(imgbuf + videoLineSize * y, data, width);
-			data += width * sizeof(u16);
-		}
-		break;
+		case GE_CMODE_16BIT_BGR5650:
+			for (int y = 0; y < height; y++) {
+				writeVideoLineABGR5650(imgbuf + videoLineSize * y, data, width);
+				data += width * sizeof(u16);
+			}
+			break;
 
-	case GE_CMODE_16BIT_ABGR5551:
-		for (int y = 0; y < height; y++) {
-			writeVideoLineABGR5551(imgbuf + videoLineSize * y, data, width);
-			data += width * sizeof(u16);
-		}
-		break;
+		case GE_CMODE_16BIT_ABGR5551:
+			for (int y = 0; y < height; y++) {
+				writeVideoLineABGR5551(imgbuf + videoLineSize * y, data, width);
+				data += width * sizeof(u16);
+			}
+			break;
 
-	case GE_CMODE_16BIT_ABGR4444:
-		for (int y = 0; y < height; y++) {
-			writeVideoLineABGR4444(imgbuf + videoLineSize * y, data, width);
-			data += width * sizeof(u16);
-		}
-		break;
+		case GE_CMODE_16BIT_ABGR4444:
+			for (int y = 0; y < height; y++) {
+				writeVideoLineABGR4444(imgbuf + videoLineSize * y, data, width);
+				data += width * sizeof(u16);
+			}
+			break;
 
-	default:
-		ERROR_LOG_REPORT(ME, "Unsupported video pixel format %d", videoPixelMode);
-		break;
+		default:
+			ERROR_LOG_REPORT(ME, "Unsupported video pixel format %d", videoPixelMode);
+			break;
+		}
 	}
 
 	if (swizzle) {
@@ -823,50 +1049,59 @@ int MediaEngine::writeVideoImageWithRange(u32 bufferPtr, int frameWidth, int vid
 	if (height > m_desHeight - ypos)
 		height = m_desHeight - ypos;
 
-	switch (videoPixelMode) {
-	case GE_CMODE_32BIT_ABGR8888:
-		data += (ypos * m_desWidth + xpos) * sizeof(u32);
-		for (int y = 0; y < height; y++) {
-			writeVideoLineRGBA(imgbuf, data, width);
-			data += m_desWidth * sizeof(u32);
-			imgbuf += videoLineSize;
-			CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u32), true, width * sizeof(u32), currentMIPS->pc);
-		}
-		break;
-
-	case GE_CMODE_16BIT_BGR5650:
-		data += (ypos * m_desWidth + xpos) * sizeof(u16);
-		for (int y = 0; y < height; y++) {
-			writeVideoLineABGR5650(imgbuf, data, width);
-			data += m_desWidth * sizeof(u16);
-			imgbuf += videoLineSize;
-			CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u16), true, width * sizeof(u16), currentMIPS->pc);
-		}
-		break;
-
-	case GE_CMODE_16BIT_ABGR5551:
-		data += (ypos * m_desWidth + xpos) * sizeof(u16);
+	if (m_frameIsYUV && videoLineSize != 0) {
+		const int bpp = getPixelFormatBytes(videoPixelMode);
 		for (int y = 0; y < height; y++) {
-			writeVideoLineABGR5551(imgbuf, data, width);
-			data += m_desWidth * sizeof(u16);
+			writeVideoLineYUV(imgbuf, m_pFrame, xpos, ypos + y, width, videoPixelMode);
 			imgbuf += videoLineSize;
-			CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u16), true, width * sizeof(u16), currentMIPS->pc);
+			CBreakPoints::ExecMemCheck(bufferPtr + y * videoLineSize, true, width * bpp, currentMIPS->pc);
 		}
-		break;
+	} else {
+		switch (videoPixelMode) {
+		case GE_CMODE_32BIT_ABGR8888:
+			data += (ypos * m_desWidth + xpos) * sizeof(u32);
+			for (int y = 0; y < height; y++) {
+				writeVideoLineRGBA(imgbuf, data, width);
+				data += m_desWidth * sizeof(u32);
+				imgbuf += videoLineSize;
+				CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u32), true, width * sizeof(u32), currentMIPS->pc);
+			}
+			break;
+
+		case GE_CMODE_16BIT_BGR5650:
+			data += (ypos * m_desWidth + xpos) * sizeof(u16);
+			for (int y = 0; y < height; y++) {
+				writeVideoLineABGR5650(imgbuf, data, width);
+				data += m_desWidth * sizeof(u16);
+				imgbuf += videoLineSize;
+				CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u16), true, width * sizeof(u16), currentMIPS->pc);
+			}
+			break;
+
+		case GE_CMODE_16BIT_ABGR5551:
+			data += (ypos * m_desWidth + xpos) * sizeof(u16);
+			for (int y = 0; y < height; y++) {
+				writeVideoLineABGR5551(imgbuf, data, width);
+				data += m_desWidth * sizeof(u16);
+				imgbuf += videoLineSize;
+				CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u16), true, width * sizeof(u16), currentMIPS->pc);
+			}
+			break;
+
+		case GE_CMODE_16BIT_ABGR4444:
+			data += (ypos * m_desWidth + xpos) * sizeof(u16);
+			for (int y = 0; y < height; y++) {
+				writeVideoLineABGR4444(imgbuf, data, width);
+				data += m_desWidth * sizeof(u16);
+				imgbuf += videoLineSize;
+				CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u16), true, width * sizeof(u16), currentMIPS->pc);
+			}
+			break;
 
-	case GE_CMODE_16BIT_ABGR4444:
-		data += (ypos * m_desWidth + xpos) * sizeof(u16);
-		for (int y = 0; y < height; y++) {
-			writeVideoLineABGR4444(imgbuf, data, width);
-			data += m_desWidth * sizeof(u16);
-			imgbuf += videoLineSize;
-			CBreakPoints::ExecMemCheck(bufferPtr + y * frameWidth * sizeof(u16), true, width * sizeof(u16), currentMIPS->pc);
+		default:
+			ERROR_LOG_REPORT(ME, "Unsupported video pixel format %d", videoPixelMode);
+			break;
 		}
-		break;
-
-	default:
-		ERROR_LOG_REPORT(ME, "Unsupported video pixel format %d", videoPixelMode);
-		break;
 	}
 
 	if (swizzle) {
@@ -889,15 +1124,52 @@ int MediaEngine::writeVideoImageWithRange(u32 bufferPtr, int frameWidth, int vid
 
 u8 *MediaEngine::getFrameImage() {
 #ifdef USE_FFMPEG
+	if (m_frameIsYUV) {
+		// Rarely needed, so only build the RGBA frame on request.
+		for (int y = 0; y < m_desHeight; y++) {
+			writeVideoLineYUV(m_buffer + y * m_desWidth * sizeof(u32), m_pFrame, 0, y, m_desWidth, GE_CMODE_32BIT_ABGR8888);
+		}
+		return m_buffer;
+	}
 	return m_pFrameRGB->data[0];
 #else
 	return NULL;
 #endif
 }
 
+int MediaEngine::readStreamData(u8 *buf, int size) {
+#ifdef USE_FFMPEG
+	std::unique_lock<std::mutex> guard(m_decodeLock);
+	if (!m_decodeAhead) {
+		int got = m_pdata->pop_front(buf, size);
+		if (got > 0)
+			m_decodingsize = got;
+		return got;
+	}
+
+	// A short read changes what FFmpeg does next, so it has to happen at the same point as without
+	// the thread: only when stepVideo() is actually waiting for the step in progress.
+	while (m_pdata->getQueueSize() - m_decodeAheadBytes < size && !(m_decodeWaiting && m_decodeQueue.empty()) && !m_decodeStop) {
+		m_decodeWake.wait(guard);
+	}
+
+	int got = m_pdata->get_at(buf, size, m_decodeAheadBytes);
+	m_decodeAheadBytes += got;
+	m_decodeStepBytes += got;
+	if (got > 0)
+		m_decodeStepLastRead = got;
+	return got;
+#else
+	return 0;
+#endif
+}
+
 int MediaEngine::getRemainSize() {
 	if (!m_pdata)
 		return 0;
+#ifdef USE_FFMPEG
+	std::lock_guard<std::mutex> guard(m_decodeLock);
+#endif
 	return std::max(m_pdata->getRemainSize() - m_decodingsize - 2048, 0);
 }
 
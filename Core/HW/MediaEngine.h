@@ -24,7 +24,12 @@
 
 // An approximation of what the interface will look like. Similar to JPCSP's.
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
+
 #include "Common/CommonTypes.h"
 #include "Core/HLE/sceMpeg.h"
 #include "Core/HW/MpegDemux.h"
@@ -80,6 +85,8 @@ public:
 	int writeVideoImageWithRange(u32 bufferPtr, int frameWidth, int videoPixelMode,
 	                             int xpos, int ypos, int width, int height);
 	int getAudioSamples(u32 bufferPtr);
+	// Called by FFmpeg to read the video stream from m_pdata.
+	int readStreamData(u8 *buf, int size);
 
 	s64 getVideoTimeStamp();
 	s64 getAudioTimeStamp();
@@ -99,6 +106,25 @@ private:
 	void updateSwsFormat(int videoPixelMode);
 	int getNextAudioFrame(u8 **buf, int *headerCode1, int *headerCode2);
 
+#ifdef USE_FFMPEG
+	// The result of one stepVideo() call, possibly decoded ahead of time by the decode thread.
+	struct DecodedStep {
+		AVFrame *frame;
+		// Read from m_pdata, which is only popped once the step is used.
+		int bytesRead;
+		int lastReadSize;
+		bool gotFrame;
+		bool hitEnd;
+	};
+
+	bool decodeStep(AVCodecContext *codecCtx, DecodedStep &step);
+	bool canDecodeAhead();
+	void startDecodeAhead();
+	void stopDecodeAhead();
+	void decodeAheadThread(AVCodecContext *codecCtx);
+	void takeDecodedStep(DecodedStep &step);
+#endif
+
 public:  // TODO: Very little of this below should be public.
 
 	// Video ffmpeg context - not used for audio
@@ -107,8 +133,28 @@ public:  // TODO: Very little of this below should be public.
 	std::map<int, AVCodecContext *> m_pCodecCtxs;
 	AVFrame *m_pFrame;
 	AVFrame *m_pFrameRGB;
+	// Decoded into when not decoding ahead, reused between steps.
+	AVFrame *m_pDecodeFrame;
 	AVIOContext *m_pIOContext;
 	SwsContext *m_sws_ctx;
+	// When set, the last frame only exists as YUV in m_pFrame, and is converted straight into PSP RAM on write.
+	bool m_frameIsYUV;
+
+	// Decode ahead thread state.  m_decodeLock also guards m_pdata.
+	std::thread m_decodeThread;
+	std::mutex m_decodeLock;
+	std::condition_variable m_decodeWake;
+	std::condition_variable m_decodeDone;
+	std::deque<DecodedStep> m_decodeQueue;
+	bool m_decodeAhead;
+	bool m_decodeStop;
+	// Set while stepVideo() waits for the step in progress.
+	bool m_decodeWaiting;
+	// Read by the decode thread but not yet popped from m_pdata.
+	int m_decodeAheadBytes;
+	// Only used on the decode thread, for the step in progress.
+	int m_decodeStepBytes;
+	int m_decodeStepLastRead;
 #endif
 
 	int m_sws_fmt;
@@ -17,6 +17,8 @@
 
 #include <algorithm>
 
+#include "ppsspp_config.h"
+#include "Common/Common.h"
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/Serialize/SerializeFuncs.h"
@@ -24,11 +26,32 @@
 #include "Core/HLE/sceAtrac.h"
 #include "Core/Config.h"
 #include "Core/Reporting.h"
+#include "Core/ThreadPools.h"
 #include "Core/Util/AudioFormat.h"
 #include "SasAudio.h"
 
+#ifdef _M_SSE
+#include <emmintrin.h>
+#if _M_SSE >= 0x401
+#include <smmintrin.h>
+#endif
+#endif
+
+#if PPSSPP_ARCH(ARM64)
+#if defined(_MSC_VER)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 // #define AUDIO_TO_FILE
 
+// Waking workers costs more than mixing a few voices.
+static const int SAS_PARALLEL_MIN_VOICES = 8;
+// Output samples per block when mixing prepared voices in parallel.
+static const int SAS_MIX_BLOCK_SIZE = 32;
+
 static const u8 f[16][2] = {
 	{   0,   0 },
 	{  60,   0 },
@@ -337,7 +360,6 @@ SasInstance::SasInstance()
 		outputMode(PSP_SAS_OUTPUTMODE_MIXED),
 		mixBuffer(0),
 		sendBuffer(0),
-		sendBufferDownsampled(0),
 		sendBufferProcessed(0),
 		grainSize(0) {
 #ifdef AUDIO_TO_FILE
@@ -375,11 +397,9 @@ void SasInstance::GetDebugText(char *text, size_t bufsize) {
 void SasInstance::ClearGrainSize() {
 	delete[] mixBuffer;
 	delete[] sendBuffer;
-	delete[] sendBufferDownsampled;
 	delete[] sendBufferProcessed;
 	mixBuffer = nullptr;
 	sendBuffer = nullptr;
-	sendBufferDownsampled = nullptr;
 	sendBufferProcessed = nullptr;
 }
 
@@ -389,16 +409,13 @@ void SasInstance::SetGrainSize(int newGrainSize) {
 	// If you change the sizes here, don't forget DoState().
 	delete[] mixBuffer;
 	delete[] sendBuffer;
-	delete[] sendBufferDownsampled;
 	delete[] sendBufferProcessed;
 
 	mixBuffer = new s32[grainSize * 2];
 	sendBuffer = new s32[grainSize * 2];
-	sendBufferDownsampled = new s16[grainSize];
 	sendBufferProcessed = new s16[grainSize * 2];
 	memset(mixBuffer, 0, sizeof(int) * grainSize * 2);
 	memset(sendBuffer, 0, sizeof(int) * grainSize * 2);
-	memset(sendBufferDownsampled, 0, sizeof(s16) * grainSize);
 	memset(sendBufferProcessed, 0, sizeof(s16) * grainSize * 2);
 }
 
@@ -476,7 +493,223 @@ bool SasVoice::HaveSamplesEnded() const {
 	}
 }
 
+#ifdef _M_SSE
+// Only the low 32 bits of each product, like a plain int multiply.
+static inline __m128i MulLo32(__m128i a, __m128i b) {
+#if _M_SSE >= 0x401
+	return _mm_mullo_epi32(a, b);
+#else
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+// Packs the two interpolation weights for _mm_madd_epi16 against a (s[0], s[1]) pair.
+static inline int InterpWeights(int f) {
+	return ((u32)f << 16) | (u32)(PSP_SAS_PITCH_MASK - f);
+}
+#endif
+
+void SasResample(int *out, const s16_le *src, int srcSize, u32 sampleFrac, int pitch, int count) {
+	int i = 0;
+	const int pos = sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT;
+	const int f = sampleFrac & PSP_SAS_PITCH_MASK;
+
+	if (pitch == PSP_SAS_PITCH_BASE && f == 0) {
+		// No resampling needed, just widen.
+		const s16 *s = (const s16 *)(src + pos);
+#ifdef _M_SSE
+		for (; i + 8 <= count && pos + i + 8 <= srcSize; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+			_mm_storeu_si128((__m128i *)(out + i), _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+			_mm_storeu_si128((__m128i *)(out + i + 4), _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+		}
+#elif PPSSPP_ARCH(ARM64)
+		for (; i + 8 <= count && pos + i + 8 <= srcSize; i += 8) {
+			int16x8_t v = vld1q_s16(s + i);
+			vst1q_s32(out + i, vmovl_s16(vget_low_s16(v)));
+			vst1q_s32(out + i + 4, vmovl_s16(vget_high_s16(v)));
+		}
+#endif
+		for (; i < count; ++i) {
+			out[i] = src[pos + i];
+		}
+		return;
+	}
+
+	if ((pitch & PSP_SAS_PITCH_MASK) == 0 && pitch != 0) {
+		// Whole sample steps (1x with an offset, 2x, ...), so the weights never change.
+		const int step = pitch >> PSP_SAS_PITCH_BASE_SHIFT;
+		const s16 *s = (const s16 *)(src + pos);
+#ifdef _M_SSE
+		const __m128i weights = _mm_set1_epi32(InterpWeights(f));
+		if (step == 1) {
+			for (; i + 4 <= count && pos + i + 5 <= srcSize; i += 4) {
+				__m128i s0 = _mm_loadl_epi64((const __m128i *)(s + i));
+				__m128i s1 = _mm_loadl_epi64((const __m128i *)(s + i + 1));
+				__m128i sum = _mm_madd_epi16(_mm_unpacklo_epi16(s0, s1), weights);
+				_mm_storeu_si128((__m128i *)(out + i), _mm_srai_epi32(sum, PSP_SAS_PITCH_BASE_SHIFT));
+			}
+		} else if (step == 2) {
+			// The pairs are already next to each other.
+			for (; i + 4 <= count && pos + i * 2 + 8 <= srcSize; i += 4) {
+				__m128i pairs = _mm_loadu_si128((const __m128i *)(s + i * 2));
+				__m128i sum = _mm_madd_epi16(pairs, weights);
+				_mm_storeu_si128((__m128i *)(out + i), _mm_srai_epi32(sum, PSP_SAS_PITCH_BASE_SHIFT));
+			}
+		}
+#elif PPSSPP_ARCH(ARM64)
+		const int16_t w0 = (int16_t)(PSP_SAS_PITCH_MASK - f);
+		const int16_t w1 = (int16_t)f;
+		if (step == 1) {
+			for (; i + 4 <= count && pos + i + 5 <= srcSize; i += 4) {
+				int32x4_t sum = vmull_n_s16(vld1_s16(s + i), w0);
+				sum = vmlal_n_s16(sum, vld1_s16(s + i + 1), w1);
+				vst1q_s32(out + i, vshrq_n_s32(sum, PSP_SAS_PITCH_BASE_SHIFT));
+			}
+		} else if (step == 2) {
+			for (; i + 4 <= count && pos + i * 2 + 8 <= srcSize; i += 4) {
+				int16x4x2_t pairs = vld2_s16(s + i * 2);
+				int32x4_t sum = vmull_n_s16(pairs.val[0], w0);
+				sum = vmlal_n_s16(sum, pairs.val[1], w1);
+				vst1q_s32(out + i, vshrq_n_s32(sum, PSP_SAS_PITCH_BASE_SHIFT));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			const s16_le *p = src + pos + i * step;
+			out[i] = (p[0] * (PSP_SAS_PITCH_MASK - f) + p[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
+		}
+		return;
+	}
+
+#if defined(_M_SSE) || PPSSPP_ARCH(ARM64)
+	if (pitch == PSP_SAS_PITCH_BASE / 2) {
+		// Half speed: every four outputs use three samples, and the weights alternate.
+		// Whether the second output moves on to the next sample depends on the starting fraction.
+		const s16 *s = (const s16 *)(src + pos);
+		const bool advanceEarly = f >= PSP_SAS_PITCH_BASE / 2;
+		const int f2 = advanceEarly ? f - PSP_SAS_PITCH_BASE / 2 : f + PSP_SAS_PITCH_BASE / 2;
+#ifdef _M_SSE
+		const __m128i weights = _mm_setr_epi32(InterpWeights(f), InterpWeights(f2), InterpWeights(f), InterpWeights(f2));
+		for (; i + 4 <= count && pos + i / 2 + 5 <= srcSize; i += 4) {
+			__m128i s0 = _mm_loadl_epi64((const __m128i *)(s + i / 2));
+			__m128i s1 = _mm_loadl_epi64((const __m128i *)(s + i / 2 + 1));
+			__m128i pairs = _mm_unpacklo_epi16(s0, s1);
+			if (advanceEarly) {
+				pairs = _mm_shuffle_epi32(pairs, _MM_SHUFFLE(2, 1, 1, 0));
+			} else {
+				pairs = _mm_shuffle_epi32(pairs, _MM_SHUFFLE(1, 1, 0, 0));
+			}
+			__m128i sum = _mm_madd_epi16(pairs, weights);
+			_mm_storeu_si128((__m128i *)(out + i), _mm_srai_epi32(sum, PSP_SAS_PITCH_BASE_SHIFT));
+		}
+#else
+		const int16_t w0[4] = { (int16_t)(PSP_SAS_PITCH_MASK - f), (int16_t)(PSP_SAS_PITCH_MASK - f2), (int16_t)(PSP_SAS_PITCH_MASK - f), (int16_t)(PSP_SAS_PITCH_MASK - f2) };
+		const int16_t w1[4] = { (int16_t)f, (int16_t)f2, (int16_t)f, (int16_t)f2 };
+		const int16x4_t weights0 = vld1_s16(w0);
+		const int16x4_t weights1 = vld1_s16(w1);
+		for (; i + 4 <= count && pos + i / 2 + 6 <= srcSize; i += 4) {
+			int16x4_t a = vld1_s16(s + i / 2);
+			int16x4_t b = vld1_s16(s + i / 2 + 1);
+			int16x4_t first, second;
+			if (advanceEarly) {
+				first = vzip1_s16(a, b);
+				second = vzip1_s16(b, vld1_s16(s + i / 2 + 2));
+			} else {
+				first = vzip1_s16(a, a);
+				second = vzip1_s16(b, b);
+			}
+			int32x4_t sum = vmull_s16(first, weights0);
+			sum = vmlal_s16(sum, second, weights1);
+			vst1q_s32(out + i, vshrq_n_s32(sum, PSP_SAS_PITCH_BASE_SHIFT));
+		}
+#endif
+		sampleFrac += pitch * i;
+	}
+#endif
+
+	for (; i < count; ++i) {
+		const s16_le *s = src + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+		int frac = sampleFrac & PSP_SAS_PITCH_MASK;
+		out[i] = (s[0] * (PSP_SAS_PITCH_MASK - frac) + s[1] * frac) >> PSP_SAS_PITCH_BASE_SHIFT;
+		sampleFrac += pitch;
+	}
+}
+
+void SasMixScaled(int *mixBuffer, int *sendBuffer, const int *samples, const int *envelope, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight) {
+	int i = 0;
+#ifdef _M_SSE
+	const __m128i round = _mm_set1_epi32(1 << 14);
+	const __m128i volume = _mm_setr_epi32(volumeLeft, volumeRight, volumeLeft, volumeRight);
+	const __m128i effect = _mm_setr_epi32(effectLeft, effectRight, effectLeft, effectRight);
+	for (; i + 4 <= count; i += 4) {
+		__m128i sample = MulLo32(_mm_loadu_si128((const __m128i *)(samples + i)), _mm_loadu_si128((const __m128i *)(envelope + i)));
+		sample = _mm_srai_epi32(_mm_add_epi32(sample, round), 15);
+		// Duplicate each sample for left and right.
+		__m128i lo = _mm_unpacklo_epi32(sample, sample);
+		__m128i hi = _mm_unpackhi_epi32(sample, sample);
+
+		__m128i *mix = (__m128i *)(mixBuffer + i * 2);
+		__m128i *send = (__m128i *)(sendBuffer + i * 2);
+		_mm_storeu_si128(mix, _mm_add_epi32(_mm_loadu_si128(mix), _mm_srai_epi32(MulLo32(lo, volume), 12)));
+		_mm_storeu_si128(mix + 1, _mm_add_epi32(_mm_loadu_si128(mix + 1), _mm_srai_epi32(MulLo32(hi, volume), 12)));
+		_mm_storeu_si128(send, _mm_add_epi32(_mm_loadu_si128(send), _mm_srai_epi32(MulLo32(lo, effect), 12)));
+		_mm_storeu_si128(send + 1, _mm_add_epi32(_mm_loadu_si128(send + 1), _mm_srai_epi32(MulLo32(hi, effect), 12)));
+	}
+#elif PPSSPP_ARCH(ARM64)
+	const int32_t volumes[4] = { volumeLeft, volumeRight, volumeLeft, volumeRight };
+	const int32_t effects[4] = { effectLeft, effectRight, effectLeft, effectRight };
+	const int32x4_t volume = vld1q_s32(volumes);
+	const int32x4_t effect = vld1q_s32(effects);
+	for (; i + 4 <= count; i += 4) {
+		int32x4_t sample = vmulq_s32(vld1q_s32(samples + i), vld1q_s32(envelope + i));
+		sample = vshrq_n_s32(vaddq_s32(sample, vdupq_n_s32(1 << 14)), 15);
+		int32x4_t lo = vzip1q_s32(sample, sample);
+		int32x4_t hi = vzip2q_s32(sample, sample);
+
+		int *mix = mixBuffer + i * 2;
+		int *send = sendBuffer + i * 2;
+		vst1q_s32(mix, vaddq_s32(vld1q_s32(mix), vshrq_n_s32(vmulq_s32(lo, volume), 12)));
+		vst1q_s32(mix + 4, vaddq_s32(vld1q_s32(mix + 4), vshrq_n_s32(vmulq_s32(hi, volume), 12)));
+		vst1q_s32(send, vaddq_s32(vld1q_s32(send), vshrq_n_s32(vmulq_s32(lo, effect), 12)));
+		vst1q_s32(send + 4, vaddq_s32(vld1q_s32(send + 4), vshrq_n_s32(vmulq_s32(hi, effect), 12)));
+	}
+#endif
+	for (; i < count; ++i) {
+		// We just scale by the envelope before we scale by volumes.
+		// Again, we round up by adding (1 << 14) first (*after* multiplying.)
+		int sample = ((samples[i] * envelope[i]) + (1 << 14)) >> 15;
+
+		// We mix into this 32-bit temp buffer and clip in a second loop
+		// Ideally, the shift right should be there too but for now I'm concerned about
+		// not overflowing.
+		mixBuffer[i * 2] += (sample * volumeLeft) >> 12;
+		mixBuffer[i * 2 + 1] += (sample * volumeRight) >> 12;
+		sendBuffer[i * 2] += sample * effectLeft >> 12;
+		sendBuffer[i * 2 + 1] += sample * effectRight >> 12;
+	}
+}
+
+void SasInstance::VoiceMix::Resize(int grainSize) {
+	if ((int)samples.size() == grainSize)
+		return;
+	mixTemp.resize(grainSize * 4 + 2 + 8);
+	samples.resize(grainSize);
+	envelope.resize(grainSize);
+}
+
 void SasInstance::MixVoice(SasVoice &voice) {
+	voiceMix_.Resize(grainSize);
+	PrepareVoice(voice, voiceMix_);
+	MixPreparedVoice(voice, voiceMix_, 0, grainSize);
+}
+
+void SasInstance::PrepareVoice(SasVoice &voice, VoiceMix &mix) {
+	mix.delay = 0;
+	mix.count = 0;
+
 	switch (voice.type) {
 	case VOICETYPE_VAG:
 		if (voice.type == VOICETYPE_VAG && !voice.vagAddr)
@@ -499,25 +732,24 @@ void SasInstance::MixVoice(SasVoice &voice) {
 
 		// Resample to the correct pitch, writing exactly "grainSize" samples. We need a buffer that can
 		// fit 4x that, as the max pitch is 0x4000.
-		// TODO: Special case no-resample case (and 2x and 0.5x) for speed, it's not uncommon
 
 		// Two passes: First read, then resample.
-		mixTemp_[0] = voice.resampleHist[0];
-		mixTemp_[1] = voice.resampleHist[1];
+		mix.mixTemp[0] = voice.resampleHist[0];
+		mix.mixTemp[1] = voice.resampleHist[1];
 
 		int voicePitch = voice.pitch;
 		u32 sampleFrac = voice.sampleFrac;
 		int samplesToRead = (sampleFrac + voicePitch * std::max(0, grainSize - delay)) >> PSP_SAS_PITCH_BASE_SHIFT;
-		if (samplesToRead > ARRAY_SIZE(mixTemp_) - 2) {
+		if (samplesToRead > (int)mix.mixTemp.size() - 2) {
 			ERROR_LOG(SCESAS, "Too many samples to read (%d)! This shouldn't happen.", samplesToRead);
-			samplesToRead = ARRAY_SIZE(mixTemp_) - 2;
+			samplesToRead = (int)mix.mixTemp.size() - 2;
 		}
 		int readPos = 2;
 		if (voice.envelope.NeedsKeyOn()) {
 			readPos = 0;
 			samplesToRead += 2;
 		}
-		voice.ReadSamples(&mixTemp_[readPos], samplesToRead);
+		voice.ReadSamples(&mix.mixTemp[readPos], samplesToRead);
 		int tempPos = readPos + samplesToRead;
 
 		for (int i = 0; i < delay; ++i) {
@@ -526,39 +758,26 @@ void SasInstance::MixVoice(SasVoice &voice) {
 			voice.envelope.Step();
 		}
 
-		const bool needsInterp = voicePitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
-		for (int i = delay; i < grainSize; i++) {
-			const s16_le *s = mixTemp_ + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
-
+		const int count = grainSize - delay;
+		if (count > 0) {
 			// Linear interpolation. Good enough. Need to make resampleHist bigger if we want more.
-			int sample = s[0];
-			if (needsInterp) {
-				int f = sampleFrac & PSP_SAS_PITCH_MASK;
-				sample = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
+			SasResample(mix.samples.data(), mix.mixTemp.data(), tempPos, sampleFrac, voicePitch, count);
+			sampleFrac += voicePitch * count;
+
+			for (int i = 0; i < count; ++i) {
+				// The maximum envelope height (PSP_SAS_ENVELOPE_HEIGHT_MAX) is (1 << 30) - 1.
+				// Reduce it to 14 bits, by shifting off 15.  Round up by adding (1 << 14) first.
+				int envelopeValue = voice.envelope.GetHeight();
+				voice.envelope.Step();
+				mix.envelope[i] = (envelopeValue + (1 << 14)) >> 15;
 			}
-			sampleFrac += voicePitch;
-
-			// The maximum envelope height (PSP_SAS_ENVELOPE_HEIGHT_MAX) is (1 << 30) - 1.
-			// Reduce it to 14 bits, by shifting off 15.  Round up by adding (1 << 14) first.
-			int envelopeValue = voice.envelope.GetHeight();
-			voice.envelope.Step();
-			envelopeValue = (envelopeValue + (1 << 14)) >> 15;
-
-			// We just scale by the envelope before we scale by volumes.
-			// Again, we round up by adding (1 << 14) first (*after* multiplying.)
-			sample = ((sample * envelopeValue) + (1 << 14)) >> 15;
 
-			// We mix into this 32-bit temp buffer and clip in a second loop
-			// Ideally, the shift right should be there too but for now I'm concerned about
-			// not overflowing.
-			mixBuffer[i * 2] += (sample * voice.volumeLeft) >> 12;
-			mixBuffer[i * 2 + 1] += (sample * voice.volumeRight) >> 12;
-			sendBuffer[i * 2] += sample * voice.effectLeft >> 12;
-			sendBuffer[i * 2 + 1] += sample * voice.effectRight >> 12;
+			mix.delay = delay;
+			mix.count = count;
 		}
 
-		voice.resampleHist[0] = mixTemp_[tempPos - 2];
-		voice.resampleHist[1] = mixTemp_[tempPos - 1];
+		voice.resampleHist[0] = mix.mixTemp[tempPos - 2];
+		voice.resampleHist[1] = mix.mixTemp[tempPos - 1];
 
 		voice.sampleFrac = sampleFrac - (tempPos - 2) * PSP_SAS_PITCH_BASE;
 
@@ -572,15 +791,73 @@ void SasInstance::MixVoice(SasVoice &voice) {
 	}
 }
 
+void SasInstance::MixPreparedVoice(const SasVoice &voice, const VoiceMix &mix, int start, int end) {
+	start = std::max(start, mix.delay);
+	end = std::min(end, mix.delay + mix.count);
+	if (start >= end)
+		return;
+
+	const int offset = start - mix.delay;
+	SasMixScaled(mixBuffer + start * 2, sendBuffer + start * 2, mix.samples.data() + offset, mix.envelope.data() + offset, end - start, voice.volumeLeft, voice.volumeRight, voice.effectLeft, voice.effectRight);
+}
+
+void SasInstance::MixVoicesParallel(const int *voiceIndices, int count) {
+	if ((int)voiceMixes_.size() < count) {
+		voiceMixes_.resize(count);
+	}
+	for (int i = 0; i < count; ++i) {
+		voiceMixes_[i].Resize(grainSize);
+	}
+
+	// Voices only share the output buffers, so decode and resample them separately.
+	// The pool may be busy with GPU work, and waiting on that would risk underruns, so mix here instead.
+	auto prepare = [&](int lower, int upper) {
+		for (int i = lower; i < upper; ++i) {
+			PrepareVoice(voices[voiceIndices[i]], voiceMixes_[i]);
+		}
+	};
+	if (!GlobalThreadPool::TryLoop(prepare, 0, count))
+		prepare(0, count);
+
+	// Then split the grain instead, and add each voice in order, so the result never changes.
+	const int blocks = (grainSize + SAS_MIX_BLOCK_SIZE - 1) / SAS_MIX_BLOCK_SIZE;
+	auto mix = [&](int lower, int upper) {
+		const int start = lower * SAS_MIX_BLOCK_SIZE;
+		const int end = std::min(upper * SAS_MIX_BLOCK_SIZE, grainSize);
+		for (int i = 0; i < count; ++i) {
+			MixPreparedVoice(voices[voiceIndices[i]], voiceMixes_[i], start, end);
+		}
+	};
+	if (!GlobalThreadPool::TryLoop(mix, 0, blocks))
+		mix(0, blocks);
+}
+
 void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
 	int voicesPlayingCount = 0;
+	int parallelVoices[PSP_SAS_VOICES_MAX];
+	int parallelCount = 0;
+	const bool allowParallel = g_Config.iNumWorkerThreads > 1;
 
 	for (int v = 0; v < PSP_SAS_VOICES_MAX; v++) {
 		SasVoice &voice = voices[v];
 		if (!voice.playing || voice.paused)
 			continue;
 		voicesPlayingCount++;
-		MixVoice(voice);
+		// ATRAC3 decoding goes through sceAtrac, which isn't safe to run in parallel, and PCM reads
+		// go through Memory::Memcpy, which may trigger memchecks.  Only VAG runs on other threads.
+		if (allowParallel && voice.type == VOICETYPE_VAG) {
+			parallelVoices[parallelCount++] = v;
+		} else {
+			MixVoice(voice);
+		}
+	}
+
+	if (parallelCount >= SAS_PARALLEL_MIN_VOICES) {
+		MixVoicesParallel(parallelVoices, parallelCount);
+	} else {
+		for (int i = 0; i < parallelCount; ++i) {
+			MixVoice(voices[parallelVoices[i]]);
+		}
 	}
 
 	// Then mix the send buffer in with the rest.
@@ -677,14 +954,9 @@ void SasInstance::SetWaveformEffectType(int type) {
 // See http://report.ppsspp.org/logs/kind/772 for a list of games that use different types. Maybe can help us figure out
 // which is which.
 void SasInstance::ApplyWaveformEffect() {
-	// First, downsample the send buffer to 22khz. We do this naively for now.
-	for (int i = 0; i < grainSize / 2; i++) {
-		sendBufferDownsampled[i * 2] = clamp_s16(sendBuffer[i * 4]);
-		sendBufferDownsampled[i * 2 + 1] = clamp_s16(sendBuffer[i * 4 + 1]);
-	}
-
+	// The reverb downsamples the send buffer to 22khz itself, naively for now.
 	// Volume max is 0x1000, while our factor is up to 0x8000. Shifting right by 3 fixes that.
-	reverb_.ProcessReverb(sendBufferProcessed, sendBufferDownsampled, grainSize / 2, waveformEffect.leftVol << 3, waveformEffect.rightVol << 3);
+	reverb_.ProcessReverb(sendBufferProcessed, sendBuffer, grainSize / 2, waveformEffect.leftVol << 3, waveformEffect.rightVol << 3);
 }
 
 void SasInstance::DoState(PointerWrap &p) {
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/HW/BufferQueue.h"
 #include "Core/HW/SasReverb.h"
@@ -272,6 +274,13 @@ struct SasVoice {
 	SasAtrac3 atrac3;
 };
 
+// Resamples count samples from src (srcSize valid samples) by linear interpolation, starting
+// at sampleFrac and stepping by pitch, both in 1/PSP_SAS_PITCH_BASE sample units.
+void SasResample(int *out, const s16_le *src, int srcSize, u32 sampleFrac, int pitch, int count);
+// Scales samples by their (15-bit) envelope values, then adds them with the given volumes to the
+// interleaved stereo mix and send buffers.
+void SasMixScaled(int *mixBuffer, int *sendBuffer, const int *samples, const int *envelope, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight);
+
 class SasInstance {
 public:
 	SasInstance();
@@ -288,7 +297,6 @@ public:
 
 	int *mixBuffer;
 	int *sendBuffer;
-	s16 *sendBufferDownsampled;
 	s16 *sendBufferProcessed;
 
 	FILE *audioDump;
@@ -309,7 +317,28 @@ public:
 	WaveformEffect waveformEffect;
 
 private:
+	// A voice's decoded, resampled samples and envelope for one grain, ready to mix.
+	// Sized to the grain, since one per voice at the max grain would be about a megabyte.
+	struct VoiceMix {
+		void Resize(int grainSize);
+
+		std::vector<s16_le> mixTemp;  // 4x the grain for the max pitch, plus some extra margin.
+		std::vector<int> samples;
+		std::vector<int> envelope;
+		// Output samples [delay, delay + count) are produced.
+		int delay = 0;
+		int count = 0;
+	};
+
+	// Only touches the voice and mix, so different voices can be prepared in parallel.
+	void PrepareVoice(SasVoice &voice, VoiceMix &mix);
+	// Mixes output samples [start, end) of a prepared voice into mixBuffer/sendBuffer.
+	void MixPreparedVoice(const SasVoice &voice, const VoiceMix &mix, int start, int end);
+	void MixVoicesParallel(const int *voiceIndices, int count);
+
 	SasReverb reverb_;
 	int grainSize;
-	s16_le mixTemp_[PSP_SAS_MAX_GRAIN * 4 + 2 + 8];  // some extra margin for very high pitches.
+	VoiceMix voiceMix_;
+	// One per voice mixed in parallel, grown as needed.
+	std::vector<VoiceMix> voiceMixes_;
 };
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
@@ -151,7 +152,7 @@ static const SasReverbData presets[10] = {
 	},
 };
 
-SasReverb::SasReverb() : preset_(-1), pos_(0) {
+SasReverb::SasReverb() : preset_(-1), pos_(0), minTap_(0), maxTap_(0) {
 	workspace_ = new int16_t[BUFSIZE];
 }
 
@@ -166,12 +167,30 @@ const char *SasReverb::GetPresetName(int preset) {
 	return presets[preset].name;
 }
 
+// The range of offsets from the current position that a preset reads or writes.
+static void GetTapRange(const SasReverbData &d, int *minTap, int *maxTap) {
+	const int taps[] = {
+		d.mLSAME, d.mRSAME, d.mLSAME - 1, d.mRSAME - 1, d.dLSAME, d.dRSAME,
+		d.mLDIFF, d.mRDIFF, d.mLDIFF - 1, d.mRDIFF - 1, d.dLDIFF, d.dRDIFF,
+		d.mLCOMB1, d.mRCOMB1, d.mLCOMB2, d.mRCOMB2, d.mLCOMB3, d.mRCOMB3, d.mLCOMB4, d.mRCOMB4,
+		d.mLAPF1, d.mRAPF1, d.mLAPF1 - d.dAPF1, d.mRAPF1 - d.dAPF1,
+		d.mLAPF2, d.mRAPF2, d.mLAPF2 - d.dAPF2, d.mRAPF2 - d.dAPF2,
+	};
+	*minTap = taps[0];
+	*maxTap = taps[0];
+	for (int tap : taps) {
+		*minTap = std::min(*minTap, tap);
+		*maxTap = std::max(*maxTap, tap);
+	}
+}
+
 void SasReverb::SetPreset(int preset) {
 	if (preset < (int)ARRAY_SIZE(presets))
 		preset_ = preset;
 	if (preset_ != -1) {
 		pos_ = BUFSIZE - presets[preset_].size;
 		memset(workspace_, 0, sizeof(int16_t) * BUFSIZE);
+		GetTapRange(presets[preset_], &minTap_, &maxTap_);
 	} else {
 		pos_ = 0;
 	}
@@ -205,65 +224,126 @@ private:
 	int size_;
 };
 
-void SasReverb::ProcessReverb(int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight) {
+// Same interface, but for stretches where no tap can cross either end of the buffer.
+class LinearBufferWrapper {
+public:
+	LinearBufferWrapper(int16_t *buffer, int position) : ptr_(buffer + position) {}
+	int16_t &operator [](int index) {
+		return ptr_[index];
+	}
+
+	void Next() {
+		ptr_++;
+	}
+
+private:
+	int16_t *ptr_;
+};
+
+template <typename B>
+inline void ReverbSample(B &b, const SasReverbData &d, int16_t *output, const int32_t *input, uint16_t volLeft, uint16_t volRight) {
+	// Dividing by two here is an incorrect hack. Some multiplication factor is needed to prevent the reverb from getting too loud, though.
+	// The input is at 44khz, we just take every other sample (that's the downsample.)
+	int16_t LeftInput = clamp_s16(input[0]) >> 1;
+	int16_t RightInput = clamp_s16(input[1]) >> 1;
+
+	int16_t Lin = LeftInput; //  (d.vLIN * LeftInput) >> 15;
+	int16_t Rin = RightInput; // (d.vRIN * RightInput) >> 15;
+
+	// Note that the left and right sides can't be run side by side, since some presets have them read what the other just wrote.
+	// ____Same Side Reflection(left - to - left and right - to - right)___________________
+	b[d.mLSAME] = clamp_s16(Lin + (b[d.dLSAME] * d.vWALL >> 15) - (b[d.mLSAME - 1]*d.vIIR >> 15) + b[d.mLSAME - 1]); // L - to - L
+	b[d.mRSAME] = clamp_s16(Rin + (b[d.dRSAME] * d.vWALL >> 15) - (b[d.mRSAME - 1]*d.vIIR >> 15) + b[d.mRSAME - 1]); // R - to - R
+	// ___Different Side Reflection(left - to - right and right - to - left)_______________
+	b[d.mLDIFF] = clamp_s16(Lin + (b[d.dRDIFF] * d.vWALL >> 15) - (b[d.mLDIFF - 1]*d.vIIR >> 15) + b[d.mLDIFF - 1]); // R - to - L
+	b[d.mRDIFF] = clamp_s16(Rin + (b[d.dLDIFF] * d.vWALL >> 15) - (b[d.mRDIFF - 1]*d.vIIR >> 15) + b[d.mRDIFF - 1]); // L - to - R
+	// ___Early Echo(Comb Filter, with input from buffer)__________________________
+	int32_t Lout = ((d.vCOMB1*b[d.mLCOMB1] + d.vCOMB2*b[d.mLCOMB2] + d.vCOMB3*b[d.mLCOMB3] + d.vCOMB4*b[d.mLCOMB4]) >> 15);
+	int32_t Rout = ((d.vCOMB1*b[d.mRCOMB1] + d.vCOMB2*b[d.mRCOMB2] + d.vCOMB3*b[d.mRCOMB3] + d.vCOMB4*b[d.mRCOMB4]) >> 15);
+	// ___Late Reverb APF1(All Pass Filter 1, with input from COMB)________________
+	b[d.mLAPF1] = clamp_s16(Lout - (d.vAPF1*b[(d.mLAPF1 - d.dAPF1)] >> 15));
+	Lout = b[(d.mLAPF1 - d.dAPF1)] + (b[d.mLAPF1] * d.vAPF1 >> 15);
+	b[d.mRAPF1] = clamp_s16(Rout - (d.vAPF1*b[(d.mRAPF1 - d.dAPF1)] >> 15));
+	Rout = b[(d.mRAPF1 - d.dAPF1)] + (b[d.mRAPF1] * d.vAPF1 >> 15);
+	// ___Late Reverb APF2(All Pass Filter 2, with input from APF1)________________
+	b[d.mLAPF2] = clamp_s16(Lout - (d.vAPF2*b[(d.mLAPF2 - d.dAPF2)] >> 15));
+	Lout = b[(d.mLAPF2 - d.dAPF2)] + (b[d.mLAPF2] * d.vAPF2 >> 15);
+	b[d.mRAPF2] = clamp_s16(Rout - (d.vAPF2*b[(d.mRAPF2 - d.dAPF2)] >> 15));
+	Rout = b[(d.mRAPF2 - d.dAPF2)] + (b[d.mRAPF2] * d.vAPF2 >> 15);
+	// ___Output to Mixer(Output volume multiplied with input from APF2)___________
+	// The upsample back to 44khz is just zero stuffing.
+	output[0] = clamp_s16(Lout * volLeft >> 15);
+	output[1] = clamp_s16(Rout * volRight >> 15);
+	output[2] = 0;
+	output[3] = 0;
+}
+
+// Instantiated per preset, so the offsets and coefficients are constants (and the zero ones drop out.)
+template <int preset>
+static int ProcessPreset(int16_t *workspace, int pos, int minTap, int maxTap, int16_t *output, const int32_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight) {
+	const SasReverbData &d = presets[preset];
+	const int end = SasReverb::BUFSIZE;
+	const int base = SasReverb::BUFSIZE - d.size;
+
+	size_t i = 0;
+	while (i < inputSize) {
+		// Positions where every tap lands inside the buffer can skip the wrapping entirely.
+		if (pos + minTap >= base && pos + maxTap < end) {
+			size_t count = std::min(inputSize - i, (size_t)(end - maxTap - pos));
+			LinearBufferWrapper b(workspace, pos);
+			for (size_t j = 0; j < count; ++j) {
+				ReverbSample(b, d, output + (i + j) * 4, input + (i + j) * 4, volLeft, volRight);
+				b.Next();
+			}
+			i += count;
+			pos += (int)count;
+		} else {
+			BufferWrapper<SasReverb::BUFSIZE> b(workspace, pos, d.size);
+			ReverbSample(b, d, output + i * 4, input + i * 4, volLeft, volRight);
+			b.Next();
+			pos = b.GetPosition();
+			i++;
+		}
+	}
+	return pos;
+}
+
+typedef int (*ReverbPresetFunc)(int16_t *workspace, int pos, int minTap, int maxTap, int16_t *output, const int32_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight);
+
+static const ReverbPresetFunc presetFuncs[] = {
+	&ProcessPreset<0>,
+	&ProcessPreset<1>,
+	&ProcessPreset<2>,
+	&ProcessPreset<3>,
+	&ProcessPreset<4>,
+	&ProcessPreset<5>,
+	&ProcessPreset<6>,
+	&ProcessPreset<7>,
+	&ProcessPreset<8>,
+};
+
+void SasReverb::ProcessReverb(int16_t *output, const int32_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight) {
 	// This means replicate the input signal in the processed buffer.
 	// Can also be used to verify that the error is in here...
 	if (preset_ == -1) {
 		// Strangely, OFF is not filled with zeroes every other.  Seems special cased.
 		for (size_t i = 0; i < inputSize; ++i) {
-			output[i * 4 + 0] = clamp_s16((int)input[i * 2 + 0] * volLeft >> 15);
-			output[i * 4 + 1] = clamp_s16((int)input[i * 2 + 1] * volRight >> 15);
-			output[i * 4 + 2] = clamp_s16((int)input[i * 2 + 0] * volLeft >> 15);
-			output[i * 4 + 3] = clamp_s16((int)input[i * 2 + 1] * volRight >> 15);
+			int16_t left = clamp_s16((int)clamp_s16(input[i * 4 + 0]) * volLeft >> 15);
+			int16_t right = clamp_s16((int)clamp_s16(input[i * 4 + 1]) * volRight >> 15);
+			output[i * 4 + 0] = left;
+			output[i * 4 + 1] = right;
+			output[i * 4 + 2] = left;
+			output[i * 4 + 3] = right;
 		}
 		return;
 	}
 
-	const SasReverbData &d = presets[preset_];
-
-	// We put this on the stack instead of in the object to let the compiler optimize better (avoid mem r/w).
-	BufferWrapper<BUFSIZE> b(workspace_, pos_, d.size);
-
-	// This runs at 22khz.
-	// Very unoptimized, straight from the description. Can probably be reformulated into something way more efficient.
-	// Or we could actually template the whole thing with the parameters as template arguments, as the presets are fixed.
-	for (size_t i = 0; i < inputSize; i++) {
-		// Dividing by two here is an incorrect hack. Some multiplication factor is needed to prevent the reverb from getting too loud, though.
-		int16_t LeftInput = input[i * 2] >> 1;
-		int16_t RightInput = input[i * 2 + 1] >> 1;
-
-		int16_t Lin = LeftInput; //  (d.vLIN * LeftInput) >> 15;
-		int16_t Rin = RightInput; // (d.vRIN * RightInput) >> 15;
-
-		// ____Same Side Reflection(left - to - left and right - to - right)___________________
-		b[d.mLSAME] = clamp_s16(Lin + (b[d.dLSAME] * d.vWALL >> 15) - (b[d.mLSAME - 1]*d.vIIR >> 15) + b[d.mLSAME - 1]); // L - to - L
-		b[d.mRSAME] = clamp_s16(Rin + (b[d.dRSAME] * d.vWALL >> 15) - (b[d.mRSAME - 1]*d.vIIR >> 15) + b[d.mRSAME - 1]); // R - to - R
-		// ___Different Side Reflection(left - to - right and right - to - left)_______________
-		b[d.mLDIFF] = clamp_s16(Lin + (b[d.dRDIFF] * d.vWALL >> 15) - (b[d.mLDIFF - 1]*d.vIIR >> 15) + b[d.mLDIFF - 1]); // R - to - L
-		b[d.mRDIFF] = clamp_s16(Rin + (b[d.dLDIFF] * d.vWALL >> 15) - (b[d.mRDIFF - 1]*d.vIIR >> 15) + b[d.mRDIFF - 1]); // L - to - R
-		// ___Early Echo(Comb Filter, with input from buffer)__________________________
-		int32_t Lout = ((d.vCOMB1*b[d.mLCOMB1] + d.vCOMB2*b[d.mLCOMB2] + d.vCOMB3*b[d.mLCOMB3] + d.vCOMB4*b[d.mLCOMB4]) >> 15);
-		int32_t Rout = ((d.vCOMB1*b[d.mRCOMB1] + d.vCOMB2*b[d.mRCOMB2] + d.vCOMB3*b[d.mRCOMB3] + d.vCOMB4*b[d.mRCOMB4]) >> 15);
-		// ___Late Reverb APF1(All Pass Filter 1, with input from COMB)________________
-		b[d.mLAPF1] = clamp_s16(Lout - (d.vAPF1*b[(d.mLAPF1 - d.dAPF1)] >> 15));
-		Lout = b[(d.mLAPF1 - d.dAPF1)] + (b[d.mLAPF1] * d.vAPF1 >> 15);
-		b[d.mRAPF1] = clamp_s16(Rout - (d.vAPF1*b[(d.mRAPF1 - d.dAPF1)] >> 15));
-		Rout = b[(d.mRAPF1 - d.dAPF1)] + (b[d.mRAPF1] * d.vAPF1 >> 15);
-		// ___Late Reverb APF2(All Pass Filter 2, with input from APF1)________________
-		b[d.mLAPF2] = clamp_s16(Lout - (d.vAPF2*b[(d.mLAPF2 - d.dAPF2)] >> 15));
-		Lout = b[(d.mLAPF2 - d.dAPF2)] + (b[d.mLAPF2] * d.vAPF2 >> 15);
-		b[d.mRAPF2] = clamp_s16(Rout - (d.vAPF2*b[(d.mRAPF2 - d.dAPF2)] >> 15));
-		Rout = b[(d.mRAPF2 - d.dAPF2)] + (b[d.mRAPF2] * d.vAPF2 >> 15);
-		// ___Output to Mixer(Output volume multiplied with input from APF2)___________
-		output[i * 4 + 0] = clamp_s16(Lout * volLeft >> 15);
-		output[i * 4 + 1] = clamp_s16(Rout * volRight >> 15);
-		output[i * 4 + 2] = 0;
-		output[i * 4 + 3] = 0;
-
-		b.Next();
+	if (preset_ >= (int)ARRAY_SIZE(presetFuncs)) {
+		// Past the last known type, there's nothing to run.
+		memset(output, 0, sizeof(int16_t) * inputSize * 4);
+		return;
 	}
 
-	// Save the state in the object.
-	pos_ = b.GetPosition();
+	// This runs at 22khz.
+	pos_ = presetFuncs[preset_](workspace_, pos_, minTap_, maxTap_, output, input, inputSize, volLeft, volRight);
 }
-
@@ -29,16 +29,19 @@ public:
 
 	static const char *GetPresetName(int preset);
 
-	// Input should be a mixdown of all the channels that have reverb enabled, at 22khz.
-	// Output is written back at 44khz.
-	void ProcessReverb(int16_t *output, const int16_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight);
+	// Input should be a mixdown of all the channels that have reverb enabled, at 44khz (stereo, unclamped.)
+	// It's downsampled to 22khz on the fly, so inputSize is in 22khz samples. Output is written back at 44khz.
+	void ProcessReverb(int16_t *output, const int32_t *input, size_t inputSize, uint16_t volLeft, uint16_t volRight);
 
-private:
 	enum {
 		BUFSIZE = 0x20000,
 	};
 
+private:
 	int16_t *workspace_;
 	int preset_;
 	int pos_;
+	// Offsets of the lowest and highest taps of the current preset, relative to pos_.
+	int minTap_;
+	int maxTap_;
 };
\ No newline at end of file
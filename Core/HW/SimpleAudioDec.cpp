@@ -23,6 +23,7 @@
 #include "Core/HW/SimpleAudioDec.h"
 #include "Core/HW/MediaEngine.h"
 #include "Core/HW/BufferQueue.h"
+#include "Core/Util/AudioFormat.h"
 
 #ifdef USE_FFMPEG
 
@@ -204,6 +205,15 @@ bool SimpleAudio::Decode(void *inbuf, int inbytes, uint8_t *outbuf, int *outbyte
 	srcPos = len;
 
 	if (got_frame) {
+		// ATRAC3, ATRAC3+ and AAC decode to planar float. When there's nothing to resample or
+		// remix, we can interleave directly and skip swresample's per-frame overhead.
+		if (codecCtx_->sample_fmt == AV_SAMPLE_FMT_FLTP && codecCtx_->channels == 2 && frame_->sample_rate == wanted_resample_freq) {
+			ConvertPlanarF32ToS16Stereo((s16 *)outbuf, (const float *)frame_->extended_data[0], (const float *)frame_->extended_data[1], frame_->nb_samples);
+			outSamples = frame_->nb_samples * 2;
+			*outbytes = outSamples * 2;
+			return true;
+		}
+
 		// Initializing the sample rate convert. We will use it to convert float output into int.
 		int64_t wanted_channel_layout = AV_CH_LAYOUT_STEREO; // we want stereo output layout
 		int64_t dec_channel_layout = frame_->channel_layout; // decoded channel layout
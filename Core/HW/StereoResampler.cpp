@@ -25,13 +25,30 @@
 
 #define TARGET_BUFSIZE_MARGIN 512
 
-#define TARGET_BUFSIZE_DEFAULT 1680 // 40 ms
+#define TARGET_BUFSIZE_MIN 256
 #define TARGET_BUFSIZE_EXTRA 3360 // 80 ms
 
+// When we underrun, the target grows by this much, and shrinks back slowly once things are stable.
+#define TARGET_BOOST_STEP 256
+#define TARGET_BOOST_DECAY_SECONDS 30
+
 #define MAX_FREQ_SHIFT  600.0f  // how far off can we be from 44100 Hz
 #define CONTROL_FACTOR  0.2f // in freq_shift per fifo size offset
+#define CONTROL_INTEGRAL 0.01f // in freq_shift per fifo size offset per second, removes the steady state offset
 #define CONTROL_AVG     32.0f
 
+// Windowed sinc filter for the resampling. Taps must be a multiple of 4 for the SIMD paths.
+#define RESAMPLE_TAPS 16
+#define RESAMPLE_PHASE_BITS 8
+#define RESAMPLE_PHASES (1 << RESAMPLE_PHASE_BITS)
+#define RESAMPLE_COEF_SHIFT 14
+#define RESAMPLE_KAISER_BETA 5.0
+// Near 1:1 there's nothing to band limit, so a short cubic kernel is enough, and much cheaper.
+#define RESAMPLE_SHORT_TAPS 4
+#define RESAMPLE_SHORT_MAX_RATIO_DIFF 0x800  // about 3%, comfortably more than the rate control's range
+
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <atomic>
 
@@ -60,9 +77,12 @@
 
 StereoResampler::StereoResampler()
 		: m_maxBufsize(MAX_BUFSIZE_DEFAULT)
-	  , m_targetBufsize(TARGET_BUFSIZE_DEFAULT) {
+	  , m_targetBufsize(TARGET_BUFSIZE_MIN) {
 	// Need to have space for the worst case in case it changes.
-	m_buffer = new int16_t[MAX_BUFSIZE_EXTRA * 2]();
+	// The start of the buffer is mirrored after the end, so the filter can always read its taps in one go.
+	m_buffer = new int16_t[MAX_BUFSIZE_EXTRA * 2 + RESAMPLE_TAPS * 2]();
+	m_coefs = new int16_t[RESAMPLE_PHASES * RESAMPLE_TAPS * 2];
+	m_shortCoefs = new int16_t[RESAMPLE_PHASES * RESAMPLE_SHORT_TAPS * 2];
 
 	// Some Android devices are v-synced to non-60Hz framerates. We simply timestretch audio to fit.
 	// TODO: should only do this if auto frameskip is off?
@@ -76,11 +96,135 @@ StereoResampler::StereoResampler()
 	}
 
 	UpdateBufferSize();
+	BuildFilter(44100);
+	BuildShortFilter();
 }
 
 StereoResampler::~StereoResampler() {
 	delete[] m_buffer;
+	delete[] m_coefs;
+	delete[] m_shortCoefs;
 	m_buffer = nullptr;
+	m_coefs = nullptr;
+	m_shortCoefs = nullptr;
+}
+
+static double BesselI0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+// Builds the polyphase table: for each phase, RESAMPLE_TAPS coefficients, each stored twice (for left and right.)
+void StereoResampler::BuildFilter(int outputSampleRate) {
+	// When the output rate is lower, we need to cut off earlier to avoid aliasing.
+	// Otherwise leave some room for the transition band below the input Nyquist.
+	m_cutoff = 0.9 * std::min(1.0, (double)outputSampleRate / (double)m_input_sample_rate);
+	m_filterSampleRate = outputSampleRate;
+
+	const double halfWidth = RESAMPLE_TAPS / 2;
+	const double windowScale = 1.0 / BesselI0(RESAMPLE_KAISER_BETA);
+	for (int phase = 0; phase < RESAMPLE_PHASES; ++phase) {
+		double frac = (double)phase / RESAMPLE_PHASES;
+		double taps[RESAMPLE_TAPS];
+		double sum = 0.0;
+		for (int i = 0; i < RESAMPLE_TAPS; ++i) {
+			// The output sample lies between taps RESAMPLE_TAPS / 2 - 1 and RESAMPLE_TAPS / 2.
+			double x = (double)(i - (RESAMPLE_TAPS / 2 - 1)) - frac;
+			double sinc = x == 0.0 ? 1.0 : sin(M_PI * m_cutoff * x) / (M_PI * m_cutoff * x);
+			double t = x / halfWidth;
+			double window = t * t >= 1.0 ? 0.0 : BesselI0(RESAMPLE_KAISER_BETA * sqrt(1.0 - t * t)) * windowScale;
+			taps[i] = sinc * window;
+			sum += taps[i];
+		}
+
+		// Normalize so each phase has exactly unity gain, otherwise we'd get a hum at the phase rate.
+		int16_t *coefs = m_coefs + phase * RESAMPLE_TAPS * 2;
+		int total = 0;
+		for (int i = 0; i < RESAMPLE_TAPS; ++i) {
+			int c = (int)floor(taps[i] / sum * (1 << RESAMPLE_COEF_SHIFT) + 0.5);
+			coefs[i * 2] = c;
+			total += c;
+		}
+		coefs[(RESAMPLE_TAPS / 2 - 1 + (phase >= RESAMPLE_PHASES / 2 ? 1 : 0)) * 2] += (1 << RESAMPLE_COEF_SHIFT) - total;
+		for (int i = 0; i < RESAMPLE_TAPS; ++i) {
+			coefs[i * 2 + 1] = coefs[i * 2];
+		}
+	}
+}
+
+// Catmull-Rom cubic, in the same layout as the long filter.  Doesn't depend on the rates.
+void StereoResampler::BuildShortFilter() {
+	for (int phase = 0; phase < RESAMPLE_PHASES; ++phase) {
+		double t = (double)phase / RESAMPLE_PHASES;
+		double taps[RESAMPLE_SHORT_TAPS] = {
+			0.5 * (-t * t * t + 2.0 * t * t - t),
+			0.5 * (3.0 * t * t * t - 5.0 * t * t + 2.0),
+			0.5 * (-3.0 * t * t * t + 4.0 * t * t + t),
+			0.5 * (t * t * t - t * t),
+		};
+
+		int16_t *coefs = m_shortCoefs + phase * RESAMPLE_SHORT_TAPS * 2;
+		int total = 0;
+		for (int i = 0; i < RESAMPLE_SHORT_TAPS; ++i) {
+			int c = (int)floor(taps[i] * (1 << RESAMPLE_COEF_SHIFT) + 0.5);
+			coefs[i * 2] = c;
+			total += c;
+		}
+		coefs[(phase >= RESAMPLE_PHASES / 2 ? 2 : 1) * 2] += (1 << RESAMPLE_COEF_SHIFT) - total;
+		for (int i = 0; i < RESAMPLE_SHORT_TAPS; ++i) {
+			coefs[i * 2 + 1] = coefs[i * 2];
+		}
+	}
+}
+
+// Filters "taps" interleaved stereo frames into one.
+template <int taps>
+inline void ResampleFrame(short *out, const int16_t *in, const int16_t *coefs) {
+	static_assert((taps & 3) == 0, "Taps must be a multiple of 4");
+#ifdef _M_SSE
+	__m128i acc = _mm_setzero_si128();
+	for (int i = 0; i < taps * 2; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(in + i));
+		__m128i c = _mm_loadu_si128((const __m128i *)(coefs + i));
+		__m128i lo = _mm_mullo_epi16(s, c);
+		__m128i hi = _mm_mulhi_epi16(s, c);
+		// These come out as L, R, L, R products in 32 bits.
+		acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(lo, hi));
+		acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(lo, hi));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_srai_epi32(_mm_add_epi32(acc, _mm_set1_epi32(1 << (RESAMPLE_COEF_SHIFT - 1))), RESAMPLE_COEF_SHIFT);
+	u32 result = (u32)_mm_cvtsi128_si32(_mm_packs_epi32(acc, acc));
+	memcpy(out, &result, sizeof(result));
+#elif PPSSPP_ARCH(ARM_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for (int i = 0; i < taps * 2; i += 8) {
+		int16x8_t s = vld1q_s16(in + i);
+		int16x8_t c = vld1q_s16(coefs + i);
+		acc = vmlal_s16(acc, vget_low_s16(s), vget_low_s16(c));
+		acc = vmlal_s16(acc, vget_high_s16(s), vget_high_s16(c));
+	}
+	int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	int16x4_t result = vqrshrn_n_s32(vcombine_s32(sum, sum), RESAMPLE_COEF_SHIFT);
+	vst1_lane_s16(out, result, 0);
+	vst1_lane_s16(out + 1, result, 1);
+#else
+	int sumL = 0;
+	int sumR = 0;
+	for (int i = 0; i < taps * 2; i += 2) {
+		sumL += in[i] * coefs[i];
+		sumR += in[i + 1] * coefs[i + 1];
+	}
+	out[0] = clamp_s16((sumL + (1 << (RESAMPLE_COEF_SHIFT - 1))) >> RESAMPLE_COEF_SHIFT);
+	out[1] = clamp_s16((sumR + (1 << (RESAMPLE_COEF_SHIFT - 1))) >> RESAMPLE_COEF_SHIFT);
+#endif
 }
 
 void StereoResampler::UpdateBufferSize() {
@@ -89,7 +233,7 @@ void StereoResampler::UpdateBufferSize() {
 		m_targetBufsize = TARGET_BUFSIZE_EXTRA;
 	} else {
 		m_maxBufsize = MAX_BUFSIZE_DEFAULT;
-		m_targetBufsize = TARGET_BUFSIZE_DEFAULT;
+		m_targetBufsize = std::max(TARGET_BUFSIZE_MIN, std::min(MAX_BUFSIZE_DEFAULT - TARGET_BUFSIZE_MARGIN, g_Config.iAudioLatency * 44100 / 1000));
 
 		int systemBufsize = System_GetPropertyInt(SYSPROP_AUDIO_FRAMES_PER_BUFFER);
 		if (systemBufsize > 0 && m_targetBufsize < systemBufsize + TARGET_BUFSIZE_MARGIN) {
@@ -100,46 +244,6 @@ void StereoResampler::UpdateBufferSize() {
 	}
 }
 
-template<bool useShift>
-inline void ClampBufferToS16(s16 *out, const s32 *in, size_t size, s8 volShift) {
-#ifdef _M_SSE
-	// Size will always be 16-byte aligned as the hwBlockSize is.
-	while (size >= 8) {
-		__m128i in1 = _mm_loadu_si128((__m128i *)in);
-		__m128i in2 = _mm_loadu_si128((__m128i *)(in + 4));
-		__m128i packed = _mm_packs_epi32(in1, in2);
-		if (useShift) {
-			packed = _mm_srai_epi16(packed, volShift);
-		}
-		_mm_storeu_si128((__m128i *)out, packed);
-		out += 8;
-		in += 8;
-		size -= 8;
-	}
-#elif PPSSPP_ARCH(ARM_NEON)
-	int16x4_t signedVolShift = vdup_n_s16 (-volShift); // Can only dynamic-shift right, but by a signed integer
-	while (size >= 8) {
-		int32x4_t in1 = vld1q_s32(in);
-		int32x4_t in2 = vld1q_s32(in + 4);
-		int16x4_t packed1 = vqmovn_s32(in1);
-		int16x4_t packed2 = vqmovn_s32(in2);
-		if (useShift) {
-			packed1 = vshl_s16(packed1, signedVolShift);
-			packed2 = vshl_s16(packed2, signedVolShift);
-		}
-		vst1_s16(out, packed1);
-		vst1_s16(out + 4, packed2);
-		out += 8;
-		in += 8;
-		size -= 8;
-	}
-#endif
-	// This does the remainder if SIMD was used, otherwise it does it all.
-	for (size_t i = 0; i < size; i++) {
-		out[i] = clamp_s16(useShift ? (in[i] >> volShift) : in[i]);
-	}
-}
-
 inline void ClampBufferToS16WithVolume(s16 *out, const s32 *in, size_t size) {
 	int volume = g_Config.iGlobalVolume;
 	if (PSP_CoreParameter().fpsLimit != FPSLimit::NORMAL || PSP_CoreParameter().unthrottle) {
@@ -149,16 +253,18 @@ inline void ClampBufferToS16WithVolume(s16 *out, const s32 *in, size_t size) {
 	}
 
 	if (volume >= VOLUME_MAX) {
-		ClampBufferToS16<false>(out, in, size, 0);
+		ClampBufferToS16(out, in, size, 0);
 	} else if (volume <= VOLUME_OFF) {
 		memset(out, 0, size * sizeof(s16));
 	} else {
-		ClampBufferToS16<true>(out, in, size, VOLUME_MAX - (s8)volume);
+		ClampBufferToS16(out, in, size, VOLUME_MAX - (s8)volume);
 	}
 }
 
 void StereoResampler::Clear() {
-	memset(m_buffer, 0, m_maxBufsize * 2 * sizeof(int16_t));
+	memset(m_buffer, 0, (m_maxBufsize * 2 + RESAMPLE_TAPS * 2) * sizeof(int16_t));
+	m_offsetIntegral = 0.0f;
+	primed_ = false;
 }
 
 // Executed from sound stream thread, pulling sound out of the buffer.
@@ -166,8 +272,13 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	if (!samples)
 		return 0;
 
+	double startTime = time_now_d();
 	unsigned int currentSample;
 
+	if (sample_rate != m_filterSampleRate) {
+		BuildFilter(sample_rate);
+	}
+
 	// Cache access in non-volatile variable
 	// This is the only function changing the read value, so it's safe to
 	// cache it locally although it's written here.
@@ -194,51 +305,89 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	// m_numLeftI here becomes a lowpass filtered version of numLeft.
 	m_numLeftI = (numLeft + m_numLeftI * (CONTROL_AVG - 1.0f)) / CONTROL_AVG;
 
-	// Here we try to keep the buffer size around m_lowwatermark (which is
-	// really now more like desired_buffer_size) by adjusting the speed.
-	// Note that the speed of adjustment here does not take the buffer size into
-	// account. Since this is called once per "output frame", the frame size
-	// will affect how fast this algorithm reacts, which can't be a good thing.
-	float offset = (m_numLeftI - (float)m_targetBufsize) * CONTROL_FACTOR;
+	// If we've been underrunning, aim for a fuller buffer than configured.
+	int target = std::min(m_targetBufsize + underrunBoost_, m_maxBufsize - TARGET_BUFSIZE_MARGIN);
+	lastTarget_ = target;
+	if (numLeft >= target)
+		primed_ = true;
+
+	// Here we try to keep the buffer size around the target by adjusting the speed.
+	// The proportional part reacts to changes, the integral part takes care of a constant
+	// rate mismatch (like a display refresh rate that's a bit off), which would otherwise
+	// leave the buffer sitting away from the target.
+	// Note that this is called once per "output frame", so the frame size still affects
+	// how fast the proportional part reacts.
+	float error = m_numLeftI - (float)target;
+	m_offsetIntegral += error * CONTROL_INTEGRAL * (float)numSamples / (float)sample_rate;
+	m_offsetIntegral = clamp_value(m_offsetIntegral, -MAX_FREQ_SHIFT, MAX_FREQ_SHIFT);
+	float offset = error * CONTROL_FACTOR + m_offsetIntegral;
 	if (offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if (offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
 
 	output_sample_rate_ = (float)(m_input_sample_rate + offset);
 	const u32 ratio = (u32)(65536.0 * output_sample_rate_ / (double)sample_rate);
 	ratio_ = ratio;
-	// TODO: consider a higher-quality resampling algorithm.
-	// TODO: Add a fast path for 1:1.
 	u32 frac = m_frac;
-	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
-		if (((indexW - indexR) & INDEX_MASK) <= 2) {
-			// Ran out!
-			// int missing = numSamples * 2 - currentSample;
-			// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
-			underrunCount_++;
-			break;
+	useShortFilter_ = (int)ratio >= 0x10000 - RESAMPLE_SHORT_MAX_RATIO_DIFF && (int)ratio <= 0x10000 + RESAMPLE_SHORT_MAX_RATIO_DIFF;
+	if (useShortFilter_) {
+		// Line the short kernel up with the middle of the long one, so switching doesn't shift the timing.
+		const int offset = (RESAMPLE_TAPS - RESAMPLE_SHORT_TAPS) / 2 * 2;
+		for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
+			if (((indexW - indexR) & INDEX_MASK) < RESAMPLE_TAPS * 2) {
+				underrunCount_++;
+				break;
+			}
+			const int16_t *coefs = m_shortCoefs + (frac >> (16 - RESAMPLE_PHASE_BITS)) * RESAMPLE_SHORT_TAPS * 2;
+			ResampleFrame<RESAMPLE_SHORT_TAPS>(&samples[currentSample], &m_buffer[(indexR & INDEX_MASK) + offset], coefs);
+			frac += ratio;
+			indexR += 2 * (frac >> 16);
+			frac &= 0xffff;
+		}
+	} else {
+		for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
+			if (((indexW - indexR) & INDEX_MASK) < RESAMPLE_TAPS * 2) {
+				// Ran out!
+				// int missing = numSamples * 2 - currentSample;
+				// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
+				underrunCount_++;
+				break;
+			}
+			const int16_t *coefs = m_coefs + (frac >> (16 - RESAMPLE_PHASE_BITS)) * RESAMPLE_TAPS * 2;
+			ResampleFrame<RESAMPLE_TAPS>(&samples[currentSample], &m_buffer[indexR & INDEX_MASK], coefs);
+			frac += ratio;
+			indexR += 2 * (frac >> 16);
+			frac &= 0xffff;
 		}
-		u32 indexR2 = indexR + 2; //next sample
-		s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
-		s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
-		s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
-		s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
-		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)frac) >> 16;
-		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)frac) >> 16;
-		samples[currentSample] = sampleL;
-		samples[currentSample + 1] = sampleR;
-		frac += ratio;
-		indexR += 2 * (frac >> 16);
-		frac &= 0xffff;
 	}
 	m_frac = frac;
 
 	// Let's not count the underrun padding here.
 	outputSampleCount_ += currentSample / 2;
 
+	if (currentSample < numSamples * 2) {
+		// Only grow the target if we underran after getting going, and not because of a slowed down game.
+		if (primed_ && PSP_CoreParameter().fpsLimit == FPSLimit::NORMAL && !PSP_CoreParameter().unthrottle) {
+			underrunBoost_ = std::min(underrunBoost_ + TARGET_BOOST_STEP, MAX_BUFSIZE_EXTRA);
+		}
+		primed_ = false;
+		stableSamples_ = 0;
+	} else {
+		stableSamples_ += numSamples;
+		if (stableSamples_ >= sample_rate * TARGET_BOOST_DECAY_SECONDS && underrunBoost_ > 0) {
+			underrunBoost_ = std::max(0, underrunBoost_ - TARGET_BOOST_STEP / 2);
+			stableSamples_ = 0;
+		}
+	}
+
 	// Padding with the last value to reduce clicking
 	short s[2];
-	s[0] = clamp_s16(m_buffer[(indexR - 1) & INDEX_MASK]);
-	s[1] = clamp_s16(m_buffer[(indexR - 2) & INDEX_MASK]);
+	if (currentSample >= 2) {
+		s[0] = samples[currentSample - 2];
+		s[1] = samples[currentSample - 1];
+	} else {
+		s[0] = clamp_s16(m_buffer[(indexR - 1) & INDEX_MASK]);
+		s[1] = clamp_s16(m_buffer[(indexR - 2) & INDEX_MASK]);
+	}
 	for (; currentSample < numSamples * 2; currentSample += 2) {
 		samples[currentSample] = s[0];
 		samples[currentSample + 1] = s[1];
@@ -247,6 +396,9 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	// Flush cached variable
 	m_indexR.store(indexR);
 
+	mixTime_ += time_now_d() - startTime;
+	mixTimeSamples_ += numSamples;
+
 	// TODO: What should we actually return here?
 	return currentSample / 2;
 }
@@ -285,6 +437,8 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 	} else {
 		ClampBufferToS16WithVolume(&m_buffer[indexW & INDEX_MASK], samples, numSamples * 2);
 	}
+	// Keep the mirror of the start in sync, it's tiny so no need to check if we touched it.
+	memcpy(&m_buffer[m_maxBufsize * 2], &m_buffer[0], RESAMPLE_TAPS * 2 * sizeof(int16_t));
 
 	m_indexW += numSamples * 2;
 	lastPushSize_ = numSamples;
@@ -295,8 +449,10 @@ void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 
 	double effective_input_sample_rate = (double)inputSampleCount_ / elapsed;
 	double effective_output_sample_rate = (double)outputSampleCount_ / elapsed;
+	double mixCost = mixTimeSamples_ > 0 ? mixTime_ * 1000000000.0 / (double)mixTimeSamples_ : 0.0;
 	snprintf(buf, bufSize,
 		"Audio buffer: %d/%d (target: %d)\n"
+		"Latency: %0.1f ms (target: %0.1f ms, underrun boost: %d)\n"
 		"Filtered: %0.2f\n"
 		"Underruns: %d\n"
 		"Overruns: %d\n"
@@ -304,10 +460,16 @@ void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 		"Effective input sample rate: %0.2f\n"
 		"Effective output sample rate: %0.2f\n"
 		"Push size: %d\n"
-		"Ratio: %0.6f\n",
+		"Ratio: %0.6f\n"
+		"Rate control: %0.2f Hz (integral: %0.2f Hz)\n"
+		"Filter: %d taps, %d phases, cutoff %0.2f\n"
+		"Mix cost: %0.1f ns/sample\n",
 		lastBufSize_,
 		m_maxBufsize,
-		m_targetBufsize,
+		lastTarget_,
+		lastBufSize_ * 1000.0f / (float)m_input_sample_rate,
+		lastTarget_ * 1000.0f / (float)m_input_sample_rate,
+		underrunBoost_,
 		m_numLeftI,
 		underrunCountTotal_,
 		overrunCountTotal_,
@@ -316,7 +478,13 @@ void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 		effective_input_sample_rate,
 		effective_output_sample_rate,
 		lastPushSize_,
-		(float)ratio_ / 65536.0f);
+		(float)ratio_ / 65536.0f,
+		output_sample_rate_ - (float)m_input_sample_rate,
+		m_offsetIntegral,
+		useShortFilter_ ? RESAMPLE_SHORT_TAPS : RESAMPLE_TAPS,
+		RESAMPLE_PHASES,
+		useShortFilter_ ? 1.0 : m_cutoff,
+		mixCost);
 	underrunCountTotal_ += underrunCount_;
 	overrunCountTotal_ += overrunCount_;
 	underrunCount_ = 0;
@@ -335,6 +503,8 @@ void StereoResampler::ResetStatCounters() {
 	overrunCountTotal_ = 0;
 	inputSampleCount_ = 0;
 	outputSampleCount_ = 0;
+	mixTime_ = 0.0;
+	mixTimeSamples_ = 0;
 	startTime_ = time_now_d();
 }
 
@@ -48,15 +48,33 @@ public:
 
 private:
 	void UpdateBufferSize();
+	void BuildFilter(int outputSampleRate);
+	void BuildShortFilter();
 
 	int m_maxBufsize;
 	int m_targetBufsize;
 
 	unsigned int m_input_sample_rate = 44100;
 	int16_t *m_buffer;
-	std::atomic<u32> m_indexW;
-	std::atomic<u32> m_indexR;
+	// Polyphase filter coefficients, see BuildFilter().
+	int16_t *m_coefs;
+	// Cubic interpolation, used instead when the rates are close.
+	int16_t *m_shortCoefs;
+	bool useShortFilter_ = false;
+	int m_filterSampleRate = 0;
+	double m_cutoff = 0.0;
+	// Written by PushSamples() and Mix() respectively, on different threads.  Separate cache lines
+	// keep the two sides from invalidating each other's line on every update.
+	alignas(64) std::atomic<u32> m_indexW;
+	alignas(64) std::atomic<u32> m_indexR;
 	float m_numLeftI = 0.0f;
+	float m_offsetIntegral = 0.0f;
+
+	// Added to the target after underruns, in samples.
+	int underrunBoost_ = 0;
+	int stableSamples_ = 0;
+	bool primed_ = false;
+	int lastTarget_ = 0;
 
 	u32 m_frac = 0;
 	float output_sample_rate_ = 0.0;
@@ -74,5 +92,8 @@ private:
 	int64_t inputSampleCount_ = 0;
 	int64_t outputSampleCount_ = 0;
 
+	double mixTime_ = 0.0;
+	int64_t mixTimeSamples_ = 0;
+
 	double startTime_ = 0.0;
 };
@@ -88,6 +88,7 @@ void Arm64Jit::Comp_FPULS(MIPSOpcode op)
 	s32 offset = (s16)(op & 0xFFFF);
 	int ft = _FT;
 	MIPSGPReg rs = _RS;
+	SampleMemoryAccess(rs, offset, (op >> 26) == 57);
 	// u32 addr = R(rs) + offset;
 	std::vector<FixupBranch> skips;
 	switch (op >> 26) {
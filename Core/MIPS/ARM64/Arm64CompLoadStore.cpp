@@ -134,6 +134,7 @@ namespace MIPSComp {
 			}
 		}
 
+		SampleMemoryAccess(rs, offset, !load);
 		u32 iaddr = gpr.IsImm(rs) ? offset + gpr.GetImm(rs) : 0xFFFFFFFF;
 		std::vector<FixupBranch> skips;
 
@@ -277,6 +278,7 @@ namespace MIPSComp {
 			return;
 		}
 
+		SampleMemoryAccess(rs, offset, ((op >> 29) & 1) != 0);
 		u32 iaddr = gpr.IsImm(rs) ? offset + gpr.GetImm(rs) : 0xFFFFFFFF;
 		std::vector<FixupBranch> skips;
 		ARM64Reg targetReg = INVALID_REG;
@@ -208,6 +208,7 @@ namespace MIPSComp {
 		s32 offset = (signed short)(op & 0xFFFC);
 		int vt = ((op >> 16) & 0x1f) | ((op & 3) << 5);
 		MIPSGPReg rs = _RS;
+		SampleMemoryAccess(rs, offset, (op >> 26) == 58);
 
 		std::vector<FixupBranch> skips;
 		switch (op >> 26) {
@@ -290,6 +291,7 @@ namespace MIPSComp {
 		int imm = (signed short)(op&0xFFFC);
 		int vt = (((op >> 16) & 0x1f)) | ((op&1) << 5);
 		MIPSGPReg rs = _RS;
+		SampleMemoryAccess(rs, imm, (op >> 26) == 62);
 
 		std::vector<FixupBranch> skips;
 		switch (op >> 26)
@@ -30,6 +30,7 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/Debugger/Breakpoints.h"
+#include "Core/Debugger/MemHeatmap.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/MemMap.h"
 
@@ -89,6 +90,10 @@ static u32 JitMemCheck(u32 pc) {
 	return coreState == CORE_RUNNING || coreState == CORE_NEXTFRAME ? 0 : 1;
 }
 
+static void JitMemSample(u32 addr, u32 isWrite) {
+	MemHeatmap::Sample(addr, isWrite != 0);
+}
+
 namespace MIPSComp
 {
 using namespace Arm64Gen;
@@ -764,6 +769,41 @@ bool Arm64Jit::CheckMemoryBreakpoint(int instructionOffset) {
 	return false;
 }
 
+void Arm64Jit::SampleMemoryAccess(MIPSGPReg rs, s16 offset, bool isWrite) {
+	if (!MemHeatmap::IsActive())
+		return;
+
+	// Map outside the branch, so the cache state is the same either way.
+	if (!gpr.IsImm(rs))
+		gpr.MapReg(rs);
+
+	// Most accesses only count down.  No flags touched, since a branch may still need them.
+	MOVP2R(SCRATCH1_64, &MemHeatmap::countdown);
+	LDR(INDEX_UNSIGNED, SCRATCH2, SCRATCH1_64, 0);
+	SUB(SCRATCH2, SCRATCH2, 1);
+	STR(INDEX_UNSIGNED, SCRATCH2, SCRATCH1_64, 0);
+	FixupBranch skip = CBNZ(SCRATCH2);
+
+	if (gpr.IsImm(rs)) {
+		MOVI2R(SCRATCH1, (u32)(gpr.GetImm(rs) + offset));
+	} else {
+		ADDI2R(SCRATCH1, gpr.R(rs), offset, SCRATCH2);
+	}
+
+	// Once per interval, so just save everything the call can clobber.
+	const u32 callerSavedGPRs = 0x0003FFFF;  // x0-x17
+	const u32 callerSavedFPRs = 0xFFFF00FF;  // d0-d7, d16-d31
+	MRS(FLAGTEMPREG, FIELD_NZCV);
+	fp.ABI_PushRegisters(callerSavedGPRs, callerSavedFPRs);
+	MOV(W0, SCRATCH1);
+	MOVI2R(W1, isWrite ? 1 : 0);
+	QuickCallFunction(SCRATCH2_64, &JitMemSample);
+	fp.ABI_PopRegisters(callerSavedGPRs, callerSavedFPRs);
+	_MSR(FIELD_NZCV, FLAGTEMPREG);
+
+	SetJumpTarget(skip);
+}
+
 void Arm64Jit::Comp_DoNothing(MIPSOpcode op) { }
 
 MIPSOpcode Arm64Jit::GetOriginalOp(MIPSOpcode op) {
@@ -218,6 +218,7 @@ private:
 	void WriteSyscallExit();
 	bool CheckJitBreakpoint(u32 addr, int downcountOffset);
 	bool CheckMemoryBreakpoint(int instructionOffset = 0);
+	void SampleMemoryAccess(MIPSGPReg rs, s16 offset, bool isWrite);
 
 	// Utility compilation functions
 	void BranchFPFlag(MIPSOpcode op, CCFlags cc, bool likely);
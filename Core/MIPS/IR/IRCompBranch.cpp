@@ -408,7 +408,12 @@ void IRFrontend::Comp_Syscall(MIPSOpcode op) {
 	FlushAll();
 
 	RestoreRoundingMode();
-	ir.Write(IROp::Syscall, 0, ir.AddConstant(op.encoding));
+	// Skip the CallSyscall where possible.
+	int quickIndex = GetQuickSyscallIndex(op);
+	if (quickIndex >= 0)
+		ir.Write(IROp::SyscallQuick, 0, ir.AddConstant(quickIndex));
+	else
+		ir.Write(IROp::Syscall, 0, ir.AddConstant(op.encoding));
 	ApplyRoundingMode();
 	ir.Write(IROp::ExitToPC);
 
@@ -80,6 +80,7 @@ void IRFrontend::Comp_FPULS(MIPSOpcode op) {
 	MIPSGPReg rs = _RS;
 
 	CheckMemoryBreakpoint(rs, offset);
+	SampleMemoryAccess(rs, offset, (op >> 26) == 57);
 
 	switch (op >> 26) {
 	case 49: //FI(ft) = Memory::Read_U32(addr); break; //lwc1
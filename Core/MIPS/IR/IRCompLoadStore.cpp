@@ -57,6 +57,7 @@ namespace MIPSComp {
 		}
 
 		CheckMemoryBreakpoint(rs, offset);
+		SampleMemoryAccess(rs, offset, ((op >> 29) & 1) != 0);
 
 		switch (o) {
 			// Load
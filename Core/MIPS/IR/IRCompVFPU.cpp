@@ -298,6 +298,7 @@ namespace MIPSComp {
 		MIPSGPReg rs = _RS;
 
 		CheckMemoryBreakpoint(rs, offset);
+		SampleMemoryAccess(rs, offset, (op >> 26) == 58);
 
 		switch (op >> 26) {
 		case 50: //lv.s
@@ -323,6 +324,7 @@ namespace MIPSComp {
 		GetVectorRegs(vregs, V_Quad, vt);
 
 		CheckMemoryBreakpoint(rs, imm);
+		SampleMemoryAccess(rs, imm, (op >> 26) == 62);
 
 		switch (op >> 26) {
 		case 54: //lv.q
@@ -19,6 +19,7 @@
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/Debugger/Breakpoints.h"
+#include "Core/Debugger/MemHeatmap.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/Reporting.h"
 #include "Core/HLE/ReplaceTables.h"
@@ -361,4 +362,10 @@ void IRFrontend::CheckMemoryBreakpoint(int rs, int offset) {
 	}
 }
 
+void IRFrontend::SampleMemoryAccess(int rs, int offset, bool isWrite) {
+	if (MemHeatmap::IsActive()) {
+		ir.Write(IROp::MemorySample, isWrite ? 1 : 0, rs, ir.AddConstant(offset));
+	}
+}
+
 }  // namespace
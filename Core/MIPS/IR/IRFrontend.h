@@ -113,6 +113,7 @@ private:
 
 	void CheckBreakpoint(u32 addr);
 	void CheckMemoryBreakpoint(int rs, int offset);
+	void SampleMemoryAccess(int rs, int offset, bool isWrite);
 
 	// Utility compilation functions
 	void BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely);
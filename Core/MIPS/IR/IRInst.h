@@ -209,12 +209,14 @@ enum class IROp : u8 {
 	ExitToPC,  // Used after a syscall to give us a way to do things before returning.
 
 	Syscall,
+	SyscallQuick,  // Index from GetQuickSyscallIndex().
 	SetPC,  // hack to make syscall returns work
 	SetPCConst,  // hack to make replacement know PC
 	CallReplacement,
 	Break,
 	Breakpoint,
 	MemoryCheck,
+	MemorySample,  // dest is 1 for a write.
 };
 
 enum IRComparison {
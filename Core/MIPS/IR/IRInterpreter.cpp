@@ -21,6 +21,7 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/Debugger/Breakpoints.h"
+#include "Core/Debugger/MemHeatmap.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/Host.h"
@@ -929,6 +930,12 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			break;
 		}
 
+		case IROp::SyscallQuick:
+			CallQuickSyscall(inst->constant);
+			if (coreState != CORE_RUNNING)
+				CoreTiming::ForceCheck();
+			break;
+
 		case IROp::ExitToPC:
 			return mips->pc;
 
@@ -978,6 +985,11 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			}
 			break;
 
+		case IROp::MemorySample:
+			if (--MemHeatmap::countdown == 0)
+				MemHeatmap::Sample(mips->r[inst->src1] + inst->constant, inst->dest != 0);
+			break;
+
 		case IROp::ApplyRoundingMode:
 			// TODO: Implement
 			break;
@@ -583,6 +583,7 @@ bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts
 			break;
 		case IROp::LoadFloat:
 		case IROp::LoadVec4:
+		case IROp::MemorySample:
 			if (gpr.IsImm(inst.src1)) {
 				out.Write(inst.op, inst.dest, 0, out.AddConstant(gpr.GetImm(inst.src1) + inst.constant));
 			} else {
@@ -700,6 +701,7 @@ bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts
 		case IROp::CallReplacement:
 		case IROp::Break:
 		case IROp::Syscall:
+		case IROp::SyscallQuick:
 		case IROp::Interpret:
 		case IROp::ExitToConst:
 		case IROp::ExitToReg:
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -30,6 +31,7 @@
 #include "Core/Config.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
+#include "Core/ThreadPools.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 #include "Core/MIPS/MIPSTables.h"
@@ -46,10 +48,6 @@ typedef std::vector<MIPSAnalyst::AnalyzedFunction> FunctionsVector;
 static FunctionsVector functions;
 std::recursive_mutex functions_lock;
 
-// One function can appear in multiple copies in memory, and they will all have 
-// the same hash and should all be replaced if possible.
-static std::unordered_multimap<u64, MIPSAnalyst::AnalyzedFunction *> hashToFunction;
-
 struct HashMapFunc {
 	char name[64];
 	u64 hash;
@@ -74,7 +72,9 @@ namespace std {
 	};
 }
 
+// Only learned and user hashes, the builtin ones are looked up directly in hardcodedHashes.
 static std::unordered_set<HashMapFunc> hashMap;
+static bool builtinHashMapLoaded = false;
 
 static std::string hashmapFileName;
 
@@ -94,6 +94,7 @@ struct HardHashTableEntry {
 };
 
 // Some hardcoded hashes.  Some have a comment specifying at least one game they are found in.
+// Must stay sorted by hash and size, lookups binary search it in place rather than copying it.
 static const HardHashTableEntry hardcodedHashes[] = {
 	{ 0x006b570008068310, 184, "strtok_r", },
 	{ 0x019ba2099fb88f3c, 48, "vector_normalize_t", },
@@ -751,22 +752,6 @@ namespace MIPSAnalyst {
 	void Reset() {
 		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 		functions.clear();
-		hashToFunction.clear();
-	}
-
-	void UpdateHashToFunctionMap() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-		hashToFunction.clear();
-		// Really need to detect C++11 features with better defines.
-#if !defined(IOS)
-		hashToFunction.reserve(functions.size());
-#endif
-		for (auto iter = functions.begin(); iter != functions.end(); iter++) {
-			AnalyzedFunction &f = *iter;
-			if (f.hasHash && f.size > 16) {
-				hashToFunction.insert(std::make_pair(f.hash, &f));
-			}
-		}
 	}
 
 	enum RegisterUsage {
@@ -876,40 +861,45 @@ namespace MIPSAnalyst {
 		return DetermineRegisterUsage(reg, addr, instrs) == USAGE_CLOBBERED;
 	}
 
-	void HashFunctions() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-		std::vector<u32> buffer;
+	static void HashFunction(AnalyzedFunction &f, std::vector<u32> &buffer) {
+		if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
+			return;
+		}
 
-		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
-			AnalyzedFunction &f = *iter;
-			if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
-				continue;
+		// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
+		buffer.resize((f.end - f.start + 4) / 4);
+		size_t pos = 0;
+		for (u32 addr = f.start; addr <= f.end; addr += 4) {
+			u32 validbits = 0xFFFFFFFF;
+			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
+			if (MIPS_IS_EMUHACK(instr)) {
+				f.hasHash = false;
+				return;
 			}
 
-			// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
-			buffer.resize((f.end - f.start + 4) / 4);
-			size_t pos = 0;
-			for (u32 addr = f.start; addr <= f.end; addr += 4) {
-				u32 validbits = 0xFFFFFFFF;
-				MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
-				if (MIPS_IS_EMUHACK(instr)) {
-					f.hasHash = false;
-					goto skip;
-				}
+			MIPSInfo flags = MIPSGetInfo(instr);
+			if (flags & IN_IMM16)
+				validbits &= ~0xFFFF;
+			if (flags & IN_IMM26)
+				validbits &= ~0x03FFFFFF;
+			buffer[pos++] = instr & validbits;
+		}
 
-				MIPSInfo flags = MIPSGetInfo(instr);
-				if (flags & IN_IMM16)
-					validbits &= ~0xFFFF;
-				if (flags & IN_IMM26)
-					validbits &= ~0x03FFFFFF;
-				buffer[pos++] = instr & validbits;
-			}
+		f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
+		f.hasHash = true;
+	}
 
-			f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
-			f.hasHash = true;
-skip:
-			;
-		}
+	void HashFunctions() {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		// Each function is independent, and big games have tens of thousands of them.
+		// The caller holds the lock and waits, so nothing modifies memory or the jit meanwhile.
+		GlobalThreadPool::Loop([](int lower, int upper) {
+			std::vector<u32> buffer;
+			for (int i = lower; i < upper; ++i) {
+				HashFunction(functions[i], buffer);
+			}
+		}, 0, (int)functions.size());
 	}
 
 	void PrecompileFunction(u32 startAddr, u32 length) {
@@ -1223,11 +1213,14 @@ skip:
 		fun.start = startAddr;
 		fun.end = startAddr + size - 4;
 		fun.isStraightLeaf = false;  // dunno really
+		fun.hasHash = false;
 		strncpy(fun.name, name, 64);
 		fun.name[63] = 0;
 		functions.push_back(fun);
 
-		HashFunctions();
+		// The others haven't changed, no need to rehash them all.
+		std::vector<u32> buffer;
+		HashFunction(functions.back(), buffer);
 	}
 
 	void ForgetFunctions(u32 startAddr, u32 endAddr) {
@@ -1239,7 +1232,6 @@ skip:
 
 		// Most of the time, functions from the same module will be contiguous in functions.
 		FunctionsVector::iterator prevMatch = functions.end();
-		size_t originalSize = functions.size();
 		for (auto iter = functions.begin(); iter != functions.end(); ++iter) {
 			const bool hadPrevMatch = prevMatch != functions.end();
 			const bool match = iter->start >= startAddr && iter->start <= endAddr;
@@ -1259,12 +1251,6 @@ skip:
 		}
 
 		RestoreReplacedInstructions(startAddr, endAddr);
-
-		if (functions.empty()) {
-			hashToFunction.clear();
-		} else if (originalSize != functions.size()) {
-			UpdateHashToFunctionMap();
-		}
 	}
 
 	void ReplaceFunctions() {
@@ -1275,6 +1261,15 @@ skip:
 		}
 	}
 
+	static const char *LookupBuiltinHash(u64 hash, u32 funcsize) {
+		const HardHashTableEntry key = { hash, (int)funcsize, nullptr };
+		auto it = std::lower_bound(std::begin(hardcodedHashes), std::end(hardcodedHashes), key);
+		if (it != std::end(hardcodedHashes) && it->hash == hash && it->funcSize == (int)funcsize) {
+			return it->funcName;
+		}
+		return nullptr;
+	}
+
 	void UpdateHashMap() {
 		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
@@ -1290,6 +1285,11 @@ skip:
 				continue;
 			}
 
+			// Builtin ones are never saved, so no need to track them.
+			if (LookupBuiltinHash(f.hash, f.size)) {
+				continue;
+			}
+
 			HashMapFunc mf = { "", f.hash, f.size };
 			strncpy(mf.name, name.c_str(), sizeof(mf.name) - 1);
 			hashMap.insert(mf);
@@ -1297,6 +1297,13 @@ skip:
 	}
 
 	const char *LookupHash(u64 hash, u32 funcsize) {
+		if (builtinHashMapLoaded) {
+			const char *name = LookupBuiltinHash(hash, funcsize);
+			if (name) {
+				return name;
+			}
+		}
+
 		const HashMapFunc f = { "", hash, funcsize };
 		auto it = hashMap.find(f);
 		if (it != hashMap.end()) {
@@ -1305,6 +1312,18 @@ skip:
 		return 0;
 	}
 
+	bool GetFunctionContaining(u32 addr, AnalyzedFunction *func) {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		for (const AnalyzedFunction &f : functions) {
+			if (addr >= f.start && addr <= f.end) {
+				*func = f;
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void SetHashMapFilename(const std::string& filename) {
 		if (filename.empty())
 			hashmapFileName = GetSysDirectory(DIRECTORY_SYSTEM) + "knownfuncs.ini";
@@ -1340,41 +1359,34 @@ skip:
 	}
 
 	void ApplyHashMap() {
-		UpdateHashToFunctionMap();
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
-		for (auto mf = hashMap.begin(), end = hashMap.end(); mf != end; ++mf) {
-			auto range = hashToFunction.equal_range(mf->hash);
-			if (range.first == range.second) {
+		// One function can appear in multiple copies in memory, and they will all have
+		// the same hash, so they should all get the name.
+		for (AnalyzedFunction &f : functions) {
+			if (!f.hasHash || f.size <= 16) {
+				continue;
+			}
+			const char *name = LookupHash(f.hash, f.size);
+			if (!name) {
 				continue;
 			}
 
 			// Yay, found a function.
-			for (auto iter = range.first; iter != range.second; ++iter) {
-				AnalyzedFunction &f = *iter->second;
-				if (f.hash == mf->hash && f.size == mf->size) {
-					strncpy(f.name, mf->name, sizeof(mf->name) - 1);
-
-					std::string existingLabel = g_symbolMap->GetLabelString(f.start);
-					char defaultLabel[256];
-					// If it was renamed, keep it.  Only change the name if it's still the default.
-					if (existingLabel.empty() || existingLabel == DefaultFunctionName(defaultLabel, f.start)) {
-						g_symbolMap->SetLabelName(mf->name, f.start);
-					}
-				}
+			strncpy(f.name, name, sizeof(f.name) - 1);
+
+			std::string existingLabel = g_symbolMap->GetLabelString(f.start);
+			char defaultLabel[256];
+			// If it was renamed, keep it.  Only change the name if it's still the default.
+			if (existingLabel.empty() || existingLabel == DefaultFunctionName(defaultLabel, f.start)) {
+				g_symbolMap->SetLabelName(name, f.start);
 			}
 		}
 	}
 
 	void LoadBuiltinHashMap() {
-		HashMapFunc mf;
-		for (size_t i = 0; i < ARRAY_SIZE(hardcodedHashes); i++) {
-			mf.hash = hardcodedHashes[i].hash;
-			mf.size = hardcodedHashes[i].funcSize;
-			strncpy(mf.name, hardcodedHashes[i].funcName, sizeof(mf.name));
-			mf.name[sizeof(mf.name) - 1] = 0;
-			mf.hardcoded = true;
-			hashMap.insert(mf);
-		}
+		_dbg_assert_msg_(std::is_sorted(std::begin(hardcodedHashes), std::end(hardcodedHashes)), "hardcodedHashes must be sorted");
+		builtinHashMapLoaded = true;
 	}
 
 	void LoadHashMap(const std::string& filename) {
@@ -1396,7 +1408,10 @@ skip:
 				continue;
 			}
 
-			hashMap.insert(mf);
+			// The builtin entry wins anyway, and shouldn't be saved back out.
+			if (!LookupBuiltinHash(mf.hash, mf.size)) {
+				hashMap.insert(mf);
+			}
 		}
 		fclose(file);
 	}
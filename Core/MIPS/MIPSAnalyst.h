@@ -118,6 +118,8 @@ namespace MIPSAnalyst
 	void StoreHashMap(std::string filename = "");
 
 	const char *LookupHash(u64 hash, u32 funcSize);
+	// Copies out the analyzed function containing addr, if any.
+	bool GetFunctionContaining(u32 addr, AnalyzedFunction *func);
 	void ReplaceFunctions();
 
 	void UpdateHashMap();
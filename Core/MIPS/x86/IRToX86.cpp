@@ -284,6 +284,7 @@ void IRToX86::ConvertIRToNative(const IRInst *instructions, int count, const u32
 		case IROp::SetPC:
 		case IROp::SetPCConst:
 		case IROp::Syscall:
+		case IROp::SyscallQuick:
 		case IROp::Interpret:  // SLOW fallback. Can be made faster.
 		case IROp::CallReplacement:
 		case IROp::Break:
@@ -21,6 +21,7 @@
 
 #include "Core/Config.h"
 #include "Core/Debugger/Breakpoints.h"
+#include "Core/Debugger/MemHeatmap.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/x86/Jit.h"
@@ -50,6 +51,11 @@ void JitMemCheckCleanup()
 	CBreakPoints::ExecMemCheckJitCleanup();
 }
 
+static void JitMemSample(u32 addr, int size, int isWrite)
+{
+	MemHeatmap::Sample(addr, isWrite == 1);
+}
+
 JitSafeMem::JitSafeMem(Jit *jit, MIPSGPReg raddr, s32 offset, u32 alignMask)
 	: jit_(jit), raddr_(raddr), offset_(offset), needsCheck_(false), needsSkip_(false), alignMask_(alignMask)
 {
@@ -77,6 +83,7 @@ bool JitSafeMem::PrepareWrite(OpArg &dest, int size)
 		if (ImmValid())
 		{
 			MemCheckImm(MEM_WRITE);
+			SampleAccess(MEM_WRITE);
 			u32 addr = (iaddr_ & alignMask_);
 #ifdef MASKED_PSP_MEMORY
 			addr &= Memory::MEMVIEW32_MASK;
@@ -106,6 +113,7 @@ bool JitSafeMem::PrepareRead(OpArg &src, int size)
 		if (ImmValid())
 		{
 			MemCheckImm(MEM_READ);
+			SampleAccess(MEM_READ);
 			u32 addr = (iaddr_ & alignMask_);
 #ifdef MASKED_PSP_MEMORY
 			addr &= Memory::MEMVIEW32_MASK;
@@ -174,6 +182,7 @@ OpArg JitSafeMem::PrepareMemoryOpArg(MemoryOpType type)
 	}
 
 	MemCheckAsm(type);
+	SampleAccess(type);
 
 	if (!fast_)
 	{
@@ -372,6 +381,37 @@ void JitSafeMem::MemCheckImm(MemoryOpType type) {
 	}
 }
 
+void JitSafeMem::SampleAccess(MemoryOpType type) {
+	if (!MemHeatmap::IsActive())
+		return;
+
+	// Only the decrement runs for most accesses, the call happens once per sampling interval.
+	if (jit_->RipAccessible((const void *)&MemHeatmap::countdown)) {
+		jit_->SUB(32, M(&MemHeatmap::countdown), Imm8(1));  // rip accessible
+	} else {
+		// POP doesn't change flags, so the SUB's result survives.
+		jit_->PUSH(RAX);
+		jit_->MOV(PTRBITS, R(RAX), ImmPtr((const void *)&MemHeatmap::countdown));
+		jit_->SUB(32, MatR(RAX), Imm8(1));
+		jit_->POP(RAX);
+	}
+	FixupBranch skip = jit_->J_CC(CC_NZ, true);
+
+	if (iaddr_ != (u32) -1) {
+		jit_->CallProtectedFunction(&JitMemSample, iaddr_, size_, type == MEM_WRITE ? 1 : 0);
+	} else {
+		// Keep the stack 16-byte aligned, just PUSH/POP 4 times.
+		for (int i = 0; i < 4; ++i)
+			jit_->PUSH(xaddr_);
+		jit_->ADD(32, R(xaddr_), Imm32(offset_));
+		jit_->CallProtectedFunction(&JitMemSample, R(xaddr_), size_, type == MEM_WRITE ? 1 : 0);
+		for (int i = 0; i < 4; ++i)
+			jit_->POP(xaddr_);
+	}
+
+	jit_->SetJumpTarget(skip);
+}
+
 void JitSafeMem::MemCheckAsm(MemoryOpType type)
 {
 	const auto memchecks = CBreakPoints::GetMemCheckRanges(type == MEM_WRITE);
@@ -71,6 +71,7 @@ private:
 	void PrepareSlowAccess();
 	void MemCheckImm(MemoryOpType type);
 	void MemCheckAsm(MemoryOpType type);
+	void SampleAccess(MemoryOpType type);
 	bool ImmValid();
 
 	Jit *jit_;
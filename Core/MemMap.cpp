@@ -31,6 +31,7 @@
 #include "Common/Serialize/SerializeFuncs.h"
 
 #include "Core/MemMap.h"
+#include "Core/MemMapHelpers.h"
 #include "Core/MemFault.h"
 #include "Core/HDRemaster.h"
 #include "Core/MIPS/MIPS.h"
@@ -44,6 +45,8 @@
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
+#include "GPU/GPU.h"
+#include "GPU/GPUInterface.h"
 #include "UI/OnScreenDisplay.h"
 
 namespace Memory {
@@ -469,7 +472,55 @@ void Memset(const u32 _Address, const u8 _iValue, const u32 _iLength) {
 			Write_U8(_iValue, (u32)(_Address + i));
 	}
 
-	CBreakPoints::ExecMemCheck(_Address, true, _iLength, currentMIPS->pc);
+	if (CBreakPoints::AnyMemChecks())
+		CBreakPoints::ExecMemCheck(_Address, true, _iLength, currentMIPS->pc);
+}
+
+bool MemcpyBlock(const u32 to_address, const u32 from_address, const u32 len, int flags) {
+	// Nothing to do, and games do pass null pointers with zero sizes.
+	if (len == 0)
+		return true;
+	if (!IsValidRange(to_address, len) || !IsValidRange(from_address, len)) {
+		ERROR_LOG(MEMMAP, "Bad block copy: %08x -> %08x (%08x bytes)", from_address, to_address, len);
+		return false;
+	}
+
+	if (flags & MEMBLOCK_INVALIDATE_SRC)
+		currentMIPS->InvalidateICache(from_address, len);
+	bool handled = false;
+	if ((flags & MEMBLOCK_NOTIFY_GPU) && gpu && (IsVRAMAddress(to_address) || IsVRAMAddress(from_address)))
+		handled = gpu->PerformMemoryCopy(to_address, from_address, len);
+	if (!handled)
+		memmove(GetPointerUnchecked(to_address), GetPointerUnchecked(from_address), len);
+	if (flags & MEMBLOCK_INVALIDATE_DEST)
+		currentMIPS->InvalidateICache(to_address, len);
+
+	if (CBreakPoints::AnyMemChecks()) {
+		CBreakPoints::ExecMemCheck(from_address, false, len, currentMIPS->pc);
+		CBreakPoints::ExecMemCheck(to_address, true, len, currentMIPS->pc);
+	}
+	return true;
+}
+
+bool MemsetBlock(const u32 to_address, const u8 value, const u32 len, int flags) {
+	if (len == 0)
+		return true;
+	if (!IsValidRange(to_address, len)) {
+		ERROR_LOG(MEMMAP, "Bad block set: %08x (%08x bytes)", to_address, len);
+		return false;
+	}
+
+	bool handled = false;
+	if ((flags & MEMBLOCK_NOTIFY_GPU) && gpu && IsVRAMAddress(to_address))
+		handled = gpu->PerformMemorySet(to_address, value, len);
+	if (!handled)
+		memset(GetPointerUnchecked(to_address), value, len);
+	if (flags & MEMBLOCK_INVALIDATE_DEST)
+		currentMIPS->InvalidateICache(to_address, len);
+
+	if (CBreakPoints::AnyMemChecks())
+		CBreakPoints::ExecMemCheck(to_address, true, len, currentMIPS->pc);
+	return true;
 }
 
 } // namespace
@@ -33,7 +33,8 @@ inline void Memcpy(const u32 to_address, const void *from_data, const u32 len)
 	u8 *to = GetPointer(to_address);
 	if (to) {
 		memcpy(to, from_data, len);
-		CBreakPoints::ExecMemCheck(to_address, true, len, currentMIPS->pc);
+		if (CBreakPoints::AnyMemChecks())
+			CBreakPoints::ExecMemCheck(to_address, true, len, currentMIPS->pc);
 	}
 	// if not, GetPointer will log.
 }
@@ -43,19 +44,43 @@ inline void Memcpy(void *to_data, const u32 from_address, const u32 len)
 	const u8 *from = GetPointer(from_address);
 	if (from) {
 		memcpy(to_data, from, len);
-		CBreakPoints::ExecMemCheck(from_address, false, len, currentMIPS->pc);
+		if (CBreakPoints::AnyMemChecks())
+			CBreakPoints::ExecMemCheck(from_address, false, len, currentMIPS->pc);
 	}
 	// if not, GetPointer will log.
 }
 
 inline void Memcpy(const u32 to_address, const u32 from_address, const u32 len)
 {
-	Memcpy(GetPointer(to_address), from_address, len);
-	CBreakPoints::ExecMemCheck(to_address, true, len, currentMIPS->pc);
+	u8 *to = GetPointer(to_address);
+	const u8 *from = GetPointer(from_address);
+	if (to && from) {
+		memcpy(to, from, len);
+		if (CBreakPoints::AnyMemChecks()) {
+			CBreakPoints::ExecMemCheck(from_address, false, len, currentMIPS->pc);
+			CBreakPoints::ExecMemCheck(to_address, true, len, currentMIPS->pc);
+		}
+	}
+	// if not, GetPointer will log.
 }
 
 void Memset(const u32 _Address, const u8 _Data, const u32 _iLength);
 
+enum MemBlockFlags {
+	// Let the GPU handle copies touching VRAM, and tell it about the range (framebuffers, texture cache.)
+	MEMBLOCK_NOTIFY_GPU = 0x01,
+	// Invalidate jit blocks in the source before copying, so emuhack ops aren't copied.
+	MEMBLOCK_INVALIDATE_SRC = 0x02,
+	// Invalidate jit blocks in the destination after writing.
+	MEMBLOCK_INVALIDATE_DEST = 0x04,
+};
+
+// Bulk copy/set on behalf of the PSP (DMA, HLE.)  Both ranges are validated once up front,
+// then everyone interested is told about the whole block at once, and memchecks only run if any
+// are set.  Copies may overlap.  Returns false without touching memory if a range is invalid.
+bool MemcpyBlock(const u32 to_address, const u32 from_address, const u32 len, int flags);
+bool MemsetBlock(const u32 to_address, const u8 value, const u32 len, int flags);
+
 template<class T>
 void ReadStruct(u32 address, T *ptr)
 {
@@ -44,6 +44,7 @@
 #include "Core/HDRemaster.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
+#include "Core/Debugger/MemHeatmap.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/Host.h"
 #include "Core/System.h"
@@ -379,10 +380,15 @@ void Core_UpdateState(CoreState newState) {
 }
 
 void Core_UpdateDebugStats(bool collectStats) {
+	bool clearJit = hleUpdateProfiling();
+	if (MemHeatmap::Update())
+		clearJit = true;
 	if (coreCollectDebugStats != collectStats) {
 		coreCollectDebugStats = collectStats;
-		mipsr4k.ClearJitCache();
+		clearJit = true;
 	}
+	if (clearJit)
+		mipsr4k.ClearJitCache();
 
 	kernelStats.ResetFrame();
 	gpuStats.ResetFrame();
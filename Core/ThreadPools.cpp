@@ -11,6 +11,11 @@ void GlobalThreadPool::Loop(const std::function<void(int,int)>& loop, int lower,
 	pool->ParallelLoop(loop, lower, upper);
 }
 
+bool GlobalThreadPool::TryLoop(const std::function<void(int,int)>& loop, int lower, int upper) {
+	std::call_once(init_flag, Inititialize);
+	return pool->TryParallelLoop(loop, lower, upper);
+}
+
 void GlobalThreadPool::Inititialize() {
 	pool = make_unique<ThreadPool>(g_Config.iNumWorkerThreads);
 }
@@ -7,6 +7,9 @@ public:
 	// will execute slices of "loop" from "lower" to "upper"
 	// in parallel on the global thread pool
 	static void Loop(const std::function<void(int,int)>& loop, int lower, int upper);
+	// Like Loop, but returns false instead of waiting if the pool is busy.
+	// For callers that can't afford to wait behind other work, they can run the loop themselves.
+	static bool TryLoop(const std::function<void(int,int)>& loop, int lower, int upper);
 
 private:
 	static std::unique_ptr<ThreadPool> pool;
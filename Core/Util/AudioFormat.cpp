@@ -20,14 +20,29 @@
 #include "Core/Util/AudioFormat.h"
 #include "Core/Util/AudioFormatNEON.h"
 
+#include <algorithm>
+#include <cmath>
+
 #ifdef _M_SSE
 #include <emmintrin.h>
+#if _M_SSE >= 0x401
+#include <smmintrin.h>
+#endif
+#endif
+#if PPSSPP_ARCH(ARM_NEON)
+#if defined(_MSC_VER) && PPSSPP_ARCH(ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
 #endif
 
 void AdjustVolumeBlockStandard(s16_le *out, s16_le *in, size_t size, int leftVol, int rightVol) {
+	bool fullPrecision = leftVol <= 0x7fff && -leftVol <= 0x8000 && rightVol <= 0x7fff && -rightVol <= 0x8000;
 #ifdef _M_SSE
-	if (leftVol <= 0x7fff && -leftVol <= 0x8000 && rightVol <= 0x7fff && -rightVol <= 0x8000) {
-		__m128i volume = _mm_set_epi16(leftVol, rightVol, leftVol, rightVol, leftVol, rightVol, leftVol, rightVol);
+	if (fullPrecision) {
+		// The first sample of each pair is left, and it goes in the lowest lane.
+		__m128i volume = _mm_set_epi16(rightVol, leftVol, rightVol, leftVol, rightVol, leftVol, rightVol, leftVol);
 		while (size >= 16) {
 			__m128i indata1 = _mm_loadu_si128((__m128i *)in);
 			__m128i indata2 = _mm_loadu_si128((__m128i *)(in + 8));
@@ -37,37 +52,23 @@ void AdjustVolumeBlockStandard(s16_le *out, s16_le *in, size_t size, int leftVol
 			out += 16;
 			size -= 16;
 		}
-	}
-#if 0
-	// This path wraps instead of clamps in _mm_slli_epi16. Needs fixing.
-	else {
-		// We have to shift inside the loop to avoid the signed 16-bit multiply issue.
-		int leftShift = 0;
-		int leftVol16 = leftVol;
-		while (leftVol16 > 0x7fff || -leftVol16 > 0x8000) {
-			++leftShift;
-			leftVol16 >>= 1;
-		}
-		int rightShift = 0;
-		int rightVol16 = rightVol;
-		while (rightVol16 > 0x7fff || -rightVol16 > 0x8000) {
-			++rightShift;
-			rightVol16 >>= 1;
-		}
-		__m128i volume = _mm_set_epi16(leftVol16, rightVol16, leftVol16, rightVol16, leftVol16, rightVol16, leftVol16, rightVol16);
-		while (size >= 16) {
-			__m128i indata1 = _mm_loadu_si128((__m128i *)in);
-			__m128i indata2 = _mm_loadu_si128((__m128i *)(in + 8));
-			_mm_storeu_si128((__m128i *)out, _mm_slli_epi16(_mm_mulhi_epi16(indata1, volume), leftShift));
-			_mm_storeu_si128((__m128i *)(out + 8), _mm_slli_epi16(_mm_mulhi_epi16(indata2, volume), rightShift));
-			in += 16;
-			out += 16;
-			size -= 16;
+	} else if ((leftVol >> 4) <= 0x7fff && -(leftVol >> 4) <= 0x8000 && (rightVol >> 4) <= 0x7fff && -(rightVol >> 4) <= 0x8000) {
+		// Same as ApplySampleVolume20Bit(): full 32-bit products, shifted and then saturated by the pack.
+		__m128i volume = _mm_set_epi16(rightVol >> 4, leftVol >> 4, rightVol >> 4, leftVol >> 4, rightVol >> 4, leftVol >> 4, rightVol >> 4, leftVol >> 4);
+		while (size >= 8) {
+			__m128i indata = _mm_loadu_si128((__m128i *)in);
+			__m128i lo = _mm_mullo_epi16(indata, volume);
+			__m128i hi = _mm_mulhi_epi16(indata, volume);
+			__m128i out1 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 12);
+			__m128i out2 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 12);
+			_mm_storeu_si128((__m128i *)out, _mm_packs_epi32(out1, out2));
+			in += 8;
+			out += 8;
+			size -= 8;
 		}
 	}
 #endif
-#endif
-	if (leftVol <= 0x7fff && -leftVol <= 0x8000 && rightVol <= 0x7fff && -rightVol <= 0x8000) {
+	if (fullPrecision) {
 		for (size_t i = 0; i < size; i += 2) {
 			out[i] = ApplySampleVolume(in[i], leftVol);
 			out[i + 1] = ApplySampleVolume(in[i + 1], rightVol);
@@ -104,12 +105,152 @@ void ConvertS16ToF32(float *out, const s16 *in, size_t size) {
 		out += 16;
 		size -= 16;
 	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	while (size >= 8) {
+		int16x8_t indata = vld1q_s16(in);
+		vst1q_f32(out + 0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(indata))), 1.0f / 32767.0f));
+		vst1q_f32(out + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(indata))), 1.0f / 32767.0f));
+		in += 8;
+		out += 8;
+		size -= 8;
+	}
 #endif
 	for (size_t i = 0; i < size; i++) {
 		out[i] = in[i] * (1.0f / 32767.0f);
 	}
 }
 
+void ConvertPlanarF32ToS16Stereo(s16 *out, const float *left, const float *right, size_t frames) {
+#ifdef _M_SSE
+	const __m128 scale = _mm_set_ps1(32768.0f);
+	while (frames >= 8) {
+		// Rounds to nearest (even), then saturates in the pack.
+		__m128i l1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(left + 0), scale));
+		__m128i l2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(left + 4), scale));
+		__m128i r1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(right + 0), scale));
+		__m128i r2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(right + 4), scale));
+		__m128i l = _mm_packs_epi32(l1, l2);
+		__m128i r = _mm_packs_epi32(r1, r2);
+		_mm_storeu_si128((__m128i *)out + 0, _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i *)out + 1, _mm_unpackhi_epi16(l, r));
+		left += 8;
+		right += 8;
+		out += 16;
+		frames -= 8;
+	}
+#elif PPSSPP_ARCH(ARM64)
+	while (frames >= 4) {
+		int16x4x2_t lr;
+		lr.val[0] = vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(left), 32768.0f)));
+		lr.val[1] = vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(right), 32768.0f)));
+		vst2_s16(out, lr);
+		left += 4;
+		right += 4;
+		out += 8;
+		frames -= 4;
+	}
+#endif
+	for (size_t i = 0; i < frames; i++) {
+		// Clamp first, so the conversion to int can't overflow.
+		out[i * 2 + 0] = clamp_s16((int)lrintf(std::min(std::max(left[i] * 32768.0f, -65536.0f), 65536.0f)));
+		out[i * 2 + 1] = clamp_s16((int)lrintf(std::min(std::max(right[i] * 32768.0f, -65536.0f), 65536.0f)));
+	}
+}
+
+void ClampBufferToS16(s16 *out, const s32 *in, size_t size, int volShift) {
+#ifdef _M_SSE
+	// Shift before packing, so loud samples are scaled down rather than clipped first.
+	const __m128i shift = _mm_cvtsi32_si128(volShift);
+	while (size >= 8) {
+		__m128i in1 = _mm_sra_epi32(_mm_loadu_si128((const __m128i *)in), shift);
+		__m128i in2 = _mm_sra_epi32(_mm_loadu_si128((const __m128i *)(in + 4)), shift);
+		_mm_storeu_si128((__m128i *)out, _mm_packs_epi32(in1, in2));
+		out += 8;
+		in += 8;
+		size -= 8;
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	// Can only dynamic-shift left, but by a signed amount.
+	const int32x4_t shift = vdupq_n_s32(-volShift);
+	while (size >= 8) {
+		int16x4_t packed1 = vqmovn_s32(vshlq_s32(vld1q_s32(in), shift));
+		int16x4_t packed2 = vqmovn_s32(vshlq_s32(vld1q_s32(in + 4), shift));
+		vst1q_s16(out, vcombine_s16(packed1, packed2));
+		out += 8;
+		in += 8;
+		size -= 8;
+	}
+#endif
+	for (size_t i = 0; i < size; i++) {
+		out[i] = clamp_s16(in[i] >> volShift);
+	}
+}
+
+void ConvertS16ToS32(s32 *out, const s16_le *in, size_t size) {
+#ifdef _M_SSE
+	while (size >= 8) {
+		__m128i indata = _mm_loadu_si128((const __m128i *)in);
+#if _M_SSE >= 0x401
+		__m128i lo = _mm_cvtepi16_epi32(indata);
+		__m128i hi = _mm_cvtepi16_epi32(_mm_unpackhi_epi64(indata, indata));
+#else
+		// Unpacking into the high halves and shifting back down sign extends.
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(indata, indata), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(indata, indata), 16);
+#endif
+		_mm_storeu_si128((__m128i *)out, lo);
+		_mm_storeu_si128((__m128i *)(out + 4), hi);
+		in += 8;
+		out += 8;
+		size -= 8;
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	while (size >= 8) {
+		int16x8_t indata = vld1q_s16((const s16 *)in);
+		vst1q_s32(out, vmovl_s16(vget_low_s16(indata)));
+		vst1q_s32(out + 4, vmovl_s16(vget_high_s16(indata)));
+		in += 8;
+		out += 8;
+		size -= 8;
+	}
+#endif
+	for (size_t i = 0; i < size; i++) {
+		out[i] = in[i];
+	}
+}
+
+void MixS16ToS32(s32 *out, const s16_le *in, size_t size) {
+#ifdef _M_SSE
+	while (size >= 8) {
+		__m128i indata = _mm_loadu_si128((const __m128i *)in);
+#if _M_SSE >= 0x401
+		__m128i lo = _mm_cvtepi16_epi32(indata);
+		__m128i hi = _mm_cvtepi16_epi32(_mm_unpackhi_epi64(indata, indata));
+#else
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(indata, indata), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(indata, indata), 16);
+#endif
+		_mm_storeu_si128((__m128i *)out, _mm_add_epi32(_mm_loadu_si128((const __m128i *)out), lo));
+		_mm_storeu_si128((__m128i *)(out + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(out + 4)), hi));
+		in += 8;
+		out += 8;
+		size -= 8;
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	while (size >= 8) {
+		int16x8_t indata = vld1q_s16((const s16 *)in);
+		vst1q_s32(out, vaddw_s16(vld1q_s32(out), vget_low_s16(indata)));
+		vst1q_s32(out + 4, vaddw_s16(vld1q_s32(out + 4), vget_high_s16(indata)));
+		in += 8;
+		out += 8;
+		size -= 8;
+	}
+#endif
+	for (size_t i = 0; i < size; i++) {
+		out[i] += in[i];
+	}
+}
+
 #if !defined(_M_SSE) && !PPSSPP_ARCH(ARM64)
 AdjustVolumeBlockFunc AdjustVolumeBlock = &AdjustVolumeBlockStandard;
 
@@ -70,6 +70,13 @@ static inline s16 ApplySampleVolume20Bit(s16 sample, int vol20) {
 void SetupAudioFormats();
 void AdjustVolumeBlockStandard(s16_le *out, s16_le *in, size_t size, int leftVol, int rightVol);
 void ConvertS16ToF32(float *ou, const s16 *in, size_t size);
+// Interleaves planar float output from a decoder, rounding and clamping like swresample does.
+void ConvertPlanarF32ToS16Stereo(s16 *out, const float *left, const float *right, size_t frames);
+// Saturates (in >> volShift) to 16 bits.
+void ClampBufferToS16(s16 *out, const s32 *in, size_t size, int volShift);
+// For the mix buffer: the first channel is widened with ConvertS16ToS32, the rest added with MixS16ToS32.
+void ConvertS16ToS32(s32 *out, const s16_le *in, size_t size);
+void MixS16ToS32(s32 *out, const s16_le *in, size_t size);
 
 #ifdef _M_SSE
 #define AdjustVolumeBlock AdjustVolumeBlockStandard
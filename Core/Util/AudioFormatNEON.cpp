@@ -31,43 +31,44 @@
 #error Should not be compiled on non-ARM.
 #endif
 
-alignas(16) static s16 volumeValues[4] = {};
+// The shift has to be a constant for vqshrn_n_s32, hence the template.
+template <int shift>
+static void AdjustVolumeBlockShifted(s16 *&out, s16 *&in, size_t &size, s16 leftVol, s16 rightVol) {
+	alignas(16) const s16 volumeValues[4] = { leftVol, rightVol, leftVol, rightVol };
+	const int16x4_t vol = vld1_s16(volumeValues);
 
-void AdjustVolumeBlockNEON(s16 *out, s16 *in, size_t size, int leftVol, int rightVol) {
-	if (leftVol <= 0xFFFF && -leftVol <= 0x10000 && rightVol <= 0xFFFF && -rightVol <= 0x10000) {
-		// Note: vqshrn_n_s32 takes a const argument, so we always go with 1 here, 15 there.
-		volumeValues[0] = leftVol >> 1;
-		volumeValues[1] = rightVol >> 1;
-		volumeValues[2] = leftVol >> 1;
-		volumeValues[3] = rightVol >> 1;
-
-		const int16x4_t vol = vld1_s16(volumeValues);
+	while (size >= 16) {
+		int16x8_t indata1 = vld1q_s16(in);
+		int16x8_t indata2 = vld1q_s16(in + 8);
 
-		while (size >= 16) {
-			int16x8_t indata1 = vld1q_s16(in);
-			int16x8_t indata2 = vld1q_s16(in + 8);
+		int32x4_t outh1 = vmull_s16(vget_high_s16(indata1), vol);
+		int32x4_t outh2 = vmull_s16(vget_high_s16(indata2), vol);
+		int32x4_t outl1 = vmull_s16(vget_low_s16(indata1), vol);
+		int32x4_t outl2 = vmull_s16(vget_low_s16(indata2), vol);
 
-			int32x4_t outh1 = vmull_s16(vget_high_s16(indata1), vol);
-			int32x4_t outh2 = vmull_s16(vget_high_s16(indata2), vol);
-			int32x4_t outl1 = vmull_s16(vget_low_s16(indata1), vol);
-			int32x4_t outl2 = vmull_s16(vget_low_s16(indata2), vol);
-
-			int16x8_t outdata1 = vcombine_s16(vqshrn_n_s32(outl1, 15), vqshrn_n_s32(outh1, 15));
-			int16x8_t outdata2 = vcombine_s16(vqshrn_n_s32(outl2, 15), vqshrn_n_s32(outh2, 15));
-			vst1q_s16(out, outdata1);
-			vst1q_s16(out + 8, outdata2);
-			in += 16;
-			out += 16;
-			size -= 16;
-		}
+		int16x8_t outdata1 = vcombine_s16(vqshrn_n_s32(outl1, shift), vqshrn_n_s32(outh1, shift));
+		int16x8_t outdata2 = vcombine_s16(vqshrn_n_s32(outl2, shift), vqshrn_n_s32(outh2, shift));
+		vst1q_s16(out, outdata1);
+		vst1q_s16(out + 8, outdata2);
+		in += 16;
+		out += 16;
+		size -= 16;
 	}
+}
 
+void AdjustVolumeBlockNEON(s16 *out, s16 *in, size_t size, int leftVol, int rightVol) {
 	if (leftVol <= 0x7fff && -leftVol <= 0x8000 && rightVol <= 0x7fff && -rightVol <= 0x8000) {
+		// Matches ApplySampleVolume() exactly.
+		AdjustVolumeBlockShifted<16>(out, in, size, leftVol, rightVol);
 		for (size_t i = 0; i < size; i += 2) {
 			out[i] = ApplySampleVolume(in[i], leftVol);
 			out[i + 1] = ApplySampleVolume(in[i + 1], rightVol);
 		}
 	} else {
+		// And this ApplySampleVolume20Bit(), as long as the reduced volume still fits.
+		if ((leftVol >> 4) <= 0x7fff && -(leftVol >> 4) <= 0x8000 && (rightVol >> 4) <= 0x7fff && -(rightVol >> 4) <= 0x8000) {
+			AdjustVolumeBlockShifted<12>(out, in, size, leftVol >> 4, rightVol >> 4);
+		}
 		for (size_t i = 0; i < size; i += 2) {
 			out[i] = ApplySampleVolume20Bit(in[i], leftVol);
 			out[i + 1] = ApplySampleVolume20Bit(in[i + 1], rightVol);
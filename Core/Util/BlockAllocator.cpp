@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstring>
 
 #include "Common/Log.h"
@@ -24,7 +25,8 @@
 #include "Core/Util/BlockAllocator.h"
 #include "Core/Reporting.h"
 
-// Slow freaking thing but works (eventually) :)
+// Blocks are kept in a linked list in address order, and also in a treap (keyed by address, same order)
+// that tracks free space per subtree.  This finds the same block a linear first fit would, in log time.
 
 BlockAllocator::BlockAllocator(int grain) : bottom_(NULL), top_(NULL), grain_(grain)
 {
@@ -43,6 +45,7 @@ void BlockAllocator::Init(u32 rangeStart, u32 rangeSize)
 	//Initial block, covering everything
 	top_ = new Block(rangeStart_, rangeSize_, false, NULL, NULL);
 	bottom_ = top_;
+	TreeInsert(top_, nullptr, false);
 }
 
 void BlockAllocator::Shutdown()
@@ -54,6 +57,7 @@ void BlockAllocator::Shutdown()
 		bottom_ = next;
 	}
 	top_ = NULL;
+	root_ = nullptr;
 }
 
 u32 BlockAllocator::AllocAligned(u32 &size, u32 sizeGrain, u32 grain, bool fromTop, const char *tag)
@@ -76,63 +80,41 @@ u32 BlockAllocator::AllocAligned(u32 &size, u32 sizeGrain, u32 grain, bool fromT
 	if (!fromTop)
 	{
 		//Allocate from bottom of mem
-		for (Block *bp = bottom_; bp != NULL; bp = bp->next)
+		Block *bp = FindFreeFromBottom(root_, size, grain);
+		if (bp != NULL)
 		{
 			Block &b = *bp;
 			u32 offset = b.start % grain;
 			if (offset != 0)
 				offset = grain - offset;
 			u32 needed = offset + size;
-			if (b.taken == false && b.size >= needed)
-			{
-				if (b.size == needed)
-				{
-					if (offset >= grain_)
-						InsertFreeBefore(&b, offset);
-					b.taken = true;
-					b.SetTag(tag);
-					return b.start;
-				}
-				else
-				{
-					InsertFreeAfter(&b, b.size - needed);
-					if (offset >= grain_)
-						InsertFreeBefore(&b, offset);
-					b.taken = true;
-					b.SetTag(tag);
-					return b.start;
-				}
-			}
+			if (b.size != needed)
+				InsertFreeAfter(&b, b.size - needed);
+			if (offset >= grain_)
+				InsertFreeBefore(&b, offset);
+			b.taken = true;
+			b.SetTag(tag);
+			TreeUpdate(&b);
+			return b.start;
 		}
 	}
 	else
 	{
 		// Allocate from top of mem.
-		for (Block *bp = top_; bp != NULL; bp = bp->prev)
+		Block *bp = FindFreeFromTop(root_, size, grain);
+		if (bp != NULL)
 		{
 			Block &b = *bp;
 			u32 offset = (b.start + b.size - size) % grain;
 			u32 needed = offset + size;
-			if (b.taken == false && b.size >= needed)
-			{
-				if (b.size == needed)
-				{
-					if (offset >= grain_)
-						InsertFreeAfter(&b, offset);
-					b.taken = true;
-					b.SetTag(tag);
-					return b.start;
-				}
-				else
-				{
-					InsertFreeBefore(&b, b.size - needed);
-					if (offset >= grain_)
-						InsertFreeAfter(&b, offset);
-					b.taken = true;
-					b.SetTag(tag);
-					return b.start;
-				}
-			}
+			if (b.size != needed)
+				InsertFreeBefore(&b, b.size - needed);
+			if (offset >= grain_)
+				InsertFreeAfter(&b, offset);
+			b.taken = true;
+			b.SetTag(tag);
+			TreeUpdate(&b);
+			return b.start;
 		}
 	}
 
@@ -196,6 +178,7 @@ u32 BlockAllocator::AllocAt(u32 position, u32 size, const char *tag)
 					InsertFreeAfter(&b, b.size - alignedSize);
 				b.taken = true;
 				b.SetTag(tag);
+				TreeUpdate(&b);
 				CheckBlocks();
 				return position;
 			}
@@ -206,6 +189,7 @@ u32 BlockAllocator::AllocAt(u32 position, u32 size, const char *tag)
 					InsertFreeAfter(&b, b.size - alignedSize);
 				b.taken = true;
 				b.SetTag(tag);
+				TreeUpdate(&b);
 
 				return position;
 			}
@@ -237,6 +221,7 @@ void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 		else
 			fromBlock->next->prev = prev;
 		prev->next = fromBlock->next;
+		TreeRemove(fromBlock);
 		delete fromBlock;
 		fromBlock = prev;
 		prev = fromBlock->prev;
@@ -253,6 +238,7 @@ void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 		DEBUG_LOG(SCEKERNEL, "Block Alloc found adjacent free blocks - merging");
 		fromBlock->size += next->size;
 		fromBlock->next = next->next;
+		TreeRemove(next);
 		delete next;
 		next = fromBlock->next;
 	}
@@ -261,6 +247,7 @@ void BlockAllocator::MergeFreeBlocks(Block *fromBlock)
 		top_ = fromBlock;
 	else
 		next->prev = fromBlock;
+	TreeUpdate(fromBlock);
 }
 
 bool BlockAllocator::Free(u32 position)
@@ -306,6 +293,17 @@ BlockAllocator::Block *BlockAllocator::InsertFreeBefore(Block *b, u32 size)
 
 	b->start += size;
 	b->size -= size;
+
+	// Goes right before b in the tree too.
+	if (b->left == nullptr) {
+		TreeInsert(inserted, b, true);
+	} else {
+		Block *parent = b->left;
+		while (parent->right != nullptr)
+			parent = parent->right;
+		TreeInsert(inserted, parent, false);
+	}
+	TreeUpdate(b);
 	return inserted;
 }
 
@@ -319,9 +317,164 @@ BlockAllocator::Block *BlockAllocator::InsertFreeAfter(Block *b, u32 size)
 		inserted->next->prev = inserted;
 
 	b->size -= size;
+
+	if (b->right == nullptr) {
+		TreeInsert(inserted, b, false);
+	} else {
+		Block *parent = b->right;
+		while (parent->left != nullptr)
+			parent = parent->left;
+		TreeInsert(inserted, parent, true);
+	}
+	TreeUpdate(b);
 	return inserted;
 }
 
+BlockAllocator::Block *BlockAllocator::FindFreeFromBottom(Block *b, u32 size, u32 grain) const
+{
+	// Lowest free block that fits, skipping any subtree without a large enough free block.
+	if (b == nullptr || b->maxFree < size)
+		return nullptr;
+	Block *found = FindFreeFromBottom(b->left, size, grain);
+	if (found != nullptr)
+		return found;
+
+	u32 offset = b->start % grain;
+	if (offset != 0)
+		offset = grain - offset;
+	if (!b->taken && b->size >= offset + size)
+		return b;
+	return FindFreeFromBottom(b->right, size, grain);
+}
+
+BlockAllocator::Block *BlockAllocator::FindFreeFromTop(Block *b, u32 size, u32 grain) const
+{
+	if (b == nullptr || b->maxFree < size)
+		return nullptr;
+	Block *found = FindFreeFromTop(b->right, size, grain);
+	if (found != nullptr)
+		return found;
+
+	u32 offset = (b->start + b->size - size) % grain;
+	if (!b->taken && b->size >= offset + size)
+		return b;
+	return FindFreeFromTop(b->left, size, grain);
+}
+
+void BlockAllocator::TreeInsert(Block *b, Block *parent, bool asLeft)
+{
+	b->parent = parent;
+	b->left = nullptr;
+	b->right = nullptr;
+	// Any decent spread will do, the shape of the tree doesn't affect placement.
+	nextPriority_ ^= nextPriority_ << 13;
+	nextPriority_ ^= nextPriority_ >> 17;
+	nextPriority_ ^= nextPriority_ << 5;
+	b->priority = nextPriority_;
+
+	if (parent == nullptr)
+		root_ = b;
+	else if (asLeft)
+		parent->left = b;
+	else
+		parent->right = b;
+
+	TreeRecalc(b);
+	while (b->parent != nullptr && b->priority > b->parent->priority)
+		TreeRotateUp(b);
+	TreeUpdate(b);
+}
+
+void BlockAllocator::TreeRemove(Block *b)
+{
+	// Rotate it down to a leaf, then cut it off.
+	while (b->left != nullptr || b->right != nullptr)
+	{
+		Block *child;
+		if (b->left == nullptr)
+			child = b->right;
+		else if (b->right == nullptr)
+			child = b->left;
+		else
+			child = b->left->priority > b->right->priority ? b->left : b->right;
+		TreeRotateUp(child);
+	}
+
+	Block *parent = b->parent;
+	if (parent == nullptr)
+		root_ = nullptr;
+	else if (parent->left == b)
+		parent->left = nullptr;
+	else
+		parent->right = nullptr;
+	b->parent = nullptr;
+	TreeUpdate(parent);
+}
+
+void BlockAllocator::TreeRotateUp(Block *b)
+{
+	Block *parent = b->parent;
+	Block *grandparent = parent->parent;
+	if (parent->left == b)
+	{
+		parent->left = b->right;
+		if (b->right != nullptr)
+			b->right->parent = parent;
+		b->right = parent;
+	}
+	else
+	{
+		parent->right = b->left;
+		if (b->left != nullptr)
+			b->left->parent = parent;
+		b->left = parent;
+	}
+	parent->parent = b;
+
+	b->parent = grandparent;
+	if (grandparent == nullptr)
+		root_ = b;
+	else if (grandparent->left == parent)
+		grandparent->left = b;
+	else
+		grandparent->right = b;
+
+	TreeRecalc(parent);
+	TreeRecalc(b);
+}
+
+void BlockAllocator::TreeUpdate(Block *b)
+{
+	for (; b != nullptr; b = b->parent)
+		TreeRecalc(b);
+}
+
+void BlockAllocator::TreeRecalc(Block *b)
+{
+	u32 maxFree = b->taken ? 0 : b->size;
+	u32 sumFree = maxFree;
+	if (b->left != nullptr)
+	{
+		maxFree = std::max(maxFree, b->left->maxFree);
+		sumFree += b->left->sumFree;
+	}
+	if (b->right != nullptr)
+	{
+		maxFree = std::max(maxFree, b->right->maxFree);
+		sumFree += b->right->sumFree;
+	}
+	b->maxFree = maxFree;
+	b->sumFree = sumFree;
+}
+
+void BlockAllocator::TreeRebuild()
+{
+	root_ = nullptr;
+	// Each block is the new last in order, so it always goes on the far right.
+	for (Block *bp = bottom_; bp != NULL; bp = bp->next)
+		TreeInsert(bp, bp->prev, false);
+}
+
 void BlockAllocator::CheckBlocks() const
 {
 	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
@@ -342,30 +495,23 @@ const char *BlockAllocator::GetBlockTag(u32 addr) const {
 	return b->tag;
 }
 
-inline BlockAllocator::Block *BlockAllocator::GetBlockFromAddress(u32 addr)
+BlockAllocator::Block *BlockAllocator::GetBlockFromAddress(u32 addr)
 {
-	for (Block *bp = bottom_; bp != NULL; bp = bp->next)
-	{
-		Block &b = *bp;
-		if (b.start <= addr && b.start + b.size > addr)
-		{
-			// Got one!
-			return bp;
-		}
-	}
-	return NULL;
+	return const_cast<Block *>(const_cast<const BlockAllocator *>(this)->GetBlockFromAddress(addr));
 }
 
 const BlockAllocator::Block *BlockAllocator::GetBlockFromAddress(u32 addr) const
 {
-	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
+	const Block *bp = root_;
+	while (bp != NULL)
 	{
 		const Block &b = *bp;
-		if (b.start <= addr && b.start + b.size > addr)
-		{
-			// Got one!
+		if (addr < b.start)
+			bp = b.left;
+		else if (b.start + b.size <= addr)
+			bp = b.right;
+		else
 			return bp;
-		}
 	}
 	return NULL;
 }
@@ -401,16 +547,7 @@ void BlockAllocator::ListBlocks() const
 
 u32 BlockAllocator::GetLargestFreeBlockSize() const
 {
-	u32 maxFreeBlock = 0;
-	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
-	{
-		const Block &b = *bp;
-		if (!b.taken)
-		{
-			if (b.size > maxFreeBlock)
-				maxFreeBlock = b.size;
-		}
-	}
+	u32 maxFreeBlock = root_ ? root_->maxFree : 0;
 	if (maxFreeBlock & (grain_ - 1))
 		WARN_LOG_REPORT(HLE, "GetLargestFreeBlockSize: free size %08x does not align to grain %08x.", maxFreeBlock, grain_);
 	return maxFreeBlock;
@@ -418,15 +555,7 @@ u32 BlockAllocator::GetLargestFreeBlockSize() const
 
 u32 BlockAllocator::GetTotalFreeBytes() const
 {
-	u32 sum = 0;
-	for (const Block *bp = bottom_; bp != NULL; bp = bp->next)
-	{
-		const Block &b = *bp;
-		if (!b.taken)
-		{
-			sum += b.size;
-		}
-	}
+	u32 sum = root_ ? root_->sumFree : 0;
 	if (sum & (grain_ - 1))
 		WARN_LOG_REPORT(HLE, "GetTotalFreeBytes: free size %08x does not align to grain %08x.", sum, grain_);
 	return sum;
@@ -456,6 +585,7 @@ void BlockAllocator::DoState(PointerWrap &p)
 			top_->next->DoState(p);
 			top_ = top_->next;
 		}
+		TreeRebuild();
 	}
 	else
 	{
@@ -70,10 +70,21 @@ private:
 		char tag[32];
 		Block *prev;
 		Block *next;
+
+		// Tree of all blocks in address order, so lookups and fits don't need to walk the list.
+		Block *parent = nullptr;
+		Block *left = nullptr;
+		Block *right = nullptr;
+		u32 priority = 0;
+		// Largest free block and total free bytes in this subtree.
+		u32 maxFree = 0;
+		u32 sumFree = 0;
 	};
 
 	Block *bottom_;
 	Block *top_;
+	Block *root_ = nullptr;
+	u32 nextPriority_ = 0x12345678;
 	u32 rangeStart_;
 	u32 rangeSize_;
 
@@ -84,4 +95,13 @@ private:
 	const Block *GetBlockFromAddress(u32 addr) const;
 	Block *InsertFreeBefore(Block *b, u32 size);
 	Block *InsertFreeAfter(Block *b, u32 size);
+	Block *FindFreeFromBottom(Block *b, u32 size, u32 grain) const;
+	Block *FindFreeFromTop(Block *b, u32 size, u32 grain) const;
+
+	void TreeInsert(Block *b, Block *parent, bool asLeft);
+	void TreeRemove(Block *b);
+	void TreeRotateUp(Block *b);
+	void TreeUpdate(Block *b);
+	void TreeRebuild();
+	static void TreeRecalc(Block *b);
 };
@@ -1060,6 +1060,14 @@ void TextureCacheCommon::NotifyConfigChanged() {
 void TextureCacheCommon::NotifyVideoUpload(u32 addr, int size, int width, GEBufferFormat fmt) {
 	addr &= 0x3FFFFFFF;
 	videos_[addr] = gpuStats.numFlips;
+
+	// We know this is a new frame, written straight from the decoder.  Hashing it just to find out
+	// it changed is wasted time, and so is archiving old frames in the secondary cache.
+	const u64 startKey = (u64)addr << 32;
+	const u64 endKey = (u64)(addr + size) << 32;
+	for (TexCache::iterator iter = cache_.lower_bound(startKey), end = cache_.lower_bound(endKey); iter != end; ++iter) {
+		iter->second->status |= TexCacheEntry::STATUS_FORCE_REBUILD | TexCacheEntry::STATUS_CHANGE_FREQUENT;
+	}
 }
 
 void TextureCacheCommon::LoadClut(u32 clutAddr, u32 loadBytes) {
@@ -29,6 +29,7 @@ enum SkipDrawReasonFlags {
 	SKIPDRAW_NON_DISPLAYED_FB = 2,   // Skip drawing to FBO:s that have not been displayed.
 	SKIPDRAW_BAD_FB_TEXTURE = 4,
 	SKIPDRAW_WINDOW_MINIMIZED = 8, // Don't draw when the host window is minimized.
+	SKIPDRAW_PACED_DISPLAY_FB = 16,  // Skip drawing to recently displayed framebuffers (CoreParameter::drawEveryNthFrame.)
 };
 
 // Global GPU-related utility functions. 
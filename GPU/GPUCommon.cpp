@@ -1570,12 +1570,13 @@ void GPUCommon::Execute_Prim(u32 op, u32 diff) {
 	// This also makes skipping drawing very effective.
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
 
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (ShouldSkipDraw()) {
 		// Rough estimate, not sure what's correct.
 		cyclesExecuted += EstimatePerVertexCost() * count;
 		if (gstate.isModeClear()) {
 			gpuStats.numClears++;
 		}
+		SkipVerts(gstate.vertType, count);
 		return;
 	}
 
@@ -1774,14 +1775,39 @@ bail:
 	cyclesExecuted += vertexCost_ * totalVertCount;
 }
 
+void GPUCommon::SkipVerts(u32 vertType, int count) {
+	int bytesRead = 0;
+	if ((vertType & GE_VTYPE_IDX_MASK) == GE_VTYPE_IDX_NONE) {
+		VertexDecoder *dec = drawEngineCommon_->GetVertexDecoder(GetVertTypeID(vertType, gstate.getUVGenMode()));
+		bytesRead = count * dec->VertexSize();
+	}
+	AdvanceVerts(vertType, count, bytesRead);
+}
+
+bool GPUCommon::ShouldSkipDraw() const {
+	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB))
+		return true;
+	if (gstate_c.skipDrawReason & SKIPDRAW_PACED_DISPLAY_FB) {
+		// Offscreen and render-to-texture targets are still drawn, only what gets shown is skipped.
+		// Compare the offset in VRAM, the display address may use a mirror.
+		const u32 target = gstate.getFrameBufAddress() & 0x001FFFFF;
+		for (u32 displayed : gstate_c.pacedDisplayFramebufs) {
+			if (displayed != 0 && (displayed & 0x001FFFFF) == target)
+				return true;
+		}
+	}
+	return false;
+}
+
 void GPUCommon::Execute_Bezier(u32 op, u32 diff) {
 	// We don't dirty on normal changes anymore as we prescale, but it's needed for splines/bezier.
 	gstate_c.Dirty(DIRTY_UVSCALEOFFSET);
 
 	// This also make skipping drawing very effective.
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (ShouldSkipDraw()) {
 		// TODO: Should this eat some cycles?  Probably yes.  Not sure if important.
+		SkipVerts(gstate.vertType, (op & 0xFF) * ((op >> 8) & 0xFF));
 		return;
 	}
 
@@ -1844,8 +1870,9 @@ void GPUCommon::Execute_Spline(u32 op, u32 diff) {
 
 	// This also make skipping drawing very effective.
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (ShouldSkipDraw()) {
 		// TODO: Should this eat some cycles?  Probably yes.  Not sure if important.
+		SkipVerts(gstate.vertType, (op & 0xFF) * ((op >> 8) & 0xFF));
 		return;
 	}
 
@@ -2253,7 +2280,7 @@ void GPUCommon::Execute_ImmVertexAlphaPrim(u32 op, u32 diff) {
 void GPUCommon::FlushImm() {
 	SetDrawType(DRAW_PRIM, immPrim_);
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (ShouldSkipDraw()) {
 		// No idea how many cycles to skip, heh.
 		return;
 	}
@@ -303,6 +303,10 @@ protected:
 			gstate_c.vertexAddr += bytesRead;
 		}
 	}
+	// Skipped draws still move the pointers along, later draws and bounding box tests rely on it.
+	void SkipVerts(u32 vertType, int count);
+	// Checks skipDrawReason against the current render target.
+	bool ShouldSkipDraw() const;
 
 	size_t FormatGPUStatsCommon(char *buf, size_t size);
 
@@ -559,6 +559,8 @@ struct GPUStateCache {
 	bool vertexFullAlpha;
 
 	int skipDrawReason;
+	// The last two framebuffers displayed (front and back), for SKIPDRAW_PACED_DISPLAY_FB.
+	u32 pacedDisplayFramebufs[2];
 
 	UVScale uv;
 
@@ -342,6 +342,13 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 			// Upper bits are ignored.
 			GEPrimitiveType prim = static_cast<GEPrimitiveType>((data >> 16) & 7);
 
+			if (ShouldSkipDraw()) {
+				// Rough estimate, same as GPUCommon::Execute_Prim.
+				cyclesExecuted += EstimatePerVertexCost() * count;
+				SkipVerts(gstate.vertType, count);
+				break;
+			}
+
 			if (!Memory::IsValidAddress(gstate_c.vertexAddr)) {
 				ERROR_LOG_REPORT(G3D, "Software: Bad vertex address %08x!", gstate_c.vertexAddr);
 				break;
@@ -375,8 +382,9 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 			gstate_c.Dirty(DIRTY_UVSCALEOFFSET);
 
 			// This also make skipping drawing very effective.
-			if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB))	{
+			if (ShouldSkipDraw()) {
 				// TODO: Should this eat some cycles?  Probably yes.  Not sure if important.
+				SkipVerts(gstate.vertType, (op & 0xFF) * ((op >> 8) & 0xFF));
 				return;
 			}
 
@@ -427,8 +435,9 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 			gstate_c.Dirty(DIRTY_UVSCALEOFFSET);
 
 			// This also make skipping drawing very effective.
-			if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB))	{
+			if (ShouldSkipDraw()) {
 				// TODO: Should this eat some cycles?  Probably yes.  Not sure if important.
+				SkipVerts(gstate.vertType, (op & 0xFF) * ((op >> 8) & 0xFF));
 				return;
 			}
 
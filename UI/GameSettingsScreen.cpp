@@ -616,6 +616,11 @@ void GameSettingsScreen::CreateViews() {
 	altVolume->SetZeroLabel(a->T("Mute"));
 	altVolume->SetNegativeDisable(a->T("Use global volume"));
 
+	PopupSliderChoice *latency = audioSettings->Add(new PopupSliderChoice(&g_Config.iAudioLatency, 10, 90, a->T("Audio latency"), 2, screenManager(), a->T("ms")));
+	latency->SetEnabledFunc([] {
+		return g_Config.bEnableSound && !g_Config.bExtraAudioBuffering;
+	});
+
 #ifdef _WIN32
 	if (IsVistaOrHigher()) {
 		static const char *backend[] = { "Auto", "DSound (compatible)", "WASAPI (fast)" };
@@ -887,6 +892,7 @@ void GameSettingsScreen::CreateViews() {
 	static const char *ioTimingMethods[] = { "Fast (lag on slow storage)", "Host (bugs, less lag)", "Simulate UMD delays" };
 	View *ioTimingMethod = systemSettings->Add(new PopupMultiChoice(&g_Config.iIOTimingMethod, sy->T("IO timing method"), ioTimingMethods, 0, ARRAY_SIZE(ioTimingMethods), sy->GetName(), screenManager()));
 	ioTimingMethod->SetEnabledPtr(&g_Config.bSeparateIOThread);
+	systemSettings->Add(new CheckBox(&g_Config.bMpegDecodeAhead, sy->T("Decode videos ahead on thread")));
 	systemSettings->Add(new CheckBox(&g_Config.bForceLagSync, sy->T("Force real clock sync (slower, less lag)")));
 	PopupSliderChoice *lockedMhz = systemSettings->Add(new PopupSliderChoice(&g_Config.iLockedCPUSpeed, 0, 1000, sy->T("Change CPU Clock", "Change CPU Clock (unstable)"), screenManager(), sy->T("MHz, 0:default")));
 	lockedMhz->OnChange.Add([&](UI::EventParams &) {
@@ -989,6 +995,10 @@ void GameSettingsScreen::CreateViews() {
 #if defined(_M_X64)
 	systemSettings->Add(new CheckBox(&g_Config.bCacheFullIsoInRam, sy->T("Cache ISO in RAM", "Cache full ISO in RAM")))->SetEnabled(!PSP_IsInited());
 #endif
+#if PPSSPP_ARCH(64BIT)
+	// A read error on a mapped file crashes instead of failing the read, so it's opt-in.
+	systemSettings->Add(new CheckBox(&g_Config.bMemoryMapIso, sy->T("Memory-map ISO files")))->SetEnabled(!PSP_IsInited());
+#endif
 
 	systemSettings->Add(new ItemHeader(sy->T("Cheats", "Cheats (experimental, see forums)")));
 	CheckBox *enableCheats = systemSettings->Add(new CheckBox(&g_Config.bEnableCheats, sy->T("Enable Cheats")));
@@ -2,9 +2,11 @@
 // See headless.txt.
 // To build on non-windows systems, just run CMake in the SDL directory, it will build both a normal ppsspp and the headless version.
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <unordered_map>
 #if defined(ANDROID)
 #include <jni.h>
 #endif
@@ -16,15 +18,23 @@
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/AssetReader.h"
 #include "Common/File/FileUtil.h"
+#include "Common/Data/Format/JSONWriter.h"
 #include "Common/GraphicsContext.h"
+#include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/MemHeatmap.h"
+#include "Core/Debugger/SymbolMap.h"
 #include "Core/System.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/ReplaceTables.h"
 #include "Core/HLE/sceUtility.h"
 #include "Core/Host.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/SaveState.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
 #include "Log.h"
@@ -121,6 +131,13 @@ int printUsage(const char *progname, const char *reason)
 	}
 #endif
 	fprintf(stderr, "  --timeout=SECONDS     abort test it if takes longer than SECONDS\n");
+	fprintf(stderr, "  --hle-profile=FILE    write per function HLE call stats as JSON\n");
+	fprintf(stderr, "  --mem-heatmap=FILE    write sampled memory accesses per page as JSON\n");
+	fprintf(stderr, "  --mem-heatmap-interval=N\n");
+	fprintf(stderr, "                        sample about one access in N (default %d)\n", (int)MemHeatmap::DEFAULT_INTERVAL);
+	fprintf(stderr, "  --scan-functions=FILE write sampled hot functions and replacement status as JSON\n");
+	fprintf(stderr, "  --draw-every=N        only draw to the display one frame in N, offscreen\n");
+	fprintf(stderr, "                        and render-to-texture targets are still drawn\n");
 
 	fprintf(stderr, "  -v, --verbose         show the full passed/failed result\n");
 	fprintf(stderr, "  -i                    use the interpreter\n");
@@ -146,7 +163,176 @@ static HeadlessHost *getHost(GPUCore gpuCore) {
 	}
 }
 
-bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool autoCompare, bool verbose, double timeout)
+struct HLEProfileResult {
+	std::string filename;
+	std::vector<HLEFunctionProfile> functions;
+};
+
+static std::vector<HLEProfileResult> hleProfileResults;
+
+static bool WriteHLEProfile(const char *filename) {
+	json::JsonWriter json;
+	json.begin();
+	json.pushArray("runs");
+	for (const auto &result : hleProfileResults) {
+		json.pushDict();
+		json.writeString("file", result.filename);
+		json.pushArray("functions");
+		for (const auto &func : result.functions) {
+			json.pushDict();
+			json.writeString("module", func.module);
+			json.writeString("name", func.name);
+			json.writeUint("nid", func.nid);
+			json.writeRaw("calls", StringFromFormat("%llu", (unsigned long long)func.calls));
+			json.writeRaw("hostNanos", StringFromFormat("%llu", (unsigned long long)func.hostNanos));
+			json.writeRaw("cycles", StringFromFormat("%llu", (unsigned long long)func.cycles));
+			json.writeRaw("delayCycles", StringFromFormat("%llu", (unsigned long long)func.delayCycles));
+			json.pop();
+		}
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+	json.end();
+
+	return writeStringToFile(true, json.str(), filename);
+}
+
+struct MemHeatmapResult {
+	std::string filename;
+	u64 samples;
+	std::vector<MemHeatmap::PageStats> pages;
+};
+
+static std::vector<MemHeatmapResult> memHeatmapResults;
+
+static bool WriteMemHeatmap(const char *filename) {
+	json::JsonWriter json;
+	json.begin();
+	json.writeUint("interval", MemHeatmap::GetInterval());
+	json.writeUint("pageSize", MemHeatmap::PAGE_SIZE);
+	json.pushArray("runs");
+	for (const auto &result : memHeatmapResults) {
+		json.pushDict();
+		json.writeString("file", result.filename);
+		json.writeRaw("samples", StringFromFormat("%llu", (unsigned long long)result.samples));
+		json.pushArray("pages");
+		for (const auto &page : result.pages) {
+			json.pushDict();
+			json.writeUint("address", page.address);
+			json.writeUint("reads", page.reads);
+			json.writeUint("writes", page.writes);
+			json.pop();
+		}
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+	json.end();
+
+	return writeStringToFile(true, json.str(), filename);
+}
+
+// Where the game spends its time, by sampling the pc at a fixed cycle interval.
+static const int FUNCTION_SCAN_INTERVAL = 10000;
+static int functionScanEvent = -1;
+static std::unordered_map<u32, u32> functionScanPCs;
+
+static void FunctionScanSample(u64 userdata, int cyclesLate) {
+	functionScanPCs[currentMIPS->pc]++;
+	CoreTiming::ScheduleEvent(FUNCTION_SCAN_INTERVAL - cyclesLate, functionScanEvent);
+}
+
+struct FunctionScanEntry {
+	u32 address;
+	u32 size;
+	u64 hash;
+	bool hasHash;
+	std::string symbolName;
+	std::string hashName;
+	ReplacementMatch match;
+	u32 samples;
+};
+
+struct FunctionScanResult {
+	std::string filename;
+	u64 samples;
+	std::vector<FunctionScanEntry> functions;
+};
+
+static std::vector<FunctionScanResult> functionScanResults;
+
+static FunctionScanResult CollectFunctionScan(const std::string &filename) {
+	FunctionScanResult result{ filename, 0 };
+	u64 outsideSamples = 0;
+
+	std::unordered_map<u32, u32> functionSamples;
+	for (const auto &it : functionScanPCs) {
+		result.samples += it.second;
+		u32 start = g_symbolMap->GetFunctionStart(it.first);
+		if (start == SymbolMap::INVALID_ADDRESS)
+			outsideSamples += it.second;
+		else
+			functionSamples[start] += it.second;
+	}
+	functionScanPCs.clear();
+
+	for (const auto &it : functionSamples) {
+		FunctionScanEntry entry{ it.first, g_symbolMap->GetFunctionSize(it.first), 0, false };
+		entry.symbolName = g_symbolMap->GetLabelString(it.first);
+		entry.samples = it.second;
+
+		MIPSAnalyst::AnalyzedFunction func;
+		if (MIPSAnalyst::GetFunctionContaining(it.first, &func) && func.start == it.first && func.hasHash) {
+			entry.size = func.size;
+			entry.hash = func.hash;
+			entry.hasHash = true;
+		}
+		entry.match = MatchReplacement(entry.hash, entry.hasHash ? entry.size : 0, entry.symbolName, &entry.hashName);
+		result.functions.push_back(entry);
+	}
+
+	std::sort(result.functions.begin(), result.functions.end(), [](const FunctionScanEntry &a, const FunctionScanEntry &b) {
+		return a.samples > b.samples || (a.samples == b.samples && a.address < b.address);
+	});
+	if (outsideSamples != 0)
+		INFO_LOG(SYSTEM, "Function scan: %llu samples outside known functions", (unsigned long long)outsideSamples);
+	return result;
+}
+
+static bool WriteFunctionScan(const char *filename) {
+	json::JsonWriter json;
+	json.begin();
+	json.writeUint("interval", FUNCTION_SCAN_INTERVAL);
+	json.pushArray("runs");
+	for (const auto &result : functionScanResults) {
+		json.pushDict();
+		json.writeString("file", result.filename);
+		json.writeRaw("samples", StringFromFormat("%llu", (unsigned long long)result.samples));
+		json.pushArray("functions");
+		for (const auto &func : result.functions) {
+			json.pushDict();
+			json.writeUint("address", func.address);
+			json.writeUint("size", func.size);
+			if (func.hasHash)
+				json.writeString("hash", StringFromFormat("%016llx", (unsigned long long)func.hash));
+			json.writeString("symbol", func.symbolName);
+			if (!func.hashName.empty())
+				json.writeString("hashName", func.hashName);
+			json.writeString("match", ReplacementMatchToString(func.match));
+			json.writeUint("samples", func.samples);
+			json.pop();
+		}
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+	json.end();
+
+	return writeStringToFile(true, json.str(), filename);
+}
+
+bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool autoCompare, bool verbose, double timeout, bool scanFunctions)
 {
 	if (teamCityMode) {
 		// Kinda ugly, trying to guesstimate the test name from filename...
@@ -169,6 +355,12 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 
 	host->BootDone();
 
+	if (scanFunctions) {
+		// Events are all unregistered again on shutdown, so this needs to happen every run.
+		functionScanEvent = CoreTiming::RegisterEvent("FunctionScanSample", &FunctionScanSample);
+		CoreTiming::ScheduleEvent(FUNCTION_SCAN_INTERVAL, functionScanEvent);
+	}
+
 	if (autoCompare)
 		headlessHost->SetComparisonScreenshot(ExpectedScreenshotFromFilename(coreParameter.fileToStart));
 
@@ -210,6 +402,16 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 	if (coreParameter.graphicsContext && coreParameter.graphicsContext->GetDrawContext())
 		coreParameter.graphicsContext->GetDrawContext()->EndFrame();
 
+	// The stats go away with the HLE modules, so grab them first.
+	if (hleIsProfiling())
+		hleProfileResults.push_back({ coreParameter.fileToStart, hleGetProfile() });
+	if (MemHeatmap::IsEnabled()) {
+		memHeatmapResults.push_back({ coreParameter.fileToStart, MemHeatmap::GetSampleCount(), MemHeatmap::GetPages() });
+		MemHeatmap::Reset();
+	}
+	if (scanFunctions)
+		functionScanResults.push_back(CollectFunctionScan(coreParameter.fileToStart));
+
 	PSP_Shutdown();
 
 	headlessHost->FlushDebugOutput();
@@ -247,6 +449,11 @@ int main(int argc, const char* argv[])
 	const char *mountIso = 0;
 	const char *mountRoot = 0;
 	const char *screenshotFilename = 0;
+	const char *hleProfileFilename = nullptr;
+	const char *memHeatmapFilename = nullptr;
+	u32 memHeatmapInterval = MemHeatmap::DEFAULT_INTERVAL;
+	const char *functionScanFilename = nullptr;
+	int drawEveryNthFrame = 0;
 	float timeout = std::numeric_limits<float>::infinity();
 
 	for (int i = 1; i < argc; i++)
@@ -304,6 +511,16 @@ int main(int argc, const char* argv[])
 			screenshotFilename = argv[i] + strlen("--screenshot=");
 		else if (!strncmp(argv[i], "--timeout=", strlen("--timeout=")) && strlen(argv[i]) > strlen("--timeout="))
 			timeout = strtod(argv[i] + strlen("--timeout="), NULL);
+		else if (!strncmp(argv[i], "--hle-profile=", strlen("--hle-profile=")) && strlen(argv[i]) > strlen("--hle-profile="))
+			hleProfileFilename = argv[i] + strlen("--hle-profile=");
+		else if (!strncmp(argv[i], "--mem-heatmap=", strlen("--mem-heatmap=")) && strlen(argv[i]) > strlen("--mem-heatmap="))
+			memHeatmapFilename = argv[i] + strlen("--mem-heatmap=");
+		else if (!strncmp(argv[i], "--mem-heatmap-interval=", strlen("--mem-heatmap-interval=")) && strlen(argv[i]) > strlen("--mem-heatmap-interval="))
+			memHeatmapInterval = (u32)strtoul(argv[i] + strlen("--mem-heatmap-interval="), NULL, 10);
+		else if (!strncmp(argv[i], "--scan-functions=", strlen("--scan-functions=")) && strlen(argv[i]) > strlen("--scan-functions="))
+			functionScanFilename = argv[i] + strlen("--scan-functions=");
+		else if (!strncmp(argv[i], "--draw-every=", strlen("--draw-every=")) && strlen(argv[i]) > strlen("--draw-every="))
+			drawEveryNthFrame = atoi(argv[i] + strlen("--draw-every="));
 		else if (!strcmp(argv[i], "--teamcity"))
 			teamCityMode = true;
 		else if (!strncmp(argv[i], "--state=", strlen("--state=")) && strlen(argv[i]) > strlen("--state="))
@@ -363,6 +580,7 @@ int main(int argc, const char* argv[])
 	coreParameter.pixelWidth = 480;
 	coreParameter.pixelHeight = 272;
 	coreParameter.unthrottle = true;
+	coreParameter.drawEveryNthFrame = drawEveryNthFrame;
 
 	g_Config.bEnableSound = false;
 	g_Config.bFirstRun = false;
@@ -432,6 +650,11 @@ int main(int argc, const char* argv[])
 	if (stateToLoad != NULL)
 		SaveState::Load(stateToLoad, -1);
 
+	if (hleProfileFilename)
+		hleSetProfiling(true);
+	if (memHeatmapFilename)
+		MemHeatmap::SetEnabled(true, memHeatmapInterval);
+
 	std::vector<std::string> failedTests;
 	std::vector<std::string> passedTests;
 	for (size_t i = 0; i < testFilenames.size(); ++i)
@@ -439,7 +662,7 @@ int main(int argc, const char* argv[])
 		coreParameter.fileToStart = testFilenames[i];
 		if (autoCompare)
 			printf("%s:\n", coreParameter.fileToStart.c_str());
-		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout);
+		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout, functionScanFilename != nullptr);
 		if (autoCompare)
 		{
 			std::string testName = GetTestName(coreParameter.fileToStart);
@@ -465,6 +688,13 @@ int main(int argc, const char* argv[])
 		}
 	}
 
+	if (hleProfileFilename && !WriteHLEProfile(hleProfileFilename))
+		fprintf(stderr, "Failed to write HLE profile to %s\n", hleProfileFilename);
+	if (memHeatmapFilename && !WriteMemHeatmap(memHeatmapFilename))
+		fprintf(stderr, "Failed to write memory heatmap to %s\n", memHeatmapFilename);
+	if (functionScanFilename && !WriteFunctionScan(functionScanFilename))
+		fprintf(stderr, "Failed to write function scan to %s\n", functionScanFilename);
+
 	host->ShutdownGraphics();
 	delete host;
 	host = nullptr;
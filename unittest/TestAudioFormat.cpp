@@ -0,0 +1,147 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Core/Util/AudioFormat.h"
+
+#include "UnitTest.h"
+
+// Checks each audio kernel against a plain scalar version.
+// Sizes are deliberately not multiples of the SIMD widths, so the tails get tested too.
+static const size_t TEST_SAMPLES = 4096 + 6;
+
+static s16 RandomSample(TestRandom &rng) {
+	u32 r = rng.Next() >> 8;
+	// Mostly full scale noise, with some extremes mixed in.
+	if ((r & 0x1F) == 0)
+		return (r & 0x20) ? 32767 : -32768;
+	return (s16)(r >> 2);
+}
+
+template <typename T>
+static bool CompareBuffers(const char *name, const std::vector<T> &actual, const std::vector<T> &expected) {
+	for (size_t i = 0; i < expected.size(); ++i) {
+		if (actual[i] != expected[i]) {
+			printf("%s mismatch at %d: %d vs %d\n", name, (int)i, (int)actual[i], (int)expected[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void AdjustVolumeReference(s16 *out, const s16 *in, size_t size, int leftVol, int rightVol) {
+	bool fullPrecision = leftVol <= 0x7fff && -leftVol <= 0x8000 && rightVol <= 0x7fff && -rightVol <= 0x8000;
+	for (size_t i = 0; i < size; i += 2) {
+		out[i] = fullPrecision ? ApplySampleVolume(in[i], leftVol) : ApplySampleVolume20Bit(in[i], leftVol);
+		out[i + 1] = fullPrecision ? ApplySampleVolume(in[i + 1], rightVol) : ApplySampleVolume20Bit(in[i + 1], rightVol);
+	}
+}
+
+static bool TestAdjustVolume(const std::vector<s16> &in) {
+	// Volumes arrive shifted left by one, so these cover both precision paths.  Left and right differ on purpose.
+	static const int volumes[][2] = {
+		{ 0x4000, 0x1000 },
+		{ 0x7fff, -0x8000 },
+		{ 0x0000, 0x6543 },
+		{ 0x10000, 0x8000 },
+		{ 0x1FFFE, 0x12346 },
+	};
+
+	std::vector<s16> expected(in.size()), actual(in.size());
+	for (auto &vol : volumes) {
+		AdjustVolumeReference(&expected[0], &in[0], in.size(), vol[0], vol[1]);
+		AdjustVolumeBlock(&actual[0], (s16 *)&in[0], in.size(), vol[0], vol[1]);
+		RET(CompareBuffers("AdjustVolumeBlock", actual, expected));
+	}
+	return true;
+}
+
+static bool TestClampToS16(const std::vector<s16> &in) {
+	// Sums of several channels, so plenty need clamping.
+	std::vector<s32> mixed(in.size());
+	for (size_t i = 0; i < in.size(); ++i)
+		mixed[i] = in[i] * 3 + in[in.size() - 1 - i];
+
+	std::vector<s16> expected(in.size()), actual(in.size());
+	for (int shift = 0; shift <= 10; ++shift) {
+		for (size_t i = 0; i < in.size(); ++i)
+			expected[i] = clamp_s16(mixed[i] >> shift);
+		ClampBufferToS16(&actual[0], &mixed[0], mixed.size(), shift);
+		RET(CompareBuffers("ClampBufferToS16", actual, expected));
+	}
+	return true;
+}
+
+static bool TestMixToS32(const std::vector<s16> &in) {
+	std::vector<s32> expected(in.size()), actual(in.size());
+	for (size_t i = 0; i < in.size(); ++i)
+		expected[i] = in[i] + in[in.size() - 1 - i];
+	std::vector<s16> reversed(in.rbegin(), in.rend());
+
+	ConvertS16ToS32(&actual[0], &in[0], in.size());
+	MixS16ToS32(&actual[0], &reversed[0], reversed.size());
+	RET(CompareBuffers("ConvertS16ToS32/MixS16ToS32", actual, expected));
+	return true;
+}
+
+static bool TestS16ToF32(const std::vector<s16> &in) {
+	std::vector<float> expected(in.size()), actual(in.size());
+	for (size_t i = 0; i < in.size(); ++i)
+		expected[i] = in[i] * (1.0f / 32767.0f);
+	ConvertS16ToF32(&actual[0], &in[0], in.size());
+	for (size_t i = 0; i < in.size(); ++i) {
+		EXPECT_EQ_FLOAT(actual[i], expected[i]);
+	}
+	return true;
+}
+
+static bool TestInterleave(const std::vector<s16> &in) {
+	size_t frames = in.size() / 2;
+	std::vector<float> left(frames), right(frames);
+	for (size_t i = 0; i < frames; ++i) {
+		// A bit over full scale, so some samples clip.
+		left[i] = in[i * 2] * (1.25f / 32768.0f);
+		right[i] = in[i * 2 + 1] * (1.0f / 32768.0f);
+	}
+
+	auto reference = [&](s16 *out) {
+		for (size_t i = 0; i < frames; ++i) {
+			out[i * 2 + 0] = clamp_s16((int)lrintf(left[i] * 32768.0f));
+			out[i * 2 + 1] = clamp_s16((int)lrintf(right[i] * 32768.0f));
+		}
+	};
+
+	std::vector<s16> expected(frames * 2), actual(frames * 2);
+	reference(&expected[0]);
+	ConvertPlanarF32ToS16Stereo(&actual[0], &left[0], &right[0], frames);
+	RET(CompareBuffers("ConvertPlanarF32ToS16Stereo", actual, expected));
+	return true;
+}
+
+bool TestAudioFormat() {
+	SetupAudioFormats();
+
+	TestRandom rng(0x1234);
+	std::vector<s16> in(TEST_SAMPLES);
+	for (s16 &sample : in)
+		sample = RandomSample(rng);
+
+	return TestAdjustVolume(in) && TestClampToS16(in) && TestMixToS32(in) && TestS16ToF32(in) && TestInterleave(in);
+}
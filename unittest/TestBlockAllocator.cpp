@@ -0,0 +1,305 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Common/Serialize/Serializer.h"
+#include "Core/Util/BlockAllocator.h"
+
+#include "UnitTest.h"
+
+// The original linear first fit allocator, minus tags.  Placement must match it exactly,
+// since games can depend on where things land and save states store the blocks.
+class ReferenceAllocator {
+public:
+	ReferenceAllocator(u32 grain) : grain_(grain) {
+	}
+
+	void Init(u32 rangeStart, u32 rangeSize) {
+		rangeStart_ = rangeStart;
+		rangeSize_ = rangeSize;
+		blocks_.clear();
+		blocks_.push_back({ rangeStart, rangeSize, false });
+	}
+
+	u32 AllocAligned(u32 &size, u32 sizeGrain, u32 grain, bool fromTop) {
+		if (size == 0 || size > rangeSize_)
+			return -1;
+		if (grain < grain_)
+			grain = grain_;
+		if (sizeGrain < grain_)
+			sizeGrain = grain_;
+		size = (size + sizeGrain - 1) & ~(sizeGrain - 1);
+
+		if (!fromTop) {
+			for (size_t i = 0; i < blocks_.size(); ++i) {
+				u32 offset = blocks_[i].start % grain;
+				if (offset != 0)
+					offset = grain - offset;
+				u32 needed = offset + size;
+				if (!blocks_[i].taken && blocks_[i].size >= needed) {
+					if (blocks_[i].size != needed)
+						InsertFreeAfter(i, blocks_[i].size - needed);
+					if (offset >= grain_) {
+						InsertFreeBefore(i, offset);
+						++i;
+					}
+					blocks_[i].taken = true;
+					return blocks_[i].start;
+				}
+			}
+		} else {
+			for (size_t i = blocks_.size(); i-- > 0; ) {
+				u32 offset = (blocks_[i].start + blocks_[i].size - size) % grain;
+				u32 needed = offset + size;
+				if (!blocks_[i].taken && blocks_[i].size >= needed) {
+					if (blocks_[i].size != needed) {
+						InsertFreeBefore(i, blocks_[i].size - needed);
+						++i;
+					}
+					if (offset >= grain_)
+						InsertFreeAfter(i, offset);
+					blocks_[i].taken = true;
+					return blocks_[i].start;
+				}
+			}
+		}
+		return -1;
+	}
+
+	u32 AllocAt(u32 position, u32 size) {
+		if (size > rangeSize_)
+			return -1;
+		u32 alignedPosition = position & ~(grain_ - 1);
+		u32 alignedSize = size + (position - alignedPosition);
+		alignedSize = (alignedSize + grain_ - 1) & ~(grain_ - 1);
+
+		int i = Find(alignedPosition);
+		if (i < 0 || blocks_[i].taken || blocks_[i].start + blocks_[i].size < alignedPosition + alignedSize)
+			return -1;
+		if (blocks_[i].start != alignedPosition) {
+			InsertFreeBefore(i, alignedPosition - blocks_[i].start);
+			++i;
+		}
+		if (blocks_[i].size > alignedSize)
+			InsertFreeAfter(i, blocks_[i].size - alignedSize);
+		blocks_[i].taken = true;
+		return position;
+	}
+
+	bool Free(u32 position, bool exact) {
+		int i = Find(position);
+		if (i < 0 || !blocks_[i].taken || (exact && blocks_[i].start != position))
+			return false;
+		blocks_[i].taken = false;
+		while (i > 0 && !blocks_[i - 1].taken) {
+			blocks_[i - 1].size += blocks_[i].size;
+			blocks_.erase(blocks_.begin() + i);
+			--i;
+		}
+		while (i + 1 < (int)blocks_.size() && !blocks_[i + 1].taken) {
+			blocks_[i].size += blocks_[i + 1].size;
+			blocks_.erase(blocks_.begin() + i + 1);
+		}
+		return true;
+	}
+
+	int Find(u32 addr) const {
+		for (size_t i = 0; i < blocks_.size(); ++i) {
+			if (blocks_[i].start <= addr && blocks_[i].start + blocks_[i].size > addr)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	u32 GetLargestFreeBlockSize() const {
+		u32 largest = 0;
+		for (auto &b : blocks_) {
+			if (!b.taken && b.size > largest)
+				largest = b.size;
+		}
+		return largest;
+	}
+
+	u32 GetTotalFreeBytes() const {
+		u32 sum = 0;
+		for (auto &b : blocks_) {
+			if (!b.taken)
+				sum += b.size;
+		}
+		return sum;
+	}
+
+	struct Block {
+		u32 start;
+		u32 size;
+		bool taken;
+	};
+	std::vector<Block> blocks_;
+
+private:
+	void InsertFreeBefore(size_t i, u32 size) {
+		Block inserted = { blocks_[i].start, size, false };
+		blocks_[i].start += size;
+		blocks_[i].size -= size;
+		blocks_.insert(blocks_.begin() + i, inserted);
+	}
+
+	void InsertFreeAfter(size_t i, u32 size) {
+		Block inserted = { blocks_[i].start + blocks_[i].size - size, size, false };
+		blocks_[i].size -= size;
+		blocks_.insert(blocks_.begin() + i + 1, inserted);
+	}
+
+	u32 grain_;
+	u32 rangeStart_ = 0;
+	u32 rangeSize_ = 0;
+};
+
+static TestRandom rng(0x4321);
+
+static u32 NextRandom() {
+	return rng.Next() >> 8;
+}
+
+static bool CompareAllocators(BlockAllocator &alloc, const ReferenceAllocator &ref) {
+	for (auto &b : ref.blocks_) {
+		if (b.size == 0)
+			continue;
+		if (alloc.GetBlockStartFromAddress(b.start + b.size - 1) != b.start || alloc.GetBlockSizeFromAddress(b.start) != b.size || alloc.IsBlockFree(b.start) == b.taken) {
+			printf("Block at %08x (size %08x, taken %d) differs\n", b.start, b.size, b.taken ? 1 : 0);
+			return false;
+		}
+	}
+	EXPECT_EQ_INT(alloc.GetLargestFreeBlockSize(), ref.GetLargestFreeBlockSize());
+	EXPECT_EQ_INT(alloc.GetTotalFreeBytes(), ref.GetTotalFreeBytes());
+	return true;
+}
+
+static bool ReloadAllocator(BlockAllocator &alloc) {
+	std::vector<u8> state(CChunkFileReader::MeasurePtr(alloc));
+	EXPECT_TRUE(CChunkFileReader::SavePtr(&state[0], alloc) == CChunkFileReader::ERROR_NONE);
+	std::string errorString;
+	EXPECT_TRUE(CChunkFileReader::LoadPtr(&state[0], alloc, &errorString) == CChunkFileReader::ERROR_NONE);
+	return true;
+}
+
+static bool TestRandomWorkload(u32 grain, u32 rangeStart, u32 rangeSize, int ops) {
+	BlockAllocator alloc(grain);
+	ReferenceAllocator ref(grain);
+	alloc.Init(rangeStart, rangeSize);
+	ref.Init(rangeStart, rangeSize);
+
+	std::vector<u32> live;
+	for (int i = 0; i < ops; ++i) {
+		u32 r = NextRandom();
+		int op = r % 16;
+		// Mostly small sizes, with the occasional large one.
+		u32 size = (r & 0x100) ? (NextRandom() % (rangeSize / 8)) : (NextRandom() % 0x800) + 1;
+		bool fromTop = (r & 0x200) != 0;
+
+		if (op < 6) {
+			u32 refSize = size;
+			u32 expected = ref.AllocAligned(refSize, grain, grain, fromTop);
+			u32 actual = alloc.Alloc(size, fromTop, "test");
+			EXPECT_EQ_HEX(actual, expected);
+			EXPECT_EQ_HEX(size, refSize);
+			if (actual != (u32)-1)
+				live.push_back(actual);
+		} else if (op < 9) {
+			u32 align = 1 << (NextRandom() % 14);
+			u32 sizeGrain = 1 << (NextRandom() % 10);
+			u32 refSize = size;
+			u32 expected = ref.AllocAligned(refSize, sizeGrain, align, fromTop);
+			u32 actual = alloc.AllocAligned(size, sizeGrain, align, fromTop, "test");
+			EXPECT_EQ_HEX(actual, expected);
+			EXPECT_EQ_HEX(size, refSize);
+			if (actual != (u32)-1)
+				live.push_back(actual);
+		} else if (op < 10) {
+			u32 position = rangeStart + NextRandom() % rangeSize;
+			u32 refSize = size;
+			u32 expected = ref.AllocAt(position, refSize);
+			u32 actual = alloc.AllocAt(position, size, "test");
+			EXPECT_EQ_HEX(actual, expected);
+			if (actual != (u32)-1)
+				live.push_back(actual);
+		} else if (op < 15 && !live.empty()) {
+			// Free a live block, sometimes from an address inside it.
+			size_t index = NextRandom() % live.size();
+			u32 position = live[index];
+			bool exact = (r & 0x400) != 0;
+			if (!exact && ref.Find(position) >= 0)
+				position += NextRandom() % ref.blocks_[ref.Find(position)].size;
+			EXPECT_EQ_INT(alloc.Free(position) ? 1 : 0, ref.Free(position, false) ? 1 : 0);
+			live.erase(live.begin() + index);
+		} else {
+			// Bogus frees should fail the same way.
+			u32 position = rangeStart + NextRandom() % rangeSize;
+			EXPECT_EQ_INT(alloc.FreeExact(position) ? 1 : 0, ref.Free(position, true) ? 1 : 0);
+		}
+
+		if ((i % 64) == 0)
+			RET(CompareAllocators(alloc, ref));
+		if ((i % 1000) == 500)
+			RET(ReloadAllocator(alloc));
+	}
+
+	return CompareAllocators(alloc, ref);
+}
+
+static bool TestManySmallAllocs() {
+	// Lots of small partition allocs, like some homebrew does.
+	const int count = 8000;
+	BlockAllocator alloc(256);
+	ReferenceAllocator ref(256);
+	alloc.Init(0x08800000, 0x01800000);
+	ref.Init(0x08800000, 0x01800000);
+
+	std::vector<u32> addresses;
+	for (int i = 0; i < count; ++i) {
+		u32 size = 0x100 + (i & 0xF) * 0x10;
+		addresses.push_back(alloc.Alloc(size, (i & 1) != 0, "test"));
+	}
+	for (int i = 0; i < count; i += 2)
+		alloc.Free(addresses[i]);
+	for (int i = 0; i < count; ++i) {
+		u32 size = 0x100;
+		alloc.Alloc(size, false, "test");
+	}
+
+	for (int i = 0; i < count; ++i) {
+		u32 size = 0x100 + (i & 0xF) * 0x10;
+		EXPECT_EQ_HEX(ref.AllocAligned(size, 256, 256, (i & 1) != 0), addresses[i]);
+	}
+	for (int i = 0; i < count; i += 2)
+		ref.Free(addresses[i], false);
+	for (int i = 0; i < count; ++i) {
+		u32 size = 0x100;
+		ref.AllocAligned(size, 256, 256, false);
+	}
+	return CompareAllocators(alloc, ref);
+}
+
+bool TestBlockAllocator() {
+	RET(TestRandomWorkload(256, 0x08800000, 0x01800000, 20000));
+	RET(TestRandomWorkload(16, 0x08000000, 0x00010000, 20000));
+	RET(TestRandomWorkload(0x100, 0x08400000, 0x00040000, 20000));
+	return TestManySmallAllocs();
+}
@@ -0,0 +1,254 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closesocket_compat closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define closesocket_compat close
+#endif
+
+#include "Common/File/FileDescriptor.h"
+#include "Common/Net/Resolve.h"
+#include "Common/TimeUtil.h"
+#include "Core/FileLoaders/HTTPFileLoader.h"
+
+#include "UnitTest.h"
+
+static const s64 TEST_FILE_SIZE = 4 * 1024 * 1024 + 1234;
+
+static u8 TestFileByte(s64 pos) {
+	return (u8)(pos * 7 + (pos >> 9));
+}
+
+// A tiny stand-in for a real file server, so we can count connections and requests.
+class RangeServer {
+public:
+	explicit RangeServer(bool keepAlive) : keepAlive_(keepAlive) {
+	}
+	~RangeServer() {
+		Stop();
+	}
+
+	bool Start() {
+		listener_ = (int)socket(AF_INET, SOCK_STREAM, 0);
+		if (listener_ < 0)
+			return false;
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		socklen_t len = sizeof(addr);
+		if (bind(listener_, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener_, 4) < 0 || getsockname(listener_, (sockaddr *)&addr, &len) < 0) {
+			closesocket_compat(listener_);
+			return false;
+		}
+		port_ = ntohs(addr.sin_port);
+
+		running_ = true;
+		thread_ = std::thread([this] { Run(); });
+		return true;
+	}
+
+	void Stop() {
+		running_ = false;
+		if (thread_.joinable())
+			thread_.join();
+		if (listener_ >= 0)
+			closesocket_compat(listener_);
+		listener_ = -1;
+	}
+
+	int Port() const { return port_; }
+	int Connections() const { return connections_; }
+	int Requests() const { return requests_; }
+
+private:
+	void Run() {
+		while (running_) {
+			if (!fd_util::WaitUntilReady(listener_, 0.1))
+				continue;
+			int conn = (int)accept(listener_, nullptr, nullptr);
+			if (conn < 0)
+				continue;
+			connections_++;
+			HandleConnection(conn);
+			CloseGracefully(conn);
+		}
+	}
+
+	void CloseGracefully(int conn) {
+		// Let the client read everything before closing, discarding any pipelined requests.
+#ifdef _WIN32
+		shutdown(conn, SD_SEND);
+#else
+		shutdown(conn, SHUT_WR);
+#endif
+		char temp[4096];
+		double deadline = time_now_d() + 1.0;
+		while (time_now_d() < deadline) {
+			if (fd_util::WaitUntilReady(conn, 0.1) && recv(conn, temp, sizeof(temp), 0) <= 0)
+				break;
+		}
+		closesocket_compat(conn);
+	}
+
+	void HandleConnection(int conn) {
+		std::string buffer;
+		char temp[4096];
+		while (running_) {
+			size_t headerEnd = buffer.find("\r\n\r\n");
+			if (headerEnd == buffer.npos) {
+				if (!fd_util::WaitUntilReady(conn, 0.1))
+					continue;
+				int received = (int)recv(conn, temp, sizeof(temp), 0);
+				if (received <= 0)
+					return;
+				buffer.append(temp, received);
+				continue;
+			}
+
+			std::string request = buffer.substr(0, headerEnd);
+			buffer.erase(0, headerEnd + 4);
+			requests_++;
+			if (!Respond(conn, request) || !keepAlive_)
+				return;
+		}
+	}
+
+	bool Respond(int conn, const std::string &request) {
+		bool head = request.compare(0, 5, "HEAD ") == 0;
+		long long first = 0, last = TEST_FILE_SIZE - 1;
+		bool range = false;
+		size_t rangePos = request.find("Range: bytes=");
+		if (rangePos != request.npos) {
+			range = sscanf(request.c_str() + rangePos, "Range: bytes=%lld-%lld", &first, &last) == 2;
+		}
+
+		char headers[1024];
+		if (range) {
+			snprintf(headers, sizeof(headers),
+				"HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lld-%lld/%lld\r\nContent-Length: %lld\r\nConnection: %s\r\n\r\n",
+				first, last, (long long)TEST_FILE_SIZE, last - first + 1, keepAlive_ ? "keep-alive" : "close");
+		} else {
+			snprintf(headers, sizeof(headers),
+				"HTTP/1.1 200 OK\r\nAccept-Ranges: bytes\r\nContent-Length: %lld\r\nConnection: %s\r\n\r\n",
+				(long long)TEST_FILE_SIZE, keepAlive_ ? "keep-alive" : "close");
+		}
+
+		std::string response = headers;
+		if (!head) {
+			for (long long pos = first; pos <= last; ++pos)
+				response.push_back((char)TestFileByte(pos));
+		}
+
+		size_t sent = 0;
+		while (sent < response.size()) {
+			int result = (int)send(conn, response.data() + sent, (int)(response.size() - sent), 0);
+			if (result <= 0)
+				return false;
+			sent += result;
+		}
+		return true;
+	}
+
+	bool keepAlive_;
+	int listener_ = -1;
+	int port_ = 0;
+	std::thread thread_;
+	std::atomic<bool> running_{ false };
+	std::atomic<int> connections_{ 0 };
+	std::atomic<int> requests_{ 0 };
+};
+
+static bool CheckRead(FileLoader &loader, s64 pos, size_t size) {
+	std::vector<u8> data(size);
+	size_t expected = (size_t)std::min((s64)size, TEST_FILE_SIZE - pos);
+	size_t readBytes = loader.ReadAt(pos, size, &data[0]);
+	if (readBytes != expected) {
+		printf("Read at %lld: got %d bytes, expected %d\n", (long long)pos, (int)readBytes, (int)expected);
+		return false;
+	}
+	for (size_t i = 0; i < expected; ++i) {
+		if (data[i] != TestFileByte(pos + i)) {
+			printf("Read at %lld: wrong data at offset %d\n", (long long)pos, (int)i);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool TestLoaderAgainst(bool keepAlive) {
+	RangeServer server(keepAlive);
+	EXPECT_TRUE(server.Start());
+
+	char url[256];
+	snprintf(url, sizeof(url), "http://127.0.0.1:%d/test.iso", server.Port());
+	HTTPFileLoader loader(url);
+	EXPECT_TRUE(loader.Exists());
+	EXPECT_TRUE(loader.FileSize() == TEST_FILE_SIZE);
+
+	// Sequential sector reads, like a game streaming a movie.
+	int sequentialReads = 0;
+	for (s64 pos = 0; pos < TEST_FILE_SIZE; pos += 2048) {
+		RET(CheckRead(loader, pos, 2048));
+		sequentialReads++;
+	}
+	int sequentialRequests = server.Requests();
+
+	// Then some scattered reads, which shouldn't be confused by the read ahead.
+	TestRandom rng(1234);
+	for (int i = 0; i < 200; ++i) {
+		u32 r = rng.Next();
+		s64 pos = (r >> 8) % TEST_FILE_SIZE;
+		RET(CheckRead(loader, pos, 2048 + ((r >> 4) & 0x3FFF)));
+	}
+
+	if (keepAlive) {
+		// The read ahead should avoid a request per read, and all should share connections.
+		EXPECT_TRUE(sequentialRequests < sequentialReads / 8);
+		EXPECT_TRUE(server.Connections() < server.Requests());
+	} else {
+		// No keep-alive, so every request needs its own connection.
+		EXPECT_EQ_INT(server.Connections(), server.Requests());
+	}
+
+	return true;
+}
+
+bool TestHTTPFileLoader() {
+	net::Init();
+	bool success = TestLoaderAgainst(true) && TestLoaderAgainst(false);
+	net::Shutdown();
+	return success;
+}
@@ -0,0 +1,238 @@
+// Copyright (c) 2020- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "Core/HLE/sceKernel.h"
+#include "Core/HLE/ThreadQueueList.h"
+
+#include "UnitTest.h"
+
+static TestRandom rng(0x5678);
+
+static u32 NextRandom() {
+	return rng.Next() >> 8;
+}
+
+// Same behaviour as ThreadQueueList, the slow and obvious way.
+struct ReferenceQueueList {
+	std::deque<SceUID> queues[ThreadQueueList::NUM_QUEUES];
+
+	SceUID PopFirstBetter(int priority) {
+		for (int i = 0; i < priority; ++i) {
+			if (!queues[i].empty()) {
+				SceUID id = queues[i].front();
+				queues[i].pop_front();
+				return id;
+			}
+		}
+		return 0;
+	}
+
+	SceUID PeekFirst() const {
+		for (auto &q : queues) {
+			if (!q.empty())
+				return q.front();
+		}
+		return 0;
+	}
+};
+
+static bool TestQueueListRandom() {
+	ThreadQueueList list;
+	ReferenceQueueList ref;
+	SceUID nextID = 0x100;
+	std::vector<std::pair<int, SceUID>> queued;
+
+	for (int i = 0; i < 50000; ++i) {
+		u32 r = NextRandom();
+		// A handful of levels get most of the traffic, like real games.
+		int priority = (r & 0x100) ? (NextRandom() % ThreadQueueList::NUM_QUEUES) : 0x20 + (NextRandom() % 4);
+		switch (r % 8) {
+		case 0:
+		case 1:
+			list.prepare(priority);
+			list.push_back(priority, nextID);
+			ref.queues[priority].push_back(nextID);
+			queued.push_back(std::make_pair(priority, nextID++));
+			break;
+
+		case 2:
+			list.prepare(priority);
+			list.push_front(priority, nextID);
+			ref.queues[priority].push_front(nextID);
+			queued.push_back(std::make_pair(priority, nextID++));
+			break;
+
+		case 3:
+			if (!queued.empty()) {
+				size_t index = NextRandom() % queued.size();
+				auto &q = ref.queues[queued[index].first];
+				list.remove(queued[index].first, queued[index].second);
+				q.erase(std::find(q.begin(), q.end(), queued[index].second));
+				queued.erase(queued.begin() + index);
+			}
+			break;
+
+		case 4:
+			list.prepare(priority);
+			list.rotate(priority);
+			if (ref.queues[priority].size() > 1) {
+				ref.queues[priority].push_back(ref.queues[priority].front());
+				ref.queues[priority].pop_front();
+			}
+			break;
+
+		case 5:
+		case 6:
+		{
+			// Also covers pop_first(), which is the same as better than anything.
+			int better = (r & 0x200) ? ThreadQueueList::NUM_QUEUES : priority;
+			SceUID expected = ref.PopFirstBetter(better);
+			SceUID actual = better == ThreadQueueList::NUM_QUEUES && expected != 0 ? list.pop_first() : list.pop_first_better(better);
+			EXPECT_EQ_HEX(actual, expected);
+			if (expected != 0) {
+				queued.erase(std::find_if(queued.begin(), queued.end(), [&](const std::pair<int, SceUID> &q) {
+					return q.second == expected;
+				}));
+			}
+			break;
+		}
+
+		case 7:
+			EXPECT_EQ_HEX(list.peek_first(), ref.PeekFirst());
+			EXPECT_EQ_INT(list.empty(priority), ref.queues[priority].empty());
+			break;
+		}
+	}
+
+	return true;
+}
+
+class TestSema : public KernelObject {
+public:
+	const char *GetName() override { return "test"; }
+	const char *GetTypeName() override { return GetStaticTypeName(); }
+	static const char *GetStaticTypeName() { return "Semaphore"; }
+	static u32 GetMissingErrorCode() { return SCE_KERNEL_ERROR_UNKNOWN_SEMID; }
+	static int GetStaticIDType() { return SCE_KERNEL_TMID_Semaphore; }
+	int GetIDType() const override { return SCE_KERNEL_TMID_Semaphore; }
+
+	int count = 0;
+	std::vector<SceUID> waitingThreads;
+};
+
+class TestThread : public KernelObject {
+public:
+	const char *GetName() override { return "test"; }
+	const char *GetTypeName() override { return GetStaticTypeName(); }
+	static const char *GetStaticTypeName() { return "Thread"; }
+	static u32 GetMissingErrorCode() { return SCE_KERNEL_ERROR_UNKNOWN_THID; }
+	static int GetStaticIDType() { return SCE_KERNEL_TMID_Thread; }
+	int GetIDType() const override { return SCE_KERNEL_TMID_Thread; }
+
+	int priority = 0x20;
+};
+
+// Static, it's a bit big for the stack.
+static KernelObjectPool testObjects;
+
+static bool TestObjectPoolLookups() {
+	SceUID sema = testObjects.Create(new TestSema());
+	SceUID thread = testObjects.Create(new TestThread());
+
+	u32 error;
+	EXPECT_TRUE(testObjects.Get<TestSema>(sema, error) != nullptr);
+	EXPECT_EQ_HEX(error, 0);
+	EXPECT_TRUE(testObjects.Get<TestThread>(thread, error) != nullptr);
+
+	// Wrong type, out of range, and freed handles should all fail with the type's error.
+	EXPECT_TRUE(testObjects.Get<TestThread>(sema, error) == nullptr);
+	EXPECT_EQ_HEX(error, SCE_KERNEL_ERROR_UNKNOWN_THID);
+	EXPECT_TRUE(testObjects.Get<TestSema>(-1, error) == nullptr);
+	EXPECT_EQ_HEX(error, SCE_KERNEL_ERROR_UNKNOWN_SEMID);
+	EXPECT_TRUE(testObjects.Get<TestSema>(0x7FFFFFFF, error) == nullptr);
+	EXPECT_TRUE(testObjects.Get<TestSema>((SceUID)0x80000000, error) == nullptr);
+
+	int type = 0;
+	EXPECT_TRUE(testObjects.GetIDType(thread, &type));
+	EXPECT_EQ_INT(type, SCE_KERNEL_TMID_Thread);
+	EXPECT_EQ_INT(testObjects.GetCount(), 2);
+
+	EXPECT_EQ_HEX(testObjects.Destroy<TestThread>(sema), SCE_KERNEL_ERROR_UNKNOWN_THID);
+	EXPECT_EQ_HEX(testObjects.Destroy<TestSema>(sema), 0);
+	EXPECT_TRUE(testObjects.Get<TestSema>(sema, error) == nullptr);
+	EXPECT_FALSE(testObjects.IsValid(sema));
+	EXPECT_TRUE(testObjects.IsValid(thread));
+
+	testObjects.Clear();
+	EXPECT_EQ_INT(testObjects.GetCount(), 0);
+	return true;
+}
+
+static bool TestSemaphorePingPong() {
+	// Two threads taking turns through a pair of semaphores, the bookkeeping the kernel
+	// does for each sceKernelSignalSema/sceKernelWaitSema pair.  Other threads sit idle at
+	// various priorities, so the ready queue has levels to skip over.
+	ThreadQueueList readyQueue;
+	for (int i = 0; i < 24; ++i)
+		readyQueue.prepare(0x10 + i * 4);
+	SceUID idleThread = testObjects.Create(new TestThread());
+	testObjects.GetFast<TestThread>(idleThread)->priority = 0x7F;
+	readyQueue.prepare(0x7F);
+	readyQueue.push_back(0x7F, idleThread);
+
+	SceUID threads[2], semas[2];
+	for (int i = 0; i < 2; ++i) {
+		threads[i] = testObjects.Create(new TestThread());
+		semas[i] = testObjects.Create(new TestSema());
+		readyQueue.prepare(testObjects.GetFast<TestThread>(threads[i])->priority);
+	}
+	// Thread 1 starts out waiting.
+	testObjects.GetFast<TestSema>(semas[1])->waitingThreads.push_back(threads[1]);
+
+	const int rounds = 10000;
+	int current = 0;
+	u32 error;
+	for (int i = 0; i < rounds; ++i) {
+		// Signal the other thread's semaphore, waking it.
+		TestSema *other = testObjects.Get<TestSema>(semas[current ^ 1], error);
+		SceUID woken = other->waitingThreads.back();
+		other->waitingThreads.pop_back();
+		TestThread *wokenThread = testObjects.Get<TestThread>(woken, error);
+		readyQueue.push_back(wokenThread->priority, woken);
+
+		// Then wait on our own, and reschedule.
+		TestSema *mine = testObjects.Get<TestSema>(semas[current], error);
+		mine->waitingThreads.push_back(threads[current]);
+		TestThread *currentThread = testObjects.Get<TestThread>(threads[current], error);
+		SceUID next = readyQueue.pop_first_better(currentThread->priority + 1);
+		EXPECT_EQ_HEX(next, threads[current ^ 1]);
+		current ^= 1;
+	}
+
+	EXPECT_EQ_HEX(readyQueue.peek_first(), idleThread);
+	testObjects.Clear();
+	return true;
+}
+
+bool TestThreadQueue() {
+	return TestQueueListRandom() && TestObjectPoolLookups() && TestSemaphorePingPong();
+}
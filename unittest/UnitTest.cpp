@@ -32,6 +32,7 @@
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <vector>
 #if defined(ANDROID)
 #include <jni.h>
 #endif
@@ -46,12 +47,16 @@
 
 #include "Common/ArmEmitter.h"
 #include "Common/BitScan.h"
+#include "Common/ColorConv.h"
 #include "Common/CPUDetect.h"
 #include "Common/Log.h"
 #include "Core/Config.h"
 #include "Core/FileSystems/ISOFileSystem.h"
+#include "Core/HW/SasAudio.h"
+#include "Core/HW/SasReverb.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
+#include "Core/Util/AudioFormat.h"
 #include "GPU/Common/TextureDecoder.h"
 
 #include "unittest/JitHarness.h"
@@ -560,6 +565,203 @@ static bool TestMemMap() {
 	return true;
 }
 
+// The scalar SAS voice loop, as it was before it got split up into SIMD kernels.
+static void ReferenceSasMix(int *mixBuffer, int *sendBuffer, const s16_le *src, u32 sampleFrac, int pitch, const int *envelope, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight) {
+	const bool needsInterp = pitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
+	for (int i = 0; i < count; i++) {
+		const s16_le *s = src + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
+		int sample = s[0];
+		if (needsInterp) {
+			int f = sampleFrac & PSP_SAS_PITCH_MASK;
+			sample = (s[0] * (PSP_SAS_PITCH_MASK - f) + s[1] * f) >> PSP_SAS_PITCH_BASE_SHIFT;
+		}
+		sampleFrac += pitch;
+
+		sample = ((sample * envelope[i]) + (1 << 14)) >> 15;
+		mixBuffer[i * 2] += (sample * volumeLeft) >> 12;
+		mixBuffer[i * 2 + 1] += (sample * volumeRight) >> 12;
+		sendBuffer[i * 2] += sample * effectLeft >> 12;
+		sendBuffer[i * 2 + 1] += sample * effectRight >> 12;
+	}
+}
+
+static bool TestSasMix() {
+	static const int pitches[] = { 0x1000, 0x2000, 0x0800, 0x4000, 0x3000, 0x0FFF, 0x1001, 0x0555, 0x0001, 0x0000 };
+	static const int counts[] = { 64, 256, 1, 3, 7, 101, 2048 };
+
+	TestRandom rng(0x5A5A1234);
+
+	std::vector<s16_le> src(PSP_SAS_MAX_GRAIN * 4 + 2 + 8);
+	std::vector<int> envelope(PSP_SAS_MAX_GRAIN);
+	std::vector<int> samples(PSP_SAS_MAX_GRAIN);
+	std::vector<int> expectedMix(PSP_SAS_MAX_GRAIN * 2), expectedSend(PSP_SAS_MAX_GRAIN * 2);
+	std::vector<int> actualMix(PSP_SAS_MAX_GRAIN * 2), actualSend(PSP_SAS_MAX_GRAIN * 2);
+
+	for (int pitch : pitches) {
+		for (int count : counts) {
+			for (int iter = 0; iter < 8; ++iter) {
+				for (auto &s : src) {
+					// Include the extremes now and then.
+					u32 r = rng.Next();
+					s = (r & 0x700) == 0 ? ((r & 1) ? 32767 : -32768) : (s16)(r >> 16);
+				}
+				for (int i = 0; i < count; ++i) {
+					u32 r = rng.Next();
+					envelope[i] = (r & 0x300) == 0 ? 32768 : (int)((r >> 16) & 0x7FFF);
+				}
+				// Start at either a whole sample or some fraction, like voices do.
+				u32 sampleFrac = (iter & 1) ? (rng.Next() & PSP_SAS_PITCH_MASK) : 0;
+				int volumeLeft = (int)(rng.Next() % 0x2001) - 0x1000;
+				int volumeRight = iter == 0 ? PSP_SAS_VOL_MAX : (int)(rng.Next() % 0x2001) - 0x1000;
+				int effectLeft = (int)(rng.Next() % 0x2001) - 0x1000;
+				int effectRight = iter == 0 ? -PSP_SAS_VOL_MAX : (int)(rng.Next() % 0x2001) - 0x1000;
+				for (int i = 0; i < count * 2; ++i) {
+					expectedMix[i] = actualMix[i] = (int)(rng.Next() >> 12) - 0x80000;
+					expectedSend[i] = actualSend[i] = (int)(rng.Next() >> 12) - 0x80000;
+				}
+
+				// Same as the number of samples MixVoice provides.
+				int srcSize = 2 + ((sampleFrac + pitch * count) >> PSP_SAS_PITCH_BASE_SHIFT);
+				ReferenceSasMix(&expectedMix[0], &expectedSend[0], &src[0], sampleFrac, pitch, &envelope[0], count, volumeLeft, volumeRight, effectLeft, effectRight);
+				SasResample(&samples[0], &src[0], srcSize, sampleFrac, pitch, count);
+				SasMixScaled(&actualMix[0], &actualSend[0], &samples[0], &envelope[0], count, volumeLeft, volumeRight, effectLeft, effectRight);
+
+				for (int i = 0; i < count * 2; ++i) {
+					if (expectedMix[i] != actualMix[i] || expectedSend[i] != actualSend[i]) {
+						printf("SAS mix mismatch: pitch=%04x frac=%03x count=%d at %d\n", pitch, sampleFrac, count, i);
+					}
+					EXPECT_EQ_INT(actualMix[i], expectedMix[i]);
+					EXPECT_EQ_INT(actualSend[i], expectedSend[i]);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool TestSasReverb() {
+	// Hashes of the output from the original straightforward reverb loop, per preset (starting with Off.)
+	static const u32 expectedHashes[] = {
+		0x13f4496d, 0xc02286cb, 0x38a6c88a, 0xe7531f03, 0x4a647c77, 0xf5002ad2, 0x850cb975, 0x446020e4, 0xf41270c7, 0x4997c3ad,
+	};
+
+	const int grainSize = 256;
+	std::vector<int> send(grainSize * 2);
+	std::vector<s16> output(grainSize * 2);
+	for (int preset = -1; preset <= PSP_SAS_EFFECT_TYPE_PIPE; ++preset) {
+		SasReverb reverb;
+		reverb.SetPreset(preset);
+
+		TestRandom rng(0x1234567 + preset);
+		u32 hash = 2166136261U;
+		// Enough grains to wrap around the buffer of every preset, and then some silence to let it ring out.
+		for (int grain = 0; grain < 200; ++grain) {
+			for (auto &s : send) {
+				u32 r = rng.Next();
+				// Go out of range now and then, to check the clamping.
+				s = grain >= 150 ? 0 : (int)(r >> 14) - 0x20000 + ((grain & 7) == 3 ? 0x30000 : 0);
+			}
+			int leftVol = (0x1000 - grain * 13) << 3;
+			int rightVol = (0x0800 + grain * 7) << 3;
+			reverb.ProcessReverb(&output[0], &send[0], grainSize / 2, leftVol, rightVol);
+			for (s16 v : output) {
+				hash = (hash ^ (u16)v) * 16777619U;
+			}
+		}
+
+		if (hash != expectedHashes[preset + 1]) {
+			printf("SAS reverb mismatch: preset %s\n", SasReverb::GetPresetName(preset));
+		}
+		EXPECT_EQ_HEX(hash, expectedHashes[preset + 1]);
+	}
+
+	return true;
+}
+
+static bool TestPlanarAudioConversion() {
+	static const size_t counts[] = { 1, 7, 8, 9, 1024, 2048 + 3 };
+
+	TestRandom rng(0x1234);
+	std::vector<float> left(4096), right(4096);
+	std::vector<s16> expected(8192), actual(8192);
+	for (size_t count : counts) {
+		for (size_t i = 0; i < count; ++i) {
+			u32 r = rng.Next();
+			// Mostly normal range, with some clipping and values exactly between two steps.
+			left[i] = (float)(int)(r >> 8) / (float)(1 << 23) * ((r & 0x3F) == 0 ? 3.0f : 1.0f);
+			right[i] = (r & 0x70) == 0 ? ((int)(r >> 20) - 2048 + 0.5f) / 32768.0f : -left[i] * 0.75f;
+		}
+
+		// This is what swresample does for float to s16.
+		for (size_t i = 0; i < count; ++i) {
+			expected[i * 2 + 0] = clamp_s16((int)lrintf(left[i] * 32768.0f));
+			expected[i * 2 + 1] = clamp_s16((int)lrintf(right[i] * 32768.0f));
+		}
+		ConvertPlanarF32ToS16Stereo(&actual[0], &left[0], &right[0], count);
+
+		for (size_t i = 0; i < count * 2; ++i) {
+			if (expected[i] != actual[i]) {
+				printf("Planar audio mismatch: count=%d at %d\n", (int)count, (int)i);
+			}
+			EXPECT_EQ_INT(actual[i], expected[i]);
+		}
+	}
+
+	return true;
+}
+
+static bool TestYUVConversion() {
+	// White, black, and roughly pure red, green, and blue, in limited range.
+	static const u8 colorsY[] = { 235, 16, 81, 145, 41 };
+	static const u8 colorsU[] = { 128, 128, 90, 54, 240 };
+	static const u8 colorsV[] = { 128, 128, 240, 34, 110 };
+	static const u32 colorsRGB[] = { 0x00FFFFFF, 0x00000000, 0x000000FE, 0x0001FF00, 0x00FF0000 };
+	for (int i = 0; i < (int)ARRAY_SIZE(colorsY); ++i) {
+		u32_le px8888;
+		u16_le px565, px5551, px4444;
+		ConvertYUV420ToRGBA8888(&px8888, &colorsY[i], &colorsU[i], &colorsV[i], 1);
+		ConvertYUV420ToRGB565(&px565, &colorsY[i], &colorsU[i], &colorsV[i], 1);
+		ConvertYUV420ToRGBA5551(&px5551, &colorsY[i], &colorsU[i], &colorsV[i], 1);
+		ConvertYUV420ToRGBA4444(&px4444, &colorsY[i], &colorsU[i], &colorsV[i], 1);
+		EXPECT_EQ_HEX((u32)px8888, colorsRGB[i]);
+		EXPECT_EQ_HEX((u16)px565, RGBA8888ToRGB565(colorsRGB[i]));
+		EXPECT_EQ_HEX((u16)px5551, RGBA8888ToRGBA5551(colorsRGB[i]));
+		EXPECT_EQ_HEX((u16)px4444, RGBA8888ToRGBA4444(colorsRGB[i]));
+	}
+
+	// The SIMD paths handle whole groups, the rest is done per pixel: they must agree.
+	static const int WIDTH = 37;
+	u8 y[WIDTH], u[WIDTH], v[WIDTH];
+	TestRandom rng(0x5678);
+	for (int i = 0; i < WIDTH; ++i) {
+		u32 r = rng.Next();
+		y[i] = (u8)(r >> 8);
+		u[i] = (u8)(r >> 16);
+		v[i] = (u8)(r >> 24);
+	}
+
+	u32_le line8888[WIDTH], single8888;
+	u16_le line16[WIDTH], single16;
+	ConvertYUV420ToRGBA8888(line8888, y, u, v, WIDTH);
+	for (int i = 0; i < WIDTH; ++i) {
+		ConvertYUV420ToRGBA8888(&single8888, &y[i], &u[i / 2], &v[i / 2], 1);
+		EXPECT_EQ_HEX((u32)line8888[i], (u32)single8888);
+	}
+
+	typedef void (*Convert16Func)(u16_le *dst, const u8 *y, const u8 *u, const u8 *v, u32 numPixels);
+	static const Convert16Func funcs16[] = { &ConvertYUV420ToRGB565, &ConvertYUV420ToRGBA5551, &ConvertYUV420ToRGBA4444 };
+	for (Convert16Func func : funcs16) {
+		func(line16, y, u, v, WIDTH);
+		for (int i = 0; i < WIDTH; ++i) {
+			func(&single16, &y[i], &u[i / 2], &v[i / 2], 1);
+			EXPECT_EQ_HEX((u16)line16[i], (u16)single16);
+		}
+	}
+
+	return true;
+}
+
 typedef bool (*TestFunc)();
 struct TestItem {
 	const char *name;
@@ -571,6 +773,10 @@ struct TestItem {
 bool TestArmEmitter();
 bool TestArm64Emitter();
 bool TestX64Emitter();
+bool TestHTTPFileLoader();
+bool TestAudioFormat();
+bool TestBlockAllocator();
+bool TestThreadQueue();
 
 TestItem availableTests[] = {
 #if PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
@@ -594,6 +800,14 @@ TestItem availableTests[] = {
 	TEST_ITEM(QuickTexHash),
 	TEST_ITEM(CLZ),
 	TEST_ITEM(MemMap),
+	TEST_ITEM(SasMix),
+	TEST_ITEM(SasReverb),
+	TEST_ITEM(PlanarAudioConversion),
+	TEST_ITEM(AudioFormat),
+	TEST_ITEM(YUVConversion),
+	TEST_ITEM(HTTPFileLoader),
+	TEST_ITEM(BlockAllocator),
+	TEST_ITEM(ThreadQueue),
 };
 
 int main(int argc, const char *argv[]) {
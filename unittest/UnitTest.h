@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #define EXPECT_TRUE(a) if (!(a)) { printf("%s:%i: Test Fail\n", __FUNCTION__, __LINE__); return false; }
 #define EXPECT_FALSE(a) if ((a)) { printf("%s:%i: Test Fail\n", __FUNCTION__, __LINE__); return false; }
 #define EXPECT_EQ_INT(a, b) if ((a) != (b)) { printf("%s:%i: Test Fail\n%d\nvs\n%d\n", __FUNCTION__, __LINE__, a, b); return false; }
@@ -9,3 +11,16 @@
 #define EXPECT_EQ_STR(a, b) if (a != b) { printf("%s: Test Fail\n%s\nvs\n%s\n", __FUNCTION__, a.c_str(), b.c_str()); return false; }
 
 #define RET(a) if (!(a)) { return false; }
+
+// Tiny LCG, so tests get the same "random" inputs on every platform and run.
+class TestRandom {
+public:
+	explicit TestRandom(uint32_t seed) : seed_(seed) {}
+	uint32_t Next() {
+		seed_ = seed_ * 1664525 + 1013904223;
+		return seed_;
+	}
+
+private:
+	uint32_t seed_;
+};